@@ -0,0 +1,232 @@
+/**
+ *
+ * @file		Benchmark.c
+ * @copyright	Tuomo Jauhiainen 2012-2014
+ * @licence		See Licence.txt
+ * @brief		A benchmark suite for Mylly GUI.
+ *
+ * @details		Builds a set of synthetic scenes and measures how long the
+ * core library takes to process them. The scenes are drawn using the headless
+ * renderer, so the results only contain the time spent within MGUI itself.
+ *
+ **/
+
+#include "MGUI.h"
+#include "Element.h"
+#include "Renderer/Headless/Headless.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// --------------------------------------------------
+
+#define SCREEN_WIDTH	1280	// Width of the virtual screen
+#define SCREEN_HEIGHT	800		// Height of the virtual screen
+#define NUM_FRAMES		100		// Number of frames measured per test
+#define NUM_HIT_TESTS	100000	// Number of hit tests done per test
+
+typedef void ( *benchmark_build_t )( MGuiElement* canvas );
+
+// --------------------------------------------------
+
+static void			benchmark_run_scene			( const char* name, benchmark_build_t build );
+static void			benchmark_build_buttons		( MGuiElement* canvas );
+static void			benchmark_build_memobox		( MGuiElement* canvas );
+static void			benchmark_build_windows		( MGuiElement* canvas );
+static void			benchmark_report			( const char* scene, const char* test, uint64 time, uint32 count, const char* unit );
+static uint64		benchmark_get_time			( void );
+
+// --------------------------------------------------
+
+int main( int argc, char** argv )
+{
+	MGuiRenderer* renderer;
+
+	UNREFERENCED_PARAM( argc );
+	UNREFERENCED_PARAM( argv );
+
+	// There is no window, the size of the screen is set using mgui_resize.
+	mgui_initialize( NULL, MGUI_NO_PARAMS );
+	mgui_resize( SCREEN_WIDTH, SCREEN_HEIGHT );
+
+	renderer = mgui_headless_initialize( SCREEN_WIDTH, SCREEN_HEIGHT );
+	mgui_set_renderer( renderer );
+
+	printf( "%-16s %-16s %22s %12s\n", "Scene", "Test", "Time", "Draw calls" );
+
+	benchmark_run_scene( "buttons", benchmark_build_buttons );
+	benchmark_run_scene( "memobox", benchmark_build_memobox );
+	benchmark_run_scene( "windows", benchmark_build_windows );
+
+	mgui_set_renderer( NULL );
+	mgui_headless_shutdown();
+
+	mgui_shutdown();
+
+	return 0;
+}
+
+static void benchmark_run_scene( const char* name, benchmark_build_t build )
+{
+	MGuiElement* canvas;
+	uint64 start;
+	uint32 i;
+	int16 x, y;
+
+	canvas = mgui_create_canvas( NULL );
+	build( canvas );
+
+	// Let the scene settle first: this builds the font metrics, hit grids etc.
+	mgui_force_redraw();
+	mgui_pre_process();
+	mgui_process();
+
+	// Full redraw of the scene.
+	mgui_headless_reset_stats();
+	start = benchmark_get_time();
+
+	for ( i = 0; i < NUM_FRAMES; i++ )
+	{
+		mgui_force_redraw();
+		mgui_process();
+	}
+
+	benchmark_report( name, "mgui_process", benchmark_get_time() - start, NUM_FRAMES, "frame" );
+
+	// Cache refresh, should be close to free when nothing has changed.
+	mgui_headless_reset_stats();
+	start = benchmark_get_time();
+
+	for ( i = 0; i < NUM_FRAMES; i++ )
+		mgui_pre_process();
+
+	benchmark_report( name, "mgui_pre_process", benchmark_get_time() - start, NUM_FRAMES, "frame" );
+
+	// Hit testing over the whole screen.
+	mgui_headless_reset_stats();
+	start = benchmark_get_time();
+
+	for ( i = 0; i < NUM_HIT_TESTS; i++ )
+	{
+		x = (int16)( ( i * 7 ) % SCREEN_WIDTH );
+		y = (int16)( ( i * 13 ) % SCREEN_HEIGHT );
+
+		mgui_get_element_at( x, y );
+	}
+
+	benchmark_report( name, "hit test", benchmark_get_time() - start, NUM_HIT_TESTS, "hit" );
+
+	// Layout, every element is repositioned when the screen is resized.
+	mgui_headless_reset_stats();
+	start = benchmark_get_time();
+
+	for ( i = 0; i < NUM_FRAMES; i++ )
+		mgui_resize( SCREEN_WIDTH - ( i & 1 ), SCREEN_HEIGHT - ( i & 1 ) );
+
+	benchmark_report( name, "layout", benchmark_get_time() - start, NUM_FRAMES, "frame" );
+
+	mgui_resize( SCREEN_WIDTH, SCREEN_HEIGHT );
+	mgui_element_destroy( canvas );
+}
+
+static void benchmark_build_buttons( MGuiElement* canvas )
+{
+	uint32 i;
+	int16 x, y;
+
+	// 10000 buttons in a 125x80 grid.
+	for ( i = 0; i < 10000; i++ )
+	{
+		x = (int16)( ( i % 125 ) * 10 );
+		y = (int16)( ( i / 125 ) * 10 );
+
+		mgui_create_button_ex( canvas, x, y, 9, 9, FLAG_VISIBLE|FLAG_BACKGROUND|FLAG_BORDER|FLAG_MOUSECTRL,
+							   0xC0C0C0FF, "B" );
+	}
+}
+
+static void benchmark_build_memobox( MGuiElement* canvas )
+{
+	MGuiMemobox* memobox;
+	uint32 i;
+
+	memobox = mgui_create_memobox_ex( canvas, 10, 10, SCREEN_WIDTH - 20, SCREEN_HEIGHT - 20,
+									  FLAG_VISIBLE|FLAG_BACKGROUND|FLAG_BORDER|FLAG_MOUSECTRL|FLAG_WRAP,
+									  0x202020FF );
+
+	mgui_memobox_set_history( memobox, 100000 );
+
+	for ( i = 0; i < 100000; i++ )
+	{
+		mgui_memobox_add_line( memobox, "Line %u: The quick brown fox jumps over the lazy dog, "
+							   "and then does it again because one time was not enough.", i );
+	}
+}
+
+static void benchmark_build_windows( MGuiElement* canvas )
+{
+	MGuiElement *parent, *window;
+	uint32 depth, i;
+
+	// A chain of 32 nested windows, each one having a few buttons of its own.
+	parent = canvas;
+
+	for ( depth = 0; depth < 32; depth++ )
+	{
+		window = mgui_create_window_ex( parent, 10, 20, (uint16)( SCREEN_WIDTH - 20 * ( depth + 1 ) ),
+										(uint16)( SCREEN_HEIGHT - 20 * ( depth + 1 ) ),
+										FLAG_VISIBLE|FLAG_BACKGROUND|FLAG_BORDER|FLAG_MOUSECTRL|FLAG_WINDOW_TITLEBAR|FLAG_WINDOW_CLOSEBTN,
+										0x808080FF, "Window" );
+
+		for ( i = 0; i < 8; i++ )
+		{
+			mgui_create_button_ex( window, (int16)( 5 + i * 30 ), 5, 25, 15,
+								   FLAG_VISIBLE|FLAG_BACKGROUND|FLAG_BORDER|FLAG_MOUSECTRL, 0xC0C0C0FF, "Button" );
+		}
+
+		parent = window;
+	}
+}
+
+static void benchmark_report( const char* scene, const char* test, uint64 time, uint32 count, const char* unit )
+{
+	MGuiHeadlessStats stats;
+	uint32 calls;
+
+	mgui_headless_get_stats( &stats );
+
+	calls = stats.draw_rect + stats.draw_triangle + stats.draw_pixel +
+			stats.draw_textured_rect + stats.draw_text + stats.draw_target;
+
+	// The time is reported per measured operation (frame or hit test), the draw calls per rendered frame.
+	printf( "%-16s %-16s %13.1f ns/%-5s %12.1f\n", scene, test,
+			(double)time / count, unit, stats.frames ? (double)calls / stats.frames : 0.0 );
+}
+
+static uint64 benchmark_get_time( void )
+{
+	// Returns a timestamp in nanoseconds.
+#ifdef _WIN32
+	static LARGE_INTEGER frequency = { 0 };
+	LARGE_INTEGER counter;
+
+	if ( frequency.QuadPart == 0 )
+		QueryPerformanceFrequency( &frequency );
+
+	QueryPerformanceCounter( &counter );
+
+	return (uint64)( counter.QuadPart / frequency.QuadPart ) * 1000000000 +
+		   (uint64)( counter.QuadPart % frequency.QuadPart ) * 1000000000 / frequency.QuadPart;
+#else
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+
+	return (uint64)ts.tv_sec * 1000000000 + (uint64)ts.tv_nsec;
+#endif
+}
@@ -0,0 +1,23 @@
+-- Mylly GUI benchmark suite
+
+project "MGUI-Benchmark"
+	kind "ConsoleApp"
+	language "C"
+	files { "*.h", "*.c", "premake4.lua" }
+	includedirs { ".", "..", "../Elements", "../Input", "../Renderer", "../Skin", "../.." }
+	vpaths { [""] = { "../Libraries/MGUI/Benchmark" } }
+	location ( "../../../Projects/" .. os.get() .. "/" .. _ACTION )
+	links { "Lib-MGUI", "Lib-MGUI-Renderer-Headless", "Lib-Input", "Lib-Platform", "Lib-Stringy", "Lib-Math", "Lib-Types" }
+
+	-- Linux specific stuff
+	configuration "linux"
+		buildoptions { "-fms-extensions" } -- Unnamed struct/union fields within structs/unions
+		links { "X11", "m", "rt", "pthread" }
+		configuration "Debug" targetname "mguibenchd"
+		configuration "Release" targetname "mguibench"
+
+	-- Windows specific stuff
+	configuration "windows"
+		buildoptions { "/wd4201 /wd4996" } -- C4201: nameless struct/union, C4996: This function or variable may be unsafe.
+		configuration "Debug" targetname "mguibenchd"
+		configuration "Release" targetname "mguibench"
@@ -63,7 +63,7 @@ MGuiButton* mgui_create_button( MGuiElement* parent )
 	struct MGuiButton* button;
 	extern MGuiFont* default_font;
 
-	button = mem_alloc_clean( sizeof(*button) );
+	button = mgui_element_alloc( GUI_BUTTON, sizeof(*button) );
 	mgui_element_create( cast_elem(button), parent );
 
 	button->flags |= (FLAG_BORDER|FLAG_BACKGROUND|FLAG_MOUSECTRL|FLAG_KBCTRL);
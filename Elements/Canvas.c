@@ -64,14 +64,13 @@ MGuiCanvas* mgui_create_canvas( MGuiElement* parent )
 {
 	struct MGuiCanvas* canvas;
 
-	canvas = mem_alloc_clean( sizeof(*canvas) );
+	canvas = mgui_element_alloc( GUI_CANVAS, sizeof(*canvas) );
 	canvas->flags_int |= INTFLAG_NOTEXT;
 
 	mgui_element_create( cast_elem(canvas), parent );
 
 	canvas->type = GUI_CANVAS;
 	canvas->colour.hex = 0;
-	canvas->children = list_create();
 	canvas->parent = NULL;
 	canvas->flags = FLAG_VISIBLE;
 	canvas->bounds.x = 0;
@@ -58,7 +58,7 @@ MGuiCheckbox* mgui_create_checkbox( MGuiElement* parent )
 {
 	struct MGuiCheckbox* checkbox;
 
-	checkbox = mem_alloc_clean( sizeof(*checkbox) );
+	checkbox = mgui_element_alloc( GUI_CHECKBOX, sizeof(*checkbox) );
 	checkbox->flags_int |= INTFLAG_NOTEXT;
 
 	mgui_element_create( cast_elem(checkbox), parent );
@@ -0,0 +1,442 @@
+/**
+ *
+ * @file		DrawList.c
+ * @copyright	Tuomo Jauhiainen 2012-2014
+ * @licence		See Licence.txt
+ * @brief		Flattened draw order of a layer.
+ *
+ * @details		A per-layer array of the visible elements in the order they are drawn, rebuilt only when the element tree changes.
+ *
+ **/
+
+#include "DrawList.h"
+#include "Damage.h"
+#include "Stats.h"
+#include "Renderer.h"
+#include "Platform/Alloc.h"
+#include <string.h>
+
+// --------------------------------------------------
+
+extern MGuiRenderer* renderer;
+extern rectangle_t draw_rect;
+extern list_t* layers;
+
+static rectangle_t	occluders[DRAWLIST_MAX_OCCLUDERS];		// Opaque areas of the layers, topmost layer first
+static uint32		num_occluders = 0;						// Number of opaque areas found during the current frame
+
+// --------------------------------------------------
+
+static void							mgui_drawlist_rebuild			( MGuiElement* layer );
+static void							mgui_drawlist_add_recursive		( struct MGuiDrawList* list, MGuiElement* element, uint32 outer );
+static MGuiDrawItem*				mgui_drawlist_add_item			( struct MGuiDrawList* list );
+static void							mgui_drawlist_end_layer			( MGuiElement* layer, DRAW_MODE* draw_mode );
+static void							mgui_drawlist_add_occluder		( MGuiElement* layer, MGuiElement* element );
+static MYLLY_INLINE bool			mgui_drawlist_is_opaque			( MGuiElement* element );
+static MYLLY_INLINE bool			mgui_drawlist_occluded			( struct MGuiDrawList* list, const rectangle_t* rect );
+static MYLLY_INLINE void			mgui_drawlist_set_clip			( struct MGuiDrawList* list, uint32* current, uint32 clip );
+static MYLLY_INLINE bool			mgui_drawlist_intersect			( rectangle_t* dst, const rectangle_t* a, const rectangle_t* b );
+
+// --------------------------------------------------
+
+void mgui_drawlist_begin_frame( void )
+{
+	node_t* node;
+	MGuiElement* layer;
+	struct MGuiDrawList* list;
+	uint32 i;
+
+	num_occluders = 0;
+
+	if ( layers == NULL ) return;
+
+	// Walk the layers from the topmost one down. Each layer is covered by the opaque
+	// areas found so far, and then adds the opaque areas of its own to the list.
+	list_foreach_r( layers, node )
+	{
+		layer = cast_elem(node);
+
+		if ( BIT_OFF( layer->flags, FLAG_VISIBLE ) ) continue;
+
+		if ( layer->drawlist == NULL || layer->drawlist->dirty )
+			mgui_drawlist_rebuild( layer );
+
+		list = layer->drawlist;
+
+		// Depth tested and 3D layers are not necessarily covered by the layers drawn after them.
+		if ( layer->flags & (FLAG_3D_ENTITY|FLAG_DEPTH_TEST) )
+		{
+			list->num_occluders = 0;
+			continue;
+		}
+
+		list->num_occluders = num_occluders;
+
+		// Only the layer and its immediate children are considered, that's where
+		// the windows and fullscreen panels usually are.
+		mgui_drawlist_add_occluder( layer, layer );
+
+		for ( i = 1; i < list->num_items; )
+		{
+			if ( !list->items[i].post )
+			{
+				mgui_drawlist_add_occluder( layer, list->items[i].element );
+				i = list->items[i].next;
+			}
+			else i++;
+		}
+	}
+}
+
+void mgui_drawlist_destroy( MGuiElement* layer )
+{
+	if ( layer == NULL || layer->drawlist == NULL ) return;
+
+	if ( layer->drawlist->items != NULL )
+		mem_free( layer->drawlist->items );
+
+	mem_free( layer->drawlist );
+	layer->drawlist = NULL;
+}
+
+void mgui_drawlist_invalidate( MGuiElement* element )
+{
+	if ( element == NULL ) return;
+
+	while ( element->parent != NULL )
+		element = element->parent;
+
+	if ( BIT_ON( element->flags_int, INTFLAG_LAYER ) && element->drawlist )
+		element->drawlist->dirty = true;
+}
+
+void mgui_drawlist_render( MGuiElement* layer )
+{
+	struct MGuiDrawList* list;
+	MGuiDrawItem* item;
+	MGuiElement* element;
+	rectangle_t *r, *outer, *screen, view;
+	DRAW_MODE draw_mode = DRAWING_INVALID;
+	bool layer_drawn = false, visible;
+	uint32 i, clip = DRAWLIST_NO_CLIP;
+	static colour_t cache_colour = { 0xFFFFFFFF };
+
+	if ( layer == NULL ) return;
+
+	if ( layer->drawlist == NULL || layer->drawlist->dirty )
+		mgui_drawlist_rebuild( layer );
+
+	list = layer->drawlist;
+
+	// Elements of a 3D layer are not in screen space, so they can't be culled against the window.
+	screen = BIT_ON( layer->flags, FLAG_3D_ENTITY ) ? NULL : &draw_rect;
+
+	// Children of a layer that doesn't clip may be anywhere in the window, so the layer
+	// can be skipped as a whole only if the entire window is covered.
+	if ( screen != NULL && mgui_drawlist_occluded( list, screen ) )
+		return;
+
+	for ( i = 0; i < list->num_items; )
+	{
+		item = &list->items[i];
+		element = item->element;
+
+		// Post-rendering is done without clipping, after the children have been drawn.
+		if ( item->post )
+		{
+			if ( element == layer )
+			{
+				mgui_drawlist_end_layer( layer, &draw_mode );
+				layer_drawn = false;
+			}
+
+			mgui_drawlist_set_clip( list, &clip, DRAWLIST_NO_CLIP );
+
+			element->callbacks->post_render( element );
+			i++;
+
+			continue;
+		}
+
+		MGUI_STATS_INC( elements_visited );
+
+		r = item->bounds;
+		outer = item->outer != DRAWLIST_NO_CLIP ? &list->items[item->outer].view : screen;
+
+		// Find out which part of the element is not clipped away by its predecessors
+		// or hidden behind the opaque elements of the layers on top of this one.
+		visible = mgui_drawlist_intersect( &view, r, outer ) &&
+				  !mgui_drawlist_occluded( list, &view );
+
+		// Skip elements that are clipped away or outside the area being redrawn. Children of
+		// an element that doesn't clip may extend outside of it, so draw those anyway.
+		if ( BIT_OFF( element->flags, FLAG_3D_ENTITY ) &&
+			 ( BIT_ON( element->flags, FLAG_CLIP ) || item->next == i + 1 ) &&
+			 ( !visible || !mgui_damage_test( r ) ) )
+		{
+			i = item->next;
+
+			if ( i < list->num_items && list->items[i].post && list->items[i].element == element )
+				i++;
+
+			continue;
+		}
+
+		// The children of this element will be clipped to the visible part of it.
+		if ( BIT_ON( element->flags, FLAG_CLIP ) )
+			item->view = visible ? view : *r;
+
+		// If the layer is a 3D element, toggle special drawing mode.
+		if ( element == layer )
+		{
+			switch ( layer->flags & (FLAG_3D_ENTITY|FLAG_DEPTH_TEST) )
+			{
+			case FLAG_DEPTH_TEST:
+				draw_mode = renderer->set_draw_mode( DRAWING_2D_DEPTH );
+				renderer->set_draw_depth( layer->z_depth );
+				break;
+
+			case FLAG_3D_ENTITY:
+				draw_mode = renderer->set_draw_mode( DRAWING_3D );
+				renderer->set_draw_transform( &layer->transform->transform );
+				renderer->set_draw_depth( layer->z_depth );
+				break;
+			}
+
+			layer_drawn = true;
+		}
+
+		// Do we have a cache texture? It is clipped by the predecessors only.
+		if ( element->cache != NULL )
+		{
+			mgui_drawlist_set_clip( list, &clip, item->outer );
+
+			cache_colour.a = element->colour.a;
+
+			renderer->set_draw_colour( &cache_colour );
+			renderer->draw_render_target( element->cache, r->x, r->y, r->w, r->h );
+
+			// This fixes a bug which didn't update the element's cache in some cases
+			// after it was made visible. It's not really ideal but it seems to work.
+			if ( element->flags_int & INTFLAG_REFRESH )
+				mgui_element_request_redraw( element );
+
+			i = item->next;
+			continue;
+		}
+
+		// Render the element itself, unless it's completely clipped away.
+		if ( element->callbacks->render && visible )
+		{
+			mgui_drawlist_set_clip( list, &clip, item->clip );
+
+			MGUI_STATS_INC( elements_rendered );
+			element->callbacks->render( element );
+
+			// Elements with a separate clip region (windows) toggle clipping themselves to draw
+			// the parts outside of it, so the clip has to be reapplied for the next element.
+			if ( element->callbacks->get_clip_region != NULL )
+				clip = DRAWLIST_UNKNOWN_CLIP;
+		}
+
+		i++;
+	}
+
+	mgui_drawlist_set_clip( list, &clip, DRAWLIST_NO_CLIP );
+
+	if ( layer_drawn )
+		mgui_drawlist_end_layer( layer, &draw_mode );
+}
+
+static void mgui_drawlist_rebuild( MGuiElement* layer )
+{
+	if ( layer->drawlist == NULL )
+		layer->drawlist = mem_alloc_clean( sizeof(*layer->drawlist) );
+
+	// Keep the item storage around, just empty it.
+	layer->drawlist->num_items = 0;
+
+	mgui_drawlist_add_recursive( layer->drawlist, layer, DRAWLIST_NO_CLIP );
+	layer->drawlist->dirty = false;
+}
+
+static void mgui_drawlist_add_recursive( struct MGuiDrawList* list, MGuiElement* element, uint32 outer )
+{
+	uint32 i;
+	MGuiDrawItem* item;
+	MGuiElement* child;
+	rectangle_t* r;
+	uint32 index, clip;
+
+	r = element->callbacks->get_clip_region ?
+		element->callbacks->get_clip_region( element, &r ), r :
+		&element->bounds;
+
+	index = list->num_items;
+	clip = BIT_ON( element->flags, FLAG_CLIP ) ? index : outer;
+
+	item = mgui_drawlist_add_item( list );
+	item->element = element;
+	item->bounds = r;
+	item->clip = clip;
+	item->outer = outer;
+	item->post = false;
+
+	if ( element->num_children > 0 )
+	{
+		for ( i = 0; i < element->num_children; i++ )
+		{
+			child = element->children[i];
+
+			if ( BIT_ON( child->flags, FLAG_VISIBLE ) )
+				mgui_drawlist_add_recursive( list, child, clip );
+		}
+	}
+
+	// The storage may have moved while adding the children.
+	list->items[index].next = list->num_items;
+
+	if ( element->callbacks->post_render )
+	{
+		item = mgui_drawlist_add_item( list );
+		item->element = element;
+		item->bounds = r;
+		item->clip = DRAWLIST_NO_CLIP;
+		item->outer = DRAWLIST_NO_CLIP;
+		item->next = list->num_items;
+		item->post = true;
+	}
+}
+
+static MGuiDrawItem* mgui_drawlist_add_item( struct MGuiDrawList* list )
+{
+	MGuiDrawItem* tmp;
+
+	if ( list->num_items >= list->size )
+	{
+		list->size = list->size ? list->size * 2 : 64;
+		tmp = mem_alloc( list->size * sizeof(MGuiDrawItem) );
+
+		if ( list->items != NULL )
+		{
+			memcpy( tmp, list->items, list->num_items * sizeof(MGuiDrawItem) );
+			mem_free( list->items );
+		}
+
+		list->items = tmp;
+	}
+
+	return &list->items[list->num_items++];
+}
+
+static void mgui_drawlist_end_layer( MGuiElement* layer, DRAW_MODE* draw_mode )
+{
+	// Reset draw modes back to original.
+	if ( *draw_mode != DRAWING_INVALID )
+	{
+		renderer->set_draw_mode( *draw_mode );
+		renderer->set_draw_depth( 1.0f );
+
+		*draw_mode = DRAWING_INVALID;
+	}
+
+	if ( layer->flags & FLAG_3D_ENTITY )
+		renderer->reset_draw_transform();
+}
+
+static void mgui_drawlist_add_occluder( MGuiElement* layer, MGuiElement* element )
+{
+	rectangle_t r;
+
+	if ( num_occluders >= DRAWLIST_MAX_OCCLUDERS ) return;
+	if ( !mgui_drawlist_is_opaque( element ) ) return;
+
+	// Windows fill only their own bounds with the background, not the titlebar.
+	if ( !mgui_drawlist_intersect( &r, &element->bounds, &draw_rect ) )
+		return;
+
+	if ( element != layer && BIT_ON( layer->flags, FLAG_CLIP ) &&
+		 !mgui_drawlist_intersect( &r, &r, &layer->bounds ) )
+		return;
+
+	occluders[num_occluders++] = r;
+}
+
+static MYLLY_INLINE bool mgui_drawlist_is_opaque( MGuiElement* element )
+{
+	if ( element->colour.a != 0xFF ) return false;
+	if ( element->cache != NULL ) return false;
+
+	switch ( element->type )
+	{
+	case GUI_CANVAS:
+		return true;
+
+	case GUI_WINDOW:
+		return BIT_ON( element->flags, FLAG_BACKGROUND );
+
+	default:
+		return false;
+	}
+}
+
+static MYLLY_INLINE bool mgui_drawlist_occluded( struct MGuiDrawList* list, const rectangle_t* rect )
+{
+	const rectangle_t* o;
+	uint32 i;
+
+	for ( i = 0; i < list->num_occluders; i++ )
+	{
+		o = &occluders[i];
+
+		if ( rect->x >= o->x && rect->x + rect->w <= o->x + o->w &&
+			 rect->y >= o->y && rect->y + rect->h <= o->y + o->h )
+			return true;
+	}
+
+	return false;
+}
+
+static MYLLY_INLINE void mgui_drawlist_set_clip( struct MGuiDrawList* list, uint32* current, uint32 clip )
+{
+	rectangle_t* r;
+
+	// Change the clipping region only when it's different from the previous element's.
+	if ( *current == clip ) return;
+
+	*current = clip;
+
+	if ( clip == DRAWLIST_NO_CLIP )
+	{
+		renderer->end_clip();
+		return;
+	}
+
+	r = &list->items[clip].view;
+	renderer->start_clip( r->x, r->y, r->w, r->h );
+}
+
+static MYLLY_INLINE bool mgui_drawlist_intersect( rectangle_t* dst, const rectangle_t* a, const rectangle_t* b )
+{
+	int32 x1, y1, x2, y2;
+
+	if ( b == NULL )
+	{
+		*dst = *a;
+		return true;
+	}
+
+	x1 = math_max( a->x, b->x );
+	y1 = math_max( a->y, b->y );
+	x2 = math_min( a->x + a->w, b->x + b->w );
+	y2 = math_min( a->y + a->h, b->y + b->h );
+
+	if ( x2 <= x1 || y2 <= y1 ) return false;
+
+	dst->x = (int16)x1;
+	dst->y = (int16)y1;
+	dst->w = (uint16)( x2 - x1 );
+	dst->h = (uint16)( y2 - y1 );
+
+	return true;
+}
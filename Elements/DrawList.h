@@ -0,0 +1,58 @@
+/**
+ *
+ * @file		DrawList.h
+ * @copyright	Tuomo Jauhiainen 2012-2014
+ * @licence		See Licence.txt
+ * @brief		Flattened draw order of a layer.
+ *
+ * @details		A per-layer array of the visible elements in the order they are drawn, rebuilt only when the element tree changes.
+ *
+ **/
+
+#pragma once
+#ifndef __MGUI_DRAWLIST_H
+#define __MGUI_DRAWLIST_H
+
+#include "Element.h"
+
+#define DRAWLIST_NO_CLIP		((uint32)-1)	///< Entry index used when an element is not clipped by anything
+#define DRAWLIST_UNKNOWN_CLIP	((uint32)-2)	///< Clip state used when the renderer's clipping region is not known
+#define DRAWLIST_MAX_OCCLUDERS	16				///< Maximum number of opaque rectangles tracked per frame
+
+/**
+ * @brief A single entry of a draw list.
+ *
+ * @details Each visible element has an entry in the list. Elements which have
+ * a post-render callback get a second entry right after their children.
+ * The bounds are a pointer to the element data, so moving or resizing
+ * an element does not require the list to be rebuilt. Clipping is stored as
+ * indices to the entries of the clipping predecessors, whose visible regions
+ * are resolved during each render pass.
+ */
+typedef struct {
+	MGuiElement*	element;		///< The element to be drawn
+	rectangle_t*	bounds;			///< Clip region of the element
+	rectangle_t		view;			///< Visible part of the clip region, updated while rendering (valid only for clipping elements)
+	uint32			clip;			///< Entry whose visible region clips the element's contents, or DRAWLIST_NO_CLIP
+	uint32			outer;			///< Entry whose visible region clips the element itself, or DRAWLIST_NO_CLIP
+	uint32			next;			///< Index of the first entry after the children of this element
+	bool			post;			///< This entry is for the post-render callback of the element
+} MGuiDrawItem;
+
+/**
+ * @brief Draw list of a layer.
+ */
+struct MGuiDrawList {
+	MGuiDrawItem*	items;			///< Entries in draw order
+	uint32			num_items;		///< Number of entries in the list
+	uint32			size;			///< Number of entries the list has room for
+	uint32			num_occluders;	///< Number of opaque rectangles on top of the layer during the current frame
+	bool			dirty;			///< The layer has changed structurally, the list has to be rebuilt
+};
+
+void			mgui_drawlist_begin_frame		( void );
+void			mgui_drawlist_destroy			( MGuiElement* layer );
+void			mgui_drawlist_invalidate		( MGuiElement* element );
+void			mgui_drawlist_render			( MGuiElement* layer );
+
+#endif /* __MGUI_DRAWLIST_H */
@@ -12,6 +12,7 @@
 #include "Editbox.h"
 #include "Skin.h"
 #include "Renderer.h"
+#include "TimerWheel.h"
 #include "Platform/Alloc.h"
 #include "Platform/Timer.h"
 #include "Platform/Window.h"
@@ -92,16 +93,16 @@ MGuiEditbox* mgui_create_editbox( MGuiElement* parent )
 	struct MGuiEditbox* editbox;
 	extern MGuiFont* default_font;
 
-	editbox = mem_alloc_clean( sizeof(*editbox) );
+	editbox = mgui_element_alloc( GUI_EDITBOX, sizeof(*editbox) );
 	mgui_element_create( cast_elem(editbox), parent );
 
 	editbox->type = GUI_EDITBOX;
 	editbox->flags |= (FLAG_BORDER|FLAG_BACKGROUND|FLAG_CLIP|FLAG_DRAGGABLE|FLAG_MOUSECTRL|FLAG_KBCTRL|FLAG_ANIMATION);
 	editbox->flags_int &= ~INTFLAG_NOTEXT;
 
-	// Create an initial buffer
-	editbox->text->bufsize = 20;
-	editbox->text->buffer = mem_alloc( editbox->text->bufsize );
+	// Use the inline buffer of the text initially
+	editbox->text->bufsize = lengthof(editbox->text->inline_buf);
+	editbox->text->buffer = editbox->text->inline_buf;
 	editbox->buffer = mem_alloc( editbox->text->bufsize );
 	*editbox->text->buffer = '\0';
 	*editbox->buffer = '\0';
@@ -172,6 +173,7 @@ static void mgui_editbox_process( MGuiElement* element )
 	struct MGuiEditbox* editbox;
 	editbox = (struct MGuiEditbox*)element;
 
+	// The cursor is animated only while the editbox has focus. The timer is restarted when focus is regained.
 	if ( BIT_OFF( editbox->flags_int, INTFLAG_FOCUS ) ) return;
 
 	if ( tick_count - editbox->last_update >= 500 )
@@ -181,6 +183,9 @@ static void mgui_editbox_process( MGuiElement* element )
 
 		mgui_element_request_redraw( element );
 	}
+
+	// Typing resets the animation, so wait for whatever is left of the current cycle.
+	mgui_timer_set( element, 500 - ( tick_count - editbox->last_update ) );
 }
 
 static void mgui_editbox_on_bounds_change( MGuiElement* element, bool pos, bool size )
@@ -635,7 +640,9 @@ static void mgui_editbox_insert_text( struct MGuiEditbox* editbox, const char_t*
 		editbox->buffer = mem_alloc( size * sizeof(char_t) );
 
 		mstrcpy( editbox->text->buffer, old, size );
-		mem_free( old );
+
+		if ( old != editbox->text->inline_buf )
+			mem_free( old );
 	}
 
 	mstrins( editbox->text->buffer, text, editbox->text->bufsize, editbox->cursor_pos );
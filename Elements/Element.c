@@ -13,25 +13,53 @@
 #include "Skin.h"
 #include "InputHook.h"
 #include "Window.h"
+#include "Damage.h"
+#include "HitGrid.h"
+#include "DrawList.h"
+#include "Pool.h"
+#include "TimerWheel.h"
+#include "Stats.h"
 #include "Renderer.h"
 #include "Platform/Alloc.h"
 #include "Stringy/Stringy.h"
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
 
 // --------------------------------------------------
 
 extern vectorscreen_t draw_size;
 extern MGuiRenderer* renderer;
 extern list_t* layers;
+extern uint32 update_depth;
+
+static MGuiPool element_pools[GUI_NUM_TYPES];	// Memory pools for each element type
 
 // --------------------------------------------------
 
 static MYLLY_INLINE MGuiElement*	mgui_get_element_at_test_self		( MGuiElement* element, int16 x, int16 y );
 static MYLLY_INLINE MGuiElement*	mgui_get_element_at_test_bounds		( MGuiElement* element, int16 x, int16 y );
+static void							mgui_element_damage_bounds			( MGuiElement* element, const rectangle_t* old );
+static void							mgui_element_refresh_font			( MGuiElement* element, MGuiFont* font );
+static uint32						mgui_element_get_child_index		( MGuiElement* parent, MGuiElement* child );
+static void							mgui_element_move_child				( MGuiElement* parent, uint32 from, uint32 to );
+static bool							mgui_element_defer_layout			( MGuiElement* element, const rectangle_t* old, uint32 flags );
+static bool							mgui_element_defer_text				( MGuiElement* element );
+static void							mgui_element_mark_layout_path		( MGuiElement* element );
 
 // --------------------------------------------------
 
+void* mgui_element_alloc( MGUI_TYPE type, size_t size )
+{
+	MGuiPool* pool = &element_pools[type];
+
+	// Elements are allocated from a pool of their own type, so they all share the same size.
+	if ( pool->size == 0 )
+		mgui_pool_initialize( pool, size );
+
+	return mgui_pool_alloc( pool );
+}
+
 void mgui_element_create( MGuiElement* element, MGuiElement* parent )
 {
 	element->flags |= (FLAG_VISIBLE|FLAG_CLIP|FLAG_INHERIT_ALPHA);
@@ -39,7 +67,9 @@ void mgui_element_create( MGuiElement* element, MGuiElement* parent )
 
 	if ( BIT_OFF( element->flags_int, INTFLAG_NOTEXT ) )
 	{
-		element->text = mgui_text_create();
+		element->text = &element->text_data;
+		mgui_text_initialize( element->text );
+
 		element->text->bounds = &element->bounds;
 		element->text->colour.hex = COL_TEXT;
 	}
@@ -76,23 +106,20 @@ void mgui_element_create( MGuiElement* element, MGuiElement* parent )
  */
 void mgui_element_destroy( MGuiElement* element )
 {
-	node_t *node, *tmp;
-
 	if ( element == NULL )
 		return;
 
 	mgui_remove_child( element );
+	mgui_hitgrid_destroy( element );
+	mgui_drawlist_destroy( element );
+	mgui_timer_cancel( element );
 
-	// Destroy child elements if any.
-	if ( element->children )
-	{
-		list_foreach_safe( element->children, node, tmp )
-		{
-			mgui_element_destroy( cast_elem(node) );
-		}
+	// Destroy child elements if any. Each child removes itself from the array, so start from the last one.
+	while ( element->num_children > 0 )
+		mgui_element_destroy( element->children[element->num_children - 1] );
 
-		list_destroy( element->children );
-	}
+	if ( element->children != NULL )
+		mem_free( element->children );
 
 	if ( element->callbacks->destroy )
 		element->callbacks->destroy( element );
@@ -105,13 +132,13 @@ void mgui_element_destroy( MGuiElement* element )
 
 	mgui_input_cleanup_references( element );
 
-	// Finally free the element itself
-	mem_free( element );
+	// Finally return the element itself to the pool
+	mgui_pool_free( &element_pools[element->type], element );
 }
 
 void mgui_element_render_cache( MGuiElement* element, bool draw_self )
 {
-	node_t* node;
+	uint32 i;
 	rectangle_t* r;
 	extern uint32 params;
 	static colour_t cache_colour = { 0xFFFFFFFF };
@@ -124,11 +151,11 @@ void mgui_element_render_cache( MGuiElement* element, bool draw_self )
 	if ( !draw_self && element->cache == NULL )
 	{
 		element->flags_int &= ~INTFLAG_REFRESH;
-		if ( element->children == NULL ) return;
+		if ( element->num_children == 0 ) return;
 		
-		list_foreach( element->children, node )
+		for ( i = 0; i < element->num_children; i++ )
 		{
-			mgui_element_render_cache( cast_elem(node), false );
+			mgui_element_render_cache( element->children[i], false );
 		}
 		return;
 	}
@@ -150,7 +177,10 @@ void mgui_element_render_cache( MGuiElement* element, bool draw_self )
 
 	// If not, we'll really have to draw everything again.
 	if ( element->cache != NULL )
+	{
+		MGUI_STATS_INC( cache_refreshes );
 		renderer->enable_render_target( element->cache, r->x, r->y );
+	}
 
 	// Set clipping region and toggle clip mode.
 	if ( element->flags & FLAG_CLIP )
@@ -158,14 +188,17 @@ void mgui_element_render_cache( MGuiElement* element, bool draw_self )
 
 	// Render the element itself
 	if ( element->callbacks->render )
+	{
+		MGUI_STATS_INC( elements_rendered );
 		element->callbacks->render( element );
+	}
 
 	// If the element has any children, draw them now.
-	if ( element->children )
+	if ( element->num_children > 0 )
 	{
-		list_foreach( element->children, node )
+		for ( i = 0; i < element->num_children; i++ )
 		{
-			mgui_element_render_cache( (MGuiElement*)node, true );
+			mgui_element_render_cache( element->children[i], true );
 		}
 	}
 
@@ -200,125 +233,9 @@ void mgui_element_render_cache( MGuiElement* element, bool draw_self )
 	}
 }
 
-void mgui_element_render( MGuiElement* element )
-{
-	node_t* node;
-	rectangle_t* r;
-	DRAW_MODE draw_mode = DRAWING_INVALID;
-	static colour_t cache_colour = { 0xFFFFFFFF };
-
-	if ( element == NULL ) return;
-	if ( BIT_OFF( element->flags, FLAG_VISIBLE ) ) return;
-
-	// Get element boundaries
-	r = element->callbacks->get_clip_region ?
-		element->callbacks->get_clip_region( element, &r ), r :
-		&element->bounds;
-
-	// If the element is a 3D element, toggle special drawing mode.
-	// Make sure the element is also a root element (to avoid some dodgy results)
-	if ( element->parent == NULL )
-	{
-		switch ( element->flags & (FLAG_3D_ENTITY|FLAG_DEPTH_TEST) )
-		{
-		case FLAG_DEPTH_TEST:
-			draw_mode = renderer->set_draw_mode( DRAWING_2D_DEPTH );
-			renderer->set_draw_depth( element->z_depth );
-			break;
-
-		case FLAG_3D_ENTITY:
-			draw_mode = renderer->set_draw_mode( DRAWING_3D );
-			renderer->set_draw_transform( &element->transform->transform );
-			renderer->set_draw_depth( element->z_depth );
-			break;
-		}
-	}
-
-	// Do we have a cache texture?
-	if ( element->cache != NULL )
-	{
-		cache_colour.a = element->colour.a;
-
-		renderer->set_draw_colour( &cache_colour );
-		renderer->draw_render_target( element->cache, r->x, r->y, r->w, r->h );
-
-		// This fixes a bug which didn't update the element's cache in some cases
-		// after it was made visible. It's not really ideal but it seems to work.
-		if ( element->flags_int & INTFLAG_REFRESH )
-			mgui_element_request_redraw( element );
-	}
-	else
-	{
-		// Set clipping region and toggle clip mode.
-		if ( BIT_ON( element->flags, FLAG_CLIP ) )
-			renderer->start_clip( r->x, r->y, r->w, r->h );
-
-		// Render the element itself
-		if ( element->callbacks->render )
-			element->callbacks->render( element );
-
-		// If the element has children, draw them now.
-		if ( element->children )
-		{
-			list_foreach( element->children, node )
-			{
-				mgui_element_render( cast_elem(node) );
-			}
-		}
-
-		// Disable clip mode.
-		if ( element->flags & FLAG_CLIP )
-			renderer->end_clip();
-	}
-
-	// Reset draw modes back to original.
-	if ( draw_mode != DRAWING_INVALID )
-	{
-		renderer->set_draw_mode( draw_mode );
-		renderer->set_draw_depth( 1.0f );
-	}
-
-	if ( element->flags & FLAG_3D_ENTITY )
-		renderer->reset_draw_transform();
-
-	// Do post-render processing (effects etc.)
-	if ( element->callbacks->post_render )
-		element->callbacks->post_render( element );
-
-	// Re-enable parent clipping if necessary.
-	element = element->parent;
-
-	if ( element && BIT_ON( element->flags, FLAG_CLIP ) )
-	{
-		r = element->callbacks->get_clip_region ?
-			element->callbacks->get_clip_region( element, &r ), r :
-			&element->bounds;
-
-		renderer->start_clip( r->x, r->y, r->w, r->h );
-	}
-}
-
-void mgui_element_process( MGuiElement* element )
-{
-	node_t* node;
-
-	if ( element == NULL ) return;
-	if ( BIT_OFF( element->flags, FLAG_VISIBLE ) ) return;
-
-	if ( element->callbacks->process )
-		element->callbacks->process( element );
-
-	if ( !element->children ) return;
-
-	list_foreach( element->children, node )
-	{
-		mgui_element_process( cast_elem(node) );
-	}
-}
-
 void mgui_element_initialize( MGuiElement* element )
 {
-	node_t* node;
+	uint32 i;
 	rectangle_t* r;
 
 	if ( element == NULL ) return;
@@ -333,18 +250,18 @@ void mgui_element_initialize( MGuiElement* element )
 		element->cache = renderer->create_render_target( r->w, r->h );
 	}
 
-	if ( element->children == NULL ) return;
+	if ( element->num_children == 0 ) return;
 
 	// Do it for all the child elements as well
-	list_foreach( element->children, node )
+	for ( i = 0; i < element->num_children; i++ )
 	{
-		mgui_element_initialize( cast_elem(node) );
+		mgui_element_initialize( element->children[i] );
 	}
 }
 
 void mgui_element_invalidate( MGuiElement* element )
 {
-	node_t* node;
+	uint32 i;
 
 	if ( element == NULL ) return;
 
@@ -355,12 +272,12 @@ void mgui_element_invalidate( MGuiElement* element )
 		element->cache = NULL;
 	}
 
-	if ( element->children == NULL ) return;
+	if ( element->num_children == 0 ) return;
 
 	// Do it for all the child elements as well
-	list_foreach( element->children, node )
+	for ( i = 0; i < element->num_children; i++ )
 	{
-		mgui_element_invalidate( cast_elem(node) );
+		mgui_element_invalidate( element->children[i] );
 	}
 }
 
@@ -393,12 +310,19 @@ void mgui_element_request_redraw( MGuiElement* element )
 {
 	extern bool refresh_all;
 	extern bool redraw_cache;
+	rectangle_t* r;
 
 	refresh_all = true;
 
 	// Invalidate this element and all its predecessors
 	if ( element != NULL )
 	{
+		r = element->callbacks->get_clip_region ?
+			element->callbacks->get_clip_region( element, &r ), r :
+			&element->bounds;
+
+		mgui_damage_add( r );
+
 		while ( element )
 		{
 			if ( element->cache != NULL )
@@ -408,24 +332,136 @@ void mgui_element_request_redraw( MGuiElement* element )
 			element = element->parent;
 		}
 	}
+	else
+	{
+		mgui_damage_add_all();
+	}
 }
 
 void mgui_element_request_redraw_all( void )
 {
 	extern bool refresh_all;
+
+	mgui_damage_add_all();
+	refresh_all = true;
+}
+
+void mgui_element_request_redraw_rect( const rectangle_t* rect )
+{
+	extern bool refresh_all;
+
+	mgui_damage_add( rect );
 	refresh_all = true;
 }
 
+void mgui_element_refresh_font_all( MGuiFont* font )
+{
+	node_t* node;
+	extern list_t* layers;
+
+	if ( layers == NULL ) return;
+
+	list_foreach( layers, node )
+	{
+		mgui_element_refresh_font( cast_elem(node), font );
+	}
+}
+
+static void mgui_element_refresh_font( MGuiElement* element, MGuiFont* font )
+{
+	uint32 i;
+
+	if ( element->text != NULL && element->text->font == font )
+	{
+		// The text is measured again when the layout is resolved.
+		element->text->flags |= TFLAG_DEFERRED;
+		element->flags_int |= INTFLAG_LAYOUT_TEXT;
+		mgui_element_mark_layout_path( element );
+		mgui_element_request_redraw( element );
+	}
+
+	for ( i = 0; i < element->num_children; i++ )
+	{
+		mgui_element_refresh_font( element->children[i], font );
+	}
+}
+
+static void mgui_element_damage_bounds( MGuiElement* element, const rectangle_t* old )
+{
+	rectangle_t* r;
+
+	r = element->callbacks->get_clip_region ?
+		element->callbacks->get_clip_region( element, &r ), r :
+		&element->bounds;
+
+	// Redraw both the area the element used to cover and the area it covers now.
+	mgui_element_request_redraw_rect( old );
+	mgui_element_request_redraw_rect( r );
+}
+
+static bool mgui_element_defer_layout( MGuiElement* element, const rectangle_t* old, uint32 flags )
+{
+	if ( update_depth == 0 ) return false;
+
+	// The area the element used to cover has to be redrawn only once per transaction.
+	if ( BIT_OFF( element->flags_int, INTFLAG_LAYOUT_POS|INTFLAG_LAYOUT_SIZE ) )
+		mgui_element_request_redraw_rect( old );
+
+	element->flags_int |= flags;
+	mgui_element_mark_layout_path( element );
+
+	return true;
+}
+
+static bool mgui_element_defer_text( MGuiElement* element )
+{
+	if ( update_depth == 0 ) return false;
+
+	// The text is measured when the transaction is committed.
+	element->text->flags |= TFLAG_DEFERRED;
+	element->flags_int |= INTFLAG_LAYOUT_TEXT;
+	mgui_element_mark_layout_path( element );
+
+	return true;
+}
+
+static void mgui_element_mark_layout_path( MGuiElement* element )
+{
+	// Let the predecessors know that there's something to resolve within them.
+	for ( element = element->parent; element != NULL; element = element->parent )
+	{
+		if ( element->flags_int & INTFLAG_LAYOUT_CHILD ) break;
+		element->flags_int |= INTFLAG_LAYOUT_CHILD;
+	}
+}
+
 MGuiElement* mgui_get_element_at( int16 x, int16 y )
 {
 	node_t* node;
 	MGuiElement *ret = NULL;
+	extern rectangle_t draw_rect;
 
 	if ( layers == NULL || list_empty( layers ) )
 	{
 		return ret;
 	}
 
+	// Use the hit grids of the layers when possible. The grids only cover
+	// the window, so anything outside it has to be found the hard way.
+	if ( rect_is_point_in( &draw_rect, x, y ) )
+	{
+		list_foreach_r( layers, node )
+		{
+			ret = mgui_hitgrid_get_element_at( cast_elem(node), x, y );
+			if ( ret )
+			{
+				return ret;
+			}
+		}
+
+		return ret;
+	}
+
 	list_foreach_r( layers, node )
 	{
 		ret = mgui_get_element_at_test_self( cast_elem(node), x, y );
@@ -440,7 +476,7 @@ MGuiElement* mgui_get_element_at( int16 x, int16 y )
 
 MYLLY_INLINE MGuiElement* mgui_get_element_at_test_self( MGuiElement* element, int16 x, int16 y )
 {
-	node_t* node;
+	uint32 i;
 	MGuiElement *ret, *tmp = NULL;
 
 	// Check that the element is actually visible and active
@@ -457,11 +493,11 @@ MYLLY_INLINE MGuiElement* mgui_get_element_at_test_self( MGuiElement* element, i
 	}
 
 	// If so, check all the child elements
-	if ( ret->children )
+	if ( ret->num_children > 0 )
 	{
-		list_foreach_r( ret->children, node )
+		for ( i = ret->num_children; i > 0; i-- )
 		{
-			if ( ( tmp = mgui_get_element_at_test_self( cast_elem(node), x, y ) ) != NULL )
+			if ( ( tmp = mgui_get_element_at_test_self( ret->children[i - 1], x, y ) ) != NULL )
 			{
 				return tmp;
 			}
@@ -535,6 +571,8 @@ static MYLLY_INLINE MGuiElement* mgui_get_element_at_test_bounds( MGuiElement* e
  */
 void mgui_add_child( MGuiElement* parent, MGuiElement* child )
 {
+	MGuiElement** tmp;
+
 	if ( child == NULL ) return;
 	if ( child->parent != NULL ) return;
 	if ( BIT_ON( child->flags, FLAG_3D_ENTITY ) ) return;
@@ -545,14 +583,27 @@ void mgui_add_child( MGuiElement* parent, MGuiElement* child )
 	{
 		child->flags_int &= ~INTFLAG_LAYER;
 		list_remove( layers, cast_node(child) );
+		mgui_hitgrid_destroy( child );
+		mgui_drawlist_destroy( child );
 	}
 
 	if ( parent != NULL )
 	{
-		if ( parent->children == NULL )
-			parent->children = list_create();
+		if ( parent->num_children >= parent->children_size )
+		{
+			parent->children_size = parent->children_size ? parent->children_size * 2 : 4;
+			tmp = mem_alloc( parent->children_size * sizeof(MGuiElement*) );
+
+			if ( parent->children != NULL )
+			{
+				memcpy( tmp, parent->children, parent->num_children * sizeof(MGuiElement*) );
+				mem_free( parent->children );
+			}
 
-		list_push( parent->children, cast_node(child) );
+			parent->children = tmp;
+		}
+
+		parent->children[parent->num_children++] = child;
 		child->parent = parent;
 
 		if ( child->type != GUI_NONE )
@@ -564,6 +615,8 @@ void mgui_add_child( MGuiElement* parent, MGuiElement* child )
 		child->flags_int |= INTFLAG_LAYER;
 	}
 
+	mgui_hitgrid_invalidate( child );
+	mgui_drawlist_invalidate( child );
 	mgui_element_request_redraw( parent );
 }
 
@@ -578,16 +631,30 @@ void mgui_add_child( MGuiElement* parent, MGuiElement* child )
  */
 void mgui_remove_child( MGuiElement* child )
 {
+	MGuiElement* parent;
+
 	if ( child == NULL )
 		return;
 
-	if ( child->parent && child->parent->children )
+	mgui_hitgrid_invalidate( child );
+	mgui_drawlist_invalidate( child );
+
+	if ( child->parent && child->parent->num_children > 0 )
 	{
-		list_remove( child->parent->children, cast_node(child) );
+		// Make sure the area the element used to cover gets redrawn.
+		mgui_element_request_redraw( child );
+
+		// Move the child to the end of the array and drop it from there.
+		parent = child->parent;
+		mgui_element_move_child( parent, mgui_element_get_child_index( parent, child ), parent->num_children - 1 );
+
+		parent->num_children--;
 		child->parent = NULL;
 	}
 	else if ( BIT_ON( child->flags_int, INTFLAG_LAYER ) )
 	{
+		mgui_element_request_redraw( child );
+
 		list_remove( layers, cast_node(child) );
 		child->flags_int &= ~INTFLAG_LAYER;
 	}
@@ -604,18 +671,27 @@ void mgui_remove_child( MGuiElement* child )
  */
 void mgui_move_forward( MGuiElement* child )
 {
+	uint32 index;
+
 	if ( child == NULL )
 		return;
 
-	if ( child->parent && child->parent->children )
+	if ( child->parent && child->parent->num_children > 0 )
 	{
-		// Yes, this is a bit backwards (no pun intended), but the list is rendered from front to back.
-		list_move_backward( child->parent->children, cast_node(child) );
+		// The children are rendered from the first one to the last one.
+		index = mgui_element_get_child_index( child->parent, child );
+
+		if ( index + 1 < child->parent->num_children )
+			mgui_element_move_child( child->parent, index, index + 1 );
 	}
 	else if ( BIT_ON( child->flags_int, INTFLAG_LAYER ) )
 	{
 		list_move_backward( layers, cast_node(child) );
 	}
+
+	mgui_hitgrid_invalidate( child );
+	mgui_drawlist_invalidate( child );
+	mgui_element_request_redraw( child );
 }
 
 /**
@@ -629,17 +705,26 @@ void mgui_move_forward( MGuiElement* child )
  */
 void mgui_move_backward( MGuiElement* child )
 {
+	uint32 index;
+
 	if ( child == NULL )
 		return;
 
-	if ( child->parent && child->parent->children )
+	if ( child->parent && child->parent->num_children > 0 )
 	{
-		list_move_forward( child->parent->children, cast_node(child) );
+		index = mgui_element_get_child_index( child->parent, child );
+
+		if ( index > 0 && index < child->parent->num_children )
+			mgui_element_move_child( child->parent, index, index - 1 );
 	}
 	else if ( BIT_ON( child->flags_int, INTFLAG_LAYER ) )
 	{
 		list_move_forward( layers, cast_node(child) );
 	}
+
+	mgui_hitgrid_invalidate( child );
+	mgui_drawlist_invalidate( child );
+	mgui_element_request_redraw( child );
 }
 
 /**
@@ -653,17 +738,26 @@ void mgui_move_backward( MGuiElement* child )
  */
 void mgui_send_to_top( MGuiElement* child )
 {
+	uint32 index;
+
 	if ( child == NULL )
 		return;
 
-	if ( child->parent && child->parent->children )
+	if ( child->parent && child->parent->num_children > 0 )
 	{
-		list_send_to_back( child->parent->children, cast_node(child) );
+		index = mgui_element_get_child_index( child->parent, child );
+
+		if ( index < child->parent->num_children )
+			mgui_element_move_child( child->parent, index, child->parent->num_children - 1 );
 	}
 	else if ( BIT_ON( child->flags_int, INTFLAG_LAYER ) )
 	{
 		list_send_to_back( layers, cast_node(child) );
 	}
+
+	mgui_hitgrid_invalidate( child );
+	mgui_drawlist_invalidate( child );
+	mgui_element_request_redraw( child );
 }
 
 /**
@@ -677,16 +771,55 @@ void mgui_send_to_top( MGuiElement* child )
  */
 void mgui_send_to_bottom( MGuiElement* child )
 {
+	uint32 index;
+
 	if ( child == NULL ) return;
 
-	if ( child->parent && child->parent->children )
+	if ( child->parent && child->parent->num_children > 0 )
 	{
-		list_send_to_front( child->parent->children, cast_node(child) );
+		index = mgui_element_get_child_index( child->parent, child );
+
+		if ( index < child->parent->num_children )
+			mgui_element_move_child( child->parent, index, 0 );
 	}
 	else if ( BIT_ON( child->flags_int, INTFLAG_LAYER ) )
 	{
 		list_send_to_front( layers, cast_node(child) );
 	}
+
+	mgui_hitgrid_invalidate( child );
+	mgui_drawlist_invalidate( child );
+	mgui_element_request_redraw( child );
+}
+
+static uint32 mgui_element_get_child_index( MGuiElement* parent, MGuiElement* child )
+{
+	uint32 i;
+
+	for ( i = 0; i < parent->num_children; i++ )
+	{
+		if ( parent->children[i] == child )
+			return i;
+	}
+
+	return parent->num_children;
+}
+
+static void mgui_element_move_child( MGuiElement* parent, uint32 from, uint32 to )
+{
+	MGuiElement* child;
+
+	if ( from >= parent->num_children || from == to ) return;
+
+	child = parent->children[from];
+
+	// Shift the elements between the old and the new position by one.
+	if ( from < to )
+		memmove( &parent->children[from], &parent->children[from + 1], ( to - from ) * sizeof(MGuiElement*) );
+	else
+		memmove( &parent->children[to + 1], &parent->children[to], ( from - to ) * sizeof(MGuiElement*) );
+
+	parent->children[to] = child;
 }
 
 /**
@@ -709,10 +842,17 @@ bool mgui_is_child_of( MGuiElement* parent, MGuiElement* child )
 void mgui_element_update_abs_pos( MGuiElement* elem )
 {
 	rectangle_t* r;
-	node_t* node;
+	rectangle_t old;
+	uint32 i;
 
 	if ( elem == NULL ) return;
 
+	r = elem->callbacks->get_clip_region ?
+		elem->callbacks->get_clip_region( elem, &r ), r :
+		&elem->bounds;
+
+	old = *r;
+
 	if ( elem->parent != NULL )
 	{
 		r = &elem->parent->bounds;
@@ -728,6 +868,9 @@ void mgui_element_update_abs_pos( MGuiElement* elem )
 		elem->bounds.y = (int16)( elem->pos.y * draw_size.y );
 	}
 
+	// Inside a layout transaction the rest is done once the transaction is committed.
+	if ( mgui_element_defer_layout( elem, &old, INTFLAG_LAYOUT_POS ) ) return;
+
 	if ( elem->text != NULL )
 	{
 		elem->text->bounds = &elem->bounds;
@@ -737,22 +880,30 @@ void mgui_element_update_abs_pos( MGuiElement* elem )
 	if ( elem->callbacks->on_bounds_change )
 		elem->callbacks->on_bounds_change( elem, true, false );
 
-	mgui_element_request_redraw_all();
+	mgui_element_damage_bounds( elem, &old );
+	mgui_hitgrid_update( elem );
 
-	if ( elem->children == NULL ) return;
+	if ( elem->num_children == 0 ) return;
 
-	list_foreach( elem->children, node )
+	for ( i = 0; i < elem->num_children; i++ )
 	{
-		mgui_element_update_child_pos( cast_elem(node) );
+		mgui_element_update_child_pos( elem->children[i] );
 	}
 }
 
 void mgui_element_update_abs_size( MGuiElement* elem )
 {
-	node_t* node;
+	uint32 i;
+	rectangle_t old, *r;
 
 	if ( elem == NULL ) return;
 
+	r = elem->callbacks->get_clip_region ?
+		elem->callbacks->get_clip_region( elem, &r ), r :
+		&elem->bounds;
+
+	old = *r;
+
 	if ( elem->parent != NULL )
 	{
 		elem->bounds.w = (uint16)( elem->size.x * elem->parent->bounds.w );
@@ -766,6 +917,9 @@ void mgui_element_update_abs_size( MGuiElement* elem )
 		elem->bounds.h = (uint16)( elem->size.y * draw_size.y );
 	}
 
+	// Inside a layout transaction the rest is done once the transaction is committed.
+	if ( mgui_element_defer_layout( elem, &old, INTFLAG_LAYOUT_SIZE ) ) return;
+
 	if ( elem->text != NULL )
 	{
 		elem->text->bounds = &elem->bounds;
@@ -778,23 +932,31 @@ void mgui_element_update_abs_size( MGuiElement* elem )
 	if ( elem->flags & FLAG_CACHE_TEXTURE )
 		mgui_element_resize_cache( elem );
 
-	mgui_element_request_redraw_all();
+	mgui_element_damage_bounds( elem, &old );
+	mgui_hitgrid_update( elem );
 
-	if ( elem->children == NULL ) return;
+	if ( elem->num_children == 0 ) return;
 
-	list_foreach( elem->children, node )
+	for ( i = 0; i < elem->num_children; i++ )
 	{
-		mgui_element_update_child_pos( cast_elem(node) );
+		mgui_element_update_child_pos( elem->children[i] );
 	}
 }
 
 void mgui_element_update_rel_pos( MGuiElement* elem )
 {
 	rectangle_t* r;
-	node_t* node;
+	rectangle_t old;
+	uint32 i;
 
 	if ( elem == NULL ) return;
 
+	r = elem->callbacks->get_clip_region ?
+		elem->callbacks->get_clip_region( elem, &r ), r :
+		&elem->bounds;
+
+	old = *r;
+
 	if ( elem->parent != NULL )
 	{
 		r = &elem->parent->bounds;
@@ -810,6 +972,9 @@ void mgui_element_update_rel_pos( MGuiElement* elem )
 		elem->pos.y = (float)elem->bounds.y / draw_size.y;
 	}
 
+	// Inside a layout transaction the rest is done once the transaction is committed.
+	if ( mgui_element_defer_layout( elem, &old, INTFLAG_LAYOUT_POS ) ) return;
+
 	if ( elem->text != NULL )
 	{
 		elem->text->bounds = &elem->bounds;
@@ -819,22 +984,30 @@ void mgui_element_update_rel_pos( MGuiElement* elem )
 	if ( elem->callbacks->on_bounds_change )
 		elem->callbacks->on_bounds_change( elem, true, false );
 
-	mgui_element_request_redraw_all();
+	mgui_element_damage_bounds( elem, &old );
+	mgui_hitgrid_update( elem );
 
-	if ( elem->children == NULL ) return;
+	if ( elem->num_children == 0 ) return;
 
-	list_foreach( elem->children, node )
+	for ( i = 0; i < elem->num_children; i++ )
 	{
-		mgui_element_update_child_pos( cast_elem(node) );
+		mgui_element_update_child_pos( elem->children[i] );
 	}
 }
 
 void mgui_element_update_rel_size( MGuiElement* elem )
 {
-	node_t* node;
+	uint32 i;
+	rectangle_t old, *r;
 
 	if ( elem == NULL ) return;
 
+	r = elem->callbacks->get_clip_region ?
+		elem->callbacks->get_clip_region( elem, &r ), r :
+		&elem->bounds;
+
+	old = *r;
+
 	if ( elem->parent != NULL )
 	{
 		elem->size.x = (float)elem->bounds.w / elem->parent->bounds.w;
@@ -848,6 +1021,9 @@ void mgui_element_update_rel_size( MGuiElement* elem )
 		elem->size.y = (float)elem->bounds.h / draw_size.y;
 	}
 
+	// Inside a layout transaction the rest is done once the transaction is committed.
+	if ( mgui_element_defer_layout( elem, &old, INTFLAG_LAYOUT_SIZE ) ) return;
+
 	if ( elem->text != NULL )
 	{
 		elem->text->bounds = &elem->bounds;
@@ -860,24 +1036,30 @@ void mgui_element_update_rel_size( MGuiElement* elem )
 	if ( elem->flags & FLAG_CACHE_TEXTURE )
 		mgui_element_resize_cache( elem );
 
-	mgui_element_request_redraw_all();
+	mgui_element_damage_bounds( elem, &old );
+	mgui_hitgrid_update( elem );
 
-	if ( elem->children == NULL ) return;
+	if ( elem->num_children == 0 ) return;
 
-	list_foreach( elem->children, node )
+	for ( i = 0; i < elem->num_children; i++ )
 	{
-		mgui_element_update_child_pos( cast_elem(node) );
+		mgui_element_update_child_pos( elem->children[i] );
 	}
 }
 
 void mgui_element_update_child_pos( MGuiElement* elem )
 {
-	node_t* node;
-	rectangle_t* r;
+	uint32 i;
+	rectangle_t old, *r;
 	bool size_changed = false;
 
 	if ( elem == NULL || elem->parent == NULL ) return;
 
+	r = elem->callbacks->get_clip_region ?
+		elem->callbacks->get_clip_region( elem, &r ), r :
+		&elem->bounds;
+
+	old = *r;
 	r = &elem->parent->bounds;
 
 	if ( elem->flags & FLAG_AUTO_RESIZE )
@@ -898,6 +1080,11 @@ void mgui_element_update_child_pos( MGuiElement* elem )
 		elem->bounds.y = r->y + elem->offset.y;
 	}
 
+	if ( mgui_element_defer_layout( elem, &old, size_changed ? INTFLAG_LAYOUT_POS|INTFLAG_LAYOUT_SIZE : INTFLAG_LAYOUT_POS ) ) return;
+
+	// The position of every child is recalculated here, so any pending changes are now done.
+	elem->flags_int &= ~(INTFLAG_LAYOUT_POS|INTFLAG_LAYOUT_SIZE);
+
 	if ( elem->callbacks->on_bounds_change )
 		elem->callbacks->on_bounds_change( elem, true, size_changed );
 
@@ -907,11 +1094,73 @@ void mgui_element_update_child_pos( MGuiElement* elem )
 		mgui_text_update_position( elem->text );
 	}
 
-	if ( elem->children == NULL ) return;
+	mgui_element_damage_bounds( elem, &old );
+	mgui_hitgrid_update( elem );
+
+	if ( elem->num_children == 0 ) return;
 
-	list_foreach( elem->children, node )
+	for ( i = 0; i < elem->num_children; i++ )
 	{
-		mgui_element_update_child_pos( cast_elem(node) );
+		mgui_element_update_child_pos( elem->children[i] );
+	}
+}
+
+void mgui_element_resolve_layout( MGuiElement* elem )
+{
+	uint32 i;
+	rectangle_t* r;
+	uint32 flags;
+
+	if ( elem == NULL ) return;
+
+	flags = elem->flags_int & (INTFLAG_LAYOUT_POS|INTFLAG_LAYOUT_SIZE|INTFLAG_LAYOUT_TEXT|INTFLAG_LAYOUT_CHILD);
+	if ( flags == 0 ) return;
+
+	elem->flags_int &= ~flags;
+
+	// Measure the text first, the element may want to resize itself to fit it.
+	if ( flags & INTFLAG_LAYOUT_TEXT && elem->text != NULL )
+	{
+		elem->text->flags &= ~TFLAG_DEFERRED;
+		mgui_text_update_dimensions( elem->text );
+
+		if ( elem->callbacks->on_text_change )
+			elem->callbacks->on_text_change( elem );
+	}
+
+	if ( flags & (INTFLAG_LAYOUT_POS|INTFLAG_LAYOUT_SIZE) )
+	{
+		if ( elem->text != NULL )
+		{
+			elem->text->bounds = &elem->bounds;
+			mgui_text_update_position( elem->text );
+		}
+
+		if ( elem->callbacks->on_bounds_change )
+			elem->callbacks->on_bounds_change( elem, BIT_ON( flags, INTFLAG_LAYOUT_POS ), BIT_ON( flags, INTFLAG_LAYOUT_SIZE ) );
+
+		if ( flags & INTFLAG_LAYOUT_SIZE && elem->flags & FLAG_CACHE_TEXTURE )
+			mgui_element_resize_cache( elem );
+
+		r = elem->callbacks->get_clip_region ?
+			elem->callbacks->get_clip_region( elem, &r ), r :
+			&elem->bounds;
+
+		// The old area was already damaged when the element was changed.
+		mgui_element_request_redraw_rect( r );
+		mgui_hitgrid_update( elem );
+	}
+
+	if ( elem->num_children == 0 ) return;
+
+	// Children of a moved element are repositioned as a whole. Only the branches
+	// that contain changed elements are visited after that.
+	for ( i = 0; i < elem->num_children; i++ )
+	{
+		if ( flags & (INTFLAG_LAYOUT_POS|INTFLAG_LAYOUT_SIZE) )
+			mgui_element_update_child_pos( elem->children[i] );
+
+		mgui_element_resolve_layout( elem->children[i] );
 	}
 }
 
@@ -1695,7 +1944,7 @@ uint8 mgui_get_alpha( MGuiElement* element )
  */
 void mgui_set_alpha( MGuiElement* element, uint8 alpha )
 {
-	node_t* node;
+	uint32 i;
 	MGuiElement* child;
 
 	if ( element == NULL )
@@ -1712,12 +1961,12 @@ void mgui_set_alpha( MGuiElement* element, uint8 alpha )
 	if ( element->callbacks->on_colour_change )
 		element->callbacks->on_colour_change( element );
 
-	if ( element->children == NULL )
+	if ( element->num_children == 0 )
 		return;
 
-	list_foreach( element->children, node )
+	for ( i = 0; i < element->num_children; i++ )
 	{
-		child = cast_elem(node);
+		child = element->children[i];
 
 		// If this child element is supposed to inherit its parent's alpha, apply it.
 		if ( BIT_ON( child->flags, FLAG_INHERIT_ALPHA ) )
@@ -1797,6 +2046,7 @@ uint32 mgui_get_text_len( MGuiElement* element )
 void mgui_set_text( MGuiElement* element, const char_t* fmt, ... )
 {
 	va_list	marker;
+	bool deferred;
 
 	if ( element == NULL || fmt == NULL )
 		return;
@@ -1804,11 +2054,13 @@ void mgui_set_text( MGuiElement* element, const char_t* fmt, ... )
 	if ( element->text == NULL )
 		return;
 
+	deferred = mgui_element_defer_text( element );
+
 	va_start( marker, fmt );
 	mgui_text_set_buffer_va( element->text, fmt, marker );
 	va_end( marker );
 
-	if ( element->callbacks->on_text_change )
+	if ( !deferred && element->callbacks->on_text_change )
 		element->callbacks->on_text_change( element );
 }
 
@@ -1822,15 +2074,18 @@ void mgui_set_text( MGuiElement* element, const char_t* fmt, ... )
  */
 void mgui_set_text_s( MGuiElement* element, const char_t* text )
 {
+	bool deferred;
+
 	if ( element == NULL || text == NULL )
 		return;
 
 	if ( element->text == NULL )
 		return;
 
+	deferred = mgui_element_defer_text( element );
 	mgui_text_set_buffer_s( element->text, text );
 
-	if ( element->callbacks->on_text_change )
+	if ( !deferred && element->callbacks->on_text_change )
 		element->callbacks->on_text_change( element );
 }
 
@@ -2256,6 +2511,13 @@ void mgui_add_flags( MGuiElement* element, uint32 flags )
 
 	if ( element->callbacks->on_flags_change )
 		element->callbacks->on_flags_change( element, old );
+
+	// Showing, hiding or clipping an element changes what its layer draws.
+	if ( ( element->flags ^ old ) & (FLAG_VISIBLE|FLAG_CLIP) )
+		mgui_drawlist_invalidate( element );
+
+	if ( element->flags != old )
+		mgui_element_request_redraw( element );
 }
 
 /**
@@ -2309,6 +2571,13 @@ void mgui_remove_flags( MGuiElement* element, uint32 flags )
 
 	if ( element->callbacks->on_flags_change )
 		element->callbacks->on_flags_change( element, old );
+
+	// Showing, hiding or clipping an element changes what its layer draws.
+	if ( ( element->flags ^ old ) & (FLAG_VISIBLE|FLAG_CLIP) )
+		mgui_drawlist_invalidate( element );
+
+	if ( element->flags != old )
+		mgui_element_request_redraw( element );
 }
 
 /**
@@ -28,6 +28,11 @@ enum MGUI_INTERNAL_FLAGS {
 	INTFLAG_NOTEXT		= 1 << 4,	/* Element has no text */
 	INTFLAG_LAYER		= 1 << 5,	/* This element is a main GUI layer */
 	INTFLAG_NOPARENT	= 1 << 6,	/* This element has no parent */
+	INTFLAG_LAYOUT_POS	= 1 << 7,	/* Position has changed within a layout transaction */
+	INTFLAG_LAYOUT_SIZE	= 1 << 8,	/* Size has changed within a layout transaction */
+	INTFLAG_LAYOUT_TEXT	= 1 << 9,	/* Text has changed within a layout transaction */
+	INTFLAG_LAYOUT_CHILD = 1 << 10,	/* A child element has pending layout changes */
+	INTFLAG_TIMER		= 1 << 11,	/* The element has a scheduled timer */
 };
 
 /* The following values are used only internally. */
@@ -63,24 +68,34 @@ typedef enum MGUI_TYPE {
  * All the other element types are inherited from this generic container.
  */
 struct MGuiElement {
-	node_t;									///< Linked list node, points to next and previous elements
+	node_t;									///< Linked list node, used for the list of layers
 	uint32					flags;			///< Element property flags (see @ref MGUI_FLAGS)
 	uint32					flags_int;		///< Internal flags, used by element processing and rendering
 	rectangle_t				bounds;			///< Absolute bounding rectangle of this element (in pixels)
 	vectorscreen_t			offset;			///< Offset from parent's position
 	float					z_depth;		///< Draw depth index (valid if @ref FLAG_DEPTH_TEST is ebabled and supported)
 	MGuiElement*			parent;			///< Pointer to parent element, NULL if this element is a layer
-	list_t*					children;		///< List of children elements
+	MGuiElement**			children;		///< Array of child elements in draw order
+	uint32					num_children;	///< Number of child elements
+	uint32					children_size;	///< Number of child elements the array has room for
 	MGUI_TYPE				type;			///< Element type identifier
 	vector2_t				pos;			///< Relative position (within parent element)
 	vector2_t				size;			///< Relative size (within parent element)
 	colour_t				colour;			///< The main colour of the element (usually the background)
 	MGuiText*				text;			///< A pointer to a text buffer container, can be NULL if the element type does not support text
+	MGuiText				text_data;		///< Storage for the text buffer container, text points here when the element has text
 	MGuiFont*				font;			///< Default font used to render all the text in this element
 	MGuiSkin*				skin;			///< Skin to be used for rendering
 	MGuiRendTarget*			cache;			///< Pointer to a texture cache (valid only if @ref FLAG_CACHE_TEXTURE is enabled and supported)
 	mgui_event_handler_t	event_handler;	///< User event handler function
 	void*					event_data;		///< User-specified data to be passed via event_handler
+	struct MGuiHitGrid*		hitgrid;		///< Spatial index used for hit testing (valid only for layers)
+	struct MGuiDrawList*	drawlist;		///< Flattened draw order of the visible elements (valid only for layers)
+	uint32					hit_order;		///< Hit test order of this element within its layer
+	rectangle_t				hit_cells;		///< Hit grid cells of the layer this element has been stored to
+	uint32					timer;			///< Tick count when the process callback should be called next (valid if a timer is scheduled)
+	MGuiElement*			timer_next;		///< Next element in the same timer wheel slot
+	MGuiElement*			timer_prev;		///< Previous element in the same timer wheel slot
 
 	/**
 	 * @brief Transform information for 3D elements.
@@ -122,17 +137,18 @@ struct MGuiElement {
 };
 
 // Generic element functions
+void*			mgui_element_alloc				( MGUI_TYPE type, size_t size );
 void			mgui_element_create				( MGuiElement* element, MGuiElement* parent );
 void			mgui_element_destroy			( MGuiElement* element );
-void			mgui_element_render				( MGuiElement* element );
 void			mgui_element_render_cache		( MGuiElement* element, bool draw_self );
-void			mgui_element_process			( MGuiElement* element );
 void			mgui_element_initialize			( MGuiElement* element );
 void			mgui_element_invalidate			( MGuiElement* element );
 
 void			mgui_element_resize_cache		( MGuiElement* element );
 void			mgui_element_request_redraw		( MGuiElement* element );
 void			mgui_element_request_redraw_all	( void );
+void			mgui_element_request_redraw_rect( const rectangle_t* rect );
+void			mgui_element_refresh_font_all	( MGuiFont* font );
 
 MGuiElement*	mgui_get_element_at				( int16 x, int16 y );
 
@@ -149,6 +165,7 @@ void			mgui_element_update_abs_size	( MGuiElement* element );
 void			mgui_element_update_rel_pos		( MGuiElement* element );
 void			mgui_element_update_rel_size	( MGuiElement* element );
 void			mgui_element_update_child_pos	( MGuiElement* element );
+void			mgui_element_resolve_layout		( MGuiElement* element );
 
 void			mgui_get_pos					( MGuiElement* element, vector2_t* pos );
 void			mgui_get_size					( MGuiElement* element, vector2_t* size );
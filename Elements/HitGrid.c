@@ -0,0 +1,367 @@
+/**
+ *
+ * @file		HitGrid.c
+ * @copyright	Tuomo Jauhiainen 2012-2014
+ * @licence		See Licence.txt
+ * @brief		Spatial index for element hit testing.
+ *
+ * @details		A per-layer uniform grid used to find the element under the cursor without walking the whole element tree.
+ *
+ **/
+
+#include "HitGrid.h"
+#include "Window.h"
+#include "WindowButton.h"
+#include "WindowTitlebar.h"
+#include "Platform/Alloc.h"
+#include <string.h>
+
+// --------------------------------------------------
+
+extern vectorscreen_t draw_size;
+extern list_t* layers;
+
+// --------------------------------------------------
+
+static void							mgui_hitgrid_rebuild			( MGuiElement* layer );
+static void							mgui_hitgrid_add_recursive		( struct MGuiHitGrid* grid, MGuiElement* element, uint32* order );
+static void							mgui_hitgrid_add_element		( struct MGuiHitGrid* grid, MGuiElement* element );
+static void							mgui_hitgrid_remove_element		( struct MGuiHitGrid* grid, MGuiElement* element );
+static MYLLY_INLINE MGuiElement*	mgui_hitgrid_get_layer			( MGuiElement* element );
+static MYLLY_INLINE MGuiElement*	mgui_hitgrid_get_parent			( MGuiElement* element );
+static MYLLY_INLINE rectangle_t*	mgui_hitgrid_get_bounds			( MGuiElement* element );
+static MYLLY_INLINE bool			mgui_hitgrid_test_element		( MGuiElement* element, int16 x, int16 y );
+
+// --------------------------------------------------
+
+void mgui_hitgrid_destroy( MGuiElement* layer )
+{
+	struct MGuiHitGrid* grid;
+	uint32 i;
+
+	if ( layer == NULL || layer->hitgrid == NULL ) return;
+
+	grid = layer->hitgrid;
+
+	for ( i = 0; i < (uint32)grid->width * grid->height; i++ )
+	{
+		if ( grid->cells[i].elements != NULL )
+			mem_free( grid->cells[i].elements );
+	}
+
+	if ( grid->cells != NULL )
+		mem_free( grid->cells );
+
+	mem_free( grid );
+	layer->hitgrid = NULL;
+}
+
+void mgui_hitgrid_invalidate( MGuiElement* element )
+{
+	MGuiElement* layer;
+
+	layer = mgui_hitgrid_get_layer( element );
+
+	if ( layer && layer->hitgrid )
+		layer->hitgrid->dirty = true;
+}
+
+void mgui_hitgrid_invalidate_all( void )
+{
+	node_t* node;
+	MGuiElement* layer;
+
+	if ( layers == NULL ) return;
+
+	list_foreach( layers, node )
+	{
+		layer = cast_elem(node);
+
+		if ( layer->hitgrid )
+			layer->hitgrid->dirty = true;
+	}
+}
+
+void mgui_hitgrid_update( MGuiElement* element )
+{
+	MGuiElement* layer;
+	struct MGuiWindow* window;
+
+	if ( element == NULL ) return;
+
+	layer = mgui_hitgrid_get_layer( element );
+
+	// If the grid is going to be rebuilt anyway, there's no need to do anything.
+	if ( layer == NULL || layer->hitgrid == NULL || layer->hitgrid->dirty )
+		return;
+
+	mgui_hitgrid_remove_element( layer->hitgrid, element );
+	mgui_hitgrid_add_element( layer->hitgrid, element );
+
+	// Windows move their titlebar and close button along with them.
+	if ( element->type == GUI_WINDOW )
+	{
+		window = (struct MGuiWindow*)element;
+
+		if ( window->titlebar )
+		{
+			mgui_hitgrid_remove_element( layer->hitgrid, cast_elem(window->titlebar) );
+			mgui_hitgrid_add_element( layer->hitgrid, cast_elem(window->titlebar) );
+		}
+
+		if ( window->closebtn )
+		{
+			mgui_hitgrid_remove_element( layer->hitgrid, cast_elem(window->closebtn) );
+			mgui_hitgrid_add_element( layer->hitgrid, cast_elem(window->closebtn) );
+		}
+	}
+}
+
+MGuiElement* mgui_hitgrid_get_element_at( MGuiElement* layer, int16 x, int16 y )
+{
+	struct MGuiHitGrid* grid;
+	MGuiHitCell* cell;
+	MGuiElement *element, *ret = NULL;
+	uint32 i, cx, cy;
+
+	if ( layer->hitgrid == NULL || layer->hitgrid->dirty )
+		mgui_hitgrid_rebuild( layer );
+
+	grid = layer->hitgrid;
+
+	cx = (uint32)x / HITGRID_CELL_SIZE;
+	cy = (uint32)y / HITGRID_CELL_SIZE;
+
+	if ( cx >= grid->width || cy >= grid->height )
+		return NULL;
+
+	cell = &grid->cells[cy * grid->width + cx];
+
+	// The element tree is walked from the last child to the first one, and children are
+	// tested before their parent. That is exactly the reverse of the order the elements
+	// were numbered in, so the valid element with the highest order is the topmost one.
+	for ( i = 0; i < cell->num_elements; i++ )
+	{
+		element = cell->elements[i];
+
+		if ( ret != NULL && element->hit_order <= ret->hit_order )
+			continue;
+
+		if ( BIT_OFF( element->flags, FLAG_MOUSECTRL ) )
+			continue;
+
+		if ( mgui_hitgrid_test_element( element, x, y ) )
+			ret = element;
+	}
+
+	return ret;
+}
+
+static void mgui_hitgrid_rebuild( MGuiElement* layer )
+{
+	struct MGuiHitGrid* grid;
+	uint16 width, height;
+	uint32 i, order = 0;
+
+	width = ( draw_size.ux + HITGRID_CELL_SIZE - 1 ) / HITGRID_CELL_SIZE;
+	height = ( draw_size.uy + HITGRID_CELL_SIZE - 1 ) / HITGRID_CELL_SIZE;
+
+	width = width > 0 ? width : 1;
+	height = height > 0 ? height : 1;
+
+	// The window has been resized, get rid of the old grid.
+	if ( layer->hitgrid != NULL &&
+		 ( layer->hitgrid->width != width || layer->hitgrid->height != height ) )
+	{
+		mgui_hitgrid_destroy( layer );
+	}
+
+	if ( layer->hitgrid == NULL )
+	{
+		grid = mem_alloc_clean( sizeof(*grid) );
+		grid->cells = mem_alloc_clean( width * height * sizeof(MGuiHitCell) );
+		grid->width = width;
+		grid->height = height;
+
+		layer->hitgrid = grid;
+	}
+	else
+	{
+		grid = layer->hitgrid;
+
+		// Keep the cell storage around, just empty it.
+		for ( i = 0; i < (uint32)width * height; i++ )
+			grid->cells[i].num_elements = 0;
+	}
+
+	mgui_hitgrid_add_recursive( grid, layer, &order );
+	grid->dirty = false;
+}
+
+static void mgui_hitgrid_add_recursive( struct MGuiHitGrid* grid, MGuiElement* element, uint32* order )
+{
+	uint32 i;
+	struct MGuiWindow* window;
+
+	element->hit_order = (*order)++;
+	mgui_hitgrid_add_element( grid, element );
+
+	if ( element->num_children > 0 )
+	{
+		for ( i = 0; i < element->num_children; i++ )
+		{
+			mgui_hitgrid_add_recursive( grid, element->children[i], order );
+		}
+	}
+
+	// The close button and the titlebar of a window are tested before the
+	// children of the window, so they have to come last.
+	if ( element->type == GUI_WINDOW )
+	{
+		window = (struct MGuiWindow*)element;
+
+		if ( window->titlebar )
+			mgui_hitgrid_add_recursive( grid, cast_elem(window->titlebar), order );
+
+		if ( window->closebtn )
+			mgui_hitgrid_add_recursive( grid, cast_elem(window->closebtn), order );
+	}
+}
+
+static void mgui_hitgrid_add_element( struct MGuiHitGrid* grid, MGuiElement* element )
+{
+	MGuiHitCell* cell;
+	MGuiElement** tmp;
+	rectangle_t* r;
+	int32 x1, y1, x2, y2, x, y;
+
+	r = mgui_hitgrid_get_bounds( element );
+
+	element->hit_cells.w = 0;
+	element->hit_cells.h = 0;
+
+	if ( r->w == 0 || r->h == 0 ) return;
+
+	// Find out which cells the element overlaps.
+	x1 = math_max( r->x, 0 ) / HITGRID_CELL_SIZE;
+	y1 = math_max( r->y, 0 ) / HITGRID_CELL_SIZE;
+	x2 = math_min( ( r->x + r->w - 1 ) / HITGRID_CELL_SIZE, grid->width - 1 );
+	y2 = math_min( ( r->y + r->h - 1 ) / HITGRID_CELL_SIZE, grid->height - 1 );
+
+	if ( r->x + r->w <= 0 || r->y + r->h <= 0 ) return;
+	if ( x1 > x2 || y1 > y2 ) return;
+
+	element->hit_cells.x = (int16)x1;
+	element->hit_cells.y = (int16)y1;
+	element->hit_cells.w = (uint16)( x2 - x1 + 1 );
+	element->hit_cells.h = (uint16)( y2 - y1 + 1 );
+
+	for ( y = y1; y <= y2; y++ )
+	{
+		for ( x = x1; x <= x2; x++ )
+		{
+			cell = &grid->cells[y * grid->width + x];
+
+			if ( cell->num_elements >= cell->size )
+			{
+				cell->size = cell->size ? cell->size * 2 : 8;
+				tmp = mem_alloc( cell->size * sizeof(MGuiElement*) );
+
+				if ( cell->elements != NULL )
+				{
+					memcpy( tmp, cell->elements, cell->num_elements * sizeof(MGuiElement*) );
+					mem_free( cell->elements );
+				}
+
+				cell->elements = tmp;
+			}
+
+			cell->elements[cell->num_elements++] = element;
+		}
+	}
+}
+
+static void mgui_hitgrid_remove_element( struct MGuiHitGrid* grid, MGuiElement* element )
+{
+	MGuiHitCell* cell;
+	int32 x, y;
+	uint32 i;
+
+	for ( y = element->hit_cells.y; y < element->hit_cells.y + element->hit_cells.h; y++ )
+	{
+		for ( x = element->hit_cells.x; x < element->hit_cells.x + element->hit_cells.w; x++ )
+		{
+			cell = &grid->cells[y * grid->width + x];
+
+			for ( i = 0; i < cell->num_elements; i++ )
+			{
+				if ( cell->elements[i] == element )
+				{
+					// The order of the elements within a cell doesn't matter.
+					cell->elements[i] = cell->elements[--cell->num_elements];
+					break;
+				}
+			}
+		}
+	}
+
+	element->hit_cells.w = 0;
+	element->hit_cells.h = 0;
+}
+
+static MYLLY_INLINE MGuiElement* mgui_hitgrid_get_layer( MGuiElement* element )
+{
+	MGuiElement* parent;
+
+	if ( element == NULL ) return NULL;
+
+	while ( ( parent = mgui_hitgrid_get_parent( element ) ) != NULL )
+		element = parent;
+
+	return BIT_ON( element->flags_int, INTFLAG_LAYER ) ? element : NULL;
+}
+
+static MYLLY_INLINE MGuiElement* mgui_hitgrid_get_parent( MGuiElement* element )
+{
+	// Titlebars and window buttons are not real children of the window.
+	switch ( element->type )
+	{
+	case GUI_TITLEBAR:
+		return cast_elem( ((struct MGuiTitlebar*)element)->window );
+
+	case GUI_WINDOWBUTTON:
+		return cast_elem( ((struct MGuiWindowButton*)element)->window );
+
+	default:
+		return element->parent;
+	}
+}
+
+static MYLLY_INLINE rectangle_t* mgui_hitgrid_get_bounds( MGuiElement* element )
+{
+	if ( element->type == GUI_WINDOW )
+		return &((struct MGuiWindow*)element)->window_bounds;
+
+	return &element->bounds;
+}
+
+static MYLLY_INLINE bool mgui_hitgrid_test_element( MGuiElement* element, int16 x, int16 y )
+{
+	// The element and all its predecessors have to be visible, enabled and under the cursor
+	// for the element to be hit. Visibility is not stored in the grid, so check it here.
+	while ( element != NULL )
+	{
+		if ( BIT_OFF( element->flags, FLAG_VISIBLE ) ||
+			 BIT_ON( element->flags, FLAG_DISABLED ) )
+		{
+			return false;
+		}
+
+		if ( !rect_is_point_in( mgui_hitgrid_get_bounds( element ), x, y ) )
+			return false;
+
+		element = mgui_hitgrid_get_parent( element );
+	}
+
+	return true;
+}
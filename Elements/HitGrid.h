@@ -0,0 +1,52 @@
+/**
+ *
+ * @file		HitGrid.h
+ * @copyright	Tuomo Jauhiainen 2012-2014
+ * @licence		See Licence.txt
+ * @brief		Spatial index for element hit testing.
+ *
+ * @details		A per-layer uniform grid used to find the element under the cursor without walking the whole element tree.
+ *
+ **/
+
+#pragma once
+#ifndef __MGUI_HITGRID_H
+#define __MGUI_HITGRID_H
+
+#include "Element.h"
+
+#define HITGRID_CELL_SIZE 64	///< Width and height of a single grid cell in pixels
+
+/**
+ * @brief A single cell of a hit grid.
+ *
+ * @details A cell contains all the elements within a layer whose
+ * bounding rectangle overlaps the cell.
+ */
+typedef struct {
+	MGuiElement**	elements;		///< Elements overlapping this cell
+	uint32			num_elements;	///< Number of elements stored into the cell
+	uint32			size;			///< Number of elements the cell has room for
+} MGuiHitCell;
+
+/**
+ * @brief Hit grid of a layer.
+ *
+ * @details The grid covers the whole window. Each element of the layer is
+ * stored into every cell its bounding rectangle overlaps, along with a hit
+ * test order index so that the topmost element can be resolved quickly.
+ */
+struct MGuiHitGrid {
+	MGuiHitCell*	cells;			///< Grid cells, stored row by row
+	uint16			width;			///< Width of the grid in cells
+	uint16			height;			///< Height of the grid in cells
+	bool			dirty;			///< The layer has changed structurally, the grid has to be rebuilt
+};
+
+void			mgui_hitgrid_destroy			( MGuiElement* layer );
+void			mgui_hitgrid_invalidate			( MGuiElement* element );
+void			mgui_hitgrid_invalidate_all		( void );
+void			mgui_hitgrid_update				( MGuiElement* element );
+MGuiElement*	mgui_hitgrid_get_element_at		( MGuiElement* layer, int16 x, int16 y );
+
+#endif /* __MGUI_HITGRID_H */
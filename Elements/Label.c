@@ -59,7 +59,7 @@ MGuiLabel* mgui_create_label( MGuiElement* parent )
 	struct MGuiLabel* label;
 	extern MGuiFont* default_font;
 
-	label = mem_alloc_clean( sizeof(*label) );
+	label = mgui_element_alloc( GUI_LABEL, sizeof(*label) );
 	mgui_element_create( cast_elem(label), parent );
 
 	label->type = GUI_LABEL;
@@ -11,6 +11,7 @@
 
 #include "Listbox.h"
 #include "Skin.h"
+#include "Pool.h"
 #include "Platform/Alloc.h"
 #include "Stringy/Stringy.h"
 
@@ -32,10 +33,18 @@ static void				mgui_listbox_update_scrollbar	( struct MGuiListbox* listbox );
 static void				mgui_listbox_needs_scrollbar	( struct MGuiListbox* listbox );
 static MGuiListboxItem*	mgui_listbox_get_first_visible	( struct MGuiListbox* listbox );
 static MGuiListboxItem*	mgui_listbox_get_item_at		( struct MGuiListbox* listbox, int16 x, int16 y );
+static uint32			mgui_listbox_get_item_row		( struct MGuiListbox* listbox, MGuiListboxItem* item );
 static void				mgui_listbox_remove_selected	( struct MGuiListbox* listbox );
+static void				mgui_listbox_update_height		( struct MGuiListbox* listbox );
+static void				mgui_listbox_update_rows		( struct MGuiListbox* listbox );
+static void				mgui_listbox_clear_rows			( struct MGuiListbox* listbox );
+static uint32			mgui_listbox_get_row_at			( struct MGuiListbox* listbox, int16 x, int16 y );
+static MYLLY_INLINE uint16 mgui_listbox_get_item_height	( struct MGuiListbox* listbox );
 
 // --------------------------------------------------
 
+static MGuiPool item_pool = { 0 };	// Memory pool for listbox items
+
 static struct MGuiCallbacks callbacks =
 {
 	mgui_listbox_destroy,
@@ -75,7 +84,7 @@ MGuiListbox* mgui_create_listbox( MGuiElement* parent )
 	MGuiScrollbar* scrollbar;
 	extern MGuiFont* default_font;
 
-	listbox = mem_alloc_clean( sizeof(*listbox) );
+	listbox = mgui_element_alloc( GUI_LISTBOX, sizeof(*listbox) );
 	mgui_element_create( cast_elem(listbox), parent );
 
 	listbox->type = GUI_LISTBOX;
@@ -90,6 +99,7 @@ MGuiListbox* mgui_create_listbox( MGuiElement* parent )
 
 	// Create the list for items.
 	listbox->items = list_create();
+	listbox->selected_row = (uint32)-1;
 
 	// Create a scrollbar and make it invisible for now
 	scrollbar = mgui_create_scrollbar( cast_elem(listbox) );
@@ -147,10 +157,19 @@ static void mgui_listbox_destroy( MGuiElement* listbox )
 
 	mgui_listbox_clean( listbox );
 	list_destroy( list->items );
+
+	mgui_listbox_clear_rows( list );
+	SAFE_DELETE( list->rows );
 }
 
 static void mgui_listbox_render( MGuiElement* listbox )
 {
+	struct MGuiListbox* list = (struct MGuiListbox*)listbox;
+
+	// Fetch the visible rows of a virtual listbox right before they're drawn.
+	if ( list->provider != NULL && list->rows_dirty )
+		mgui_listbox_update_rows( list );
+
 	listbox->skin->draw_listbox( listbox );
 }
 
@@ -171,6 +190,12 @@ static void mgui_listbox_on_bounds_change( MGuiElement* listbox, bool pos, bool
 		mgui_set_abs_size_i( scrollbar, 16, list->bounds.h );
 	}
 
+	if ( list->provider != NULL )
+	{
+		list->rows_dirty = true;
+		return;
+	}
+
 	mgui_listbox_update_positions( list, (MGuiListboxItem*)list_begin( list->items ) );
 }
 
@@ -195,6 +220,10 @@ static void mgui_listbox_on_text_change( MGuiElement* listbox )
 
 	// Update scrollbar step.
 	mgui_scrollbar_set_step_size( cast_elem(list->scrollbar), (float)list->font->size + list->text->pad.top + list->text->pad.bottom );
+
+	// The row height of a virtual listbox may have changed.
+	if ( list->provider != NULL )
+		mgui_listbox_update_height( list );
 }
 
 static void mgui_listbox_on_mouse_click( MGuiElement* listbox, int16 x, int16 y, MOUSEBTN mousebtn )
@@ -207,6 +236,27 @@ static void mgui_listbox_on_mouse_click( MGuiElement* listbox, int16 x, int16 y,
 
 	mgui_element_request_redraw( listbox );
 
+	if ( list->provider != NULL )
+	{
+		// Virtual listboxes only support selecting a single row.
+		list->selected_row = mgui_listbox_get_row_at( list, x, y );
+		list->selected = list->selected_row != (uint32)-1 ? 1 : 0;
+		list->rows_dirty = true;
+
+		if ( list->selected_row != (uint32)-1 && listbox->event_handler )
+		{
+			event.type = EVENT_LISTBOX_SELECT;
+			event.list.element = cast_elem(listbox);
+			event.list.data = listbox->event_data;
+			event.list.item = NULL;
+			event.list.row = list->selected_row;
+
+			listbox->event_handler( &event );
+		}
+
+		return;
+	}
+
 	item = mgui_listbox_get_item_at( list, x, y );
 	if ( item == NULL )
 	{
@@ -229,6 +279,7 @@ static void mgui_listbox_on_mouse_click( MGuiElement* listbox, int16 x, int16 y,
 		event.list.element = cast_elem(listbox);
 		event.list.data = listbox->event_data;
 		event.list.item = item;
+		event.list.row = mgui_listbox_get_item_row( list, item );
 
 		listbox->event_handler( &event );
 	}
@@ -257,12 +308,23 @@ static void mgui_listbox_on_scroll( const MGuiEvent* event )
 		listbox->scroll_offset = listbox->height - listbox->bounds.h + listbox->font->size + listbox->text->pad.top + listbox->text->pad.bottom;
 
 	// Otherwise calculate the item offset.
-	else listbox->scroll_offset = (int16)( ( listbox->height - listbox->bounds.h ) * percentage );
+	else listbox->scroll_offset = (int32)( ( listbox->height - listbox->bounds.h ) * percentage );
 
-	// Update item positions and find out the first visible item.
-	mgui_listbox_update_positions( listbox, (MGuiListboxItem*)list_begin( listbox->items ) );
+	if ( listbox->provider != NULL )
+	{
+		// The first visible row of a virtual listbox can be calculated directly from the offset.
+		listbox->first_row = listbox->scroll_offset / mgui_listbox_get_item_height( listbox );
+		listbox->rows_dirty = true;
+	}
+	else
+	{
+		// Update item positions and find out the first visible item.
+		mgui_listbox_update_positions( listbox, (MGuiListboxItem*)list_begin( listbox->items ) );
+
+		listbox->first_visible = mgui_listbox_get_first_visible( listbox );
+	}
 
-	listbox->first_visible = mgui_listbox_get_first_visible( listbox );
+	mgui_element_request_redraw( cast_elem(listbox) );
 
 	// Call the listbox's own scroll event handler here.
 	if ( listbox->event_handler )
@@ -295,7 +357,7 @@ static void mgui_listbox_update_positions( struct MGuiListbox* listbox, MGuiList
 {
 	node_t *node, *prev;
 	MGuiListboxItem* item;
-	int16 y = 0, item_height, scroll_width = 0;
+	int32 y = 0, item_height, scroll_width = 0;
 
 	node = &begin->node;
 	prev = node->prev;
@@ -323,13 +385,13 @@ static void mgui_listbox_update_positions( struct MGuiListbox* listbox, MGuiList
 
 		// Update position within the listbox.
 		item->pos.x = 0;
-		item->pos.y = y;
+		item->pos.y = (int16)y;
 
 		// Update absolute boundaries.
 		item->bounds.x = listbox->bounds.x;
-		item->bounds.y = listbox->bounds.y + y;
-		item->bounds.w = listbox->bounds.w - scroll_width;
-		item->bounds.h = item_height;
+		item->bounds.y = (int16)( listbox->bounds.y + y );
+		item->bounds.w = (uint16)( listbox->bounds.w - scroll_width );
+		item->bounds.h = (uint16)item_height;
 
 		// Update absolute text position.
 		item->text_bounds.x = item->bounds.x + listbox->text->pad.left;
@@ -411,6 +473,20 @@ static MGuiListboxItem* mgui_listbox_get_item_at( struct MGuiListbox* listbox, i
 	return NULL;
 }
 
+static uint32 mgui_listbox_get_item_row( struct MGuiListbox* listbox, MGuiListboxItem* item )
+{
+	node_t* node;
+	uint32 row = 0;
+
+	list_foreach( listbox->items, node )
+	{
+		if ( node == &item->node ) return row;
+		row++;
+	}
+
+	return (uint32)-1;
+}
+
 static void mgui_listbox_remove_selected( struct MGuiListbox* listbox )
 {
 	node_t* node;
@@ -425,11 +501,133 @@ static void mgui_listbox_remove_selected( struct MGuiListbox* listbox )
 	listbox->selected = 0;
 }
 
+static void mgui_listbox_update_height( struct MGuiListbox* listbox )
+{
+	uint32 item_height, max_offset;
+
+	item_height = mgui_listbox_get_item_height( listbox );
+	listbox->height = listbox->num_rows * item_height;
+
+	// Make sure we're not scrolled past the last row.
+	max_offset = listbox->height > listbox->bounds.h ? listbox->height - listbox->bounds.h + item_height : 0;
+
+	if ( (uint32)listbox->scroll_offset > max_offset )
+		listbox->scroll_offset = (int32)max_offset;
+
+	listbox->first_row = listbox->scroll_offset / item_height;
+	listbox->rows_dirty = true;
+
+	if ( listbox->height > 0 )
+		mgui_listbox_update_scrollbar( listbox );
+	else
+		mgui_listbox_needs_scrollbar( listbox );
+
+	mgui_element_request_redraw( cast_elem(listbox) );
+}
+
+static void mgui_listbox_update_rows( struct MGuiListbox* listbox )
+{
+	MGuiListboxItem* item;
+	const char_t* text;
+	uint32 i, row, count;
+	int32 item_height, scroll_width = 0;
+
+	listbox->rows_dirty = false;
+
+	mgui_listbox_clear_rows( listbox );
+
+	if ( listbox->first_row >= listbox->num_rows ) return;
+
+	count = math_min( listbox->max_visible, listbox->num_rows - listbox->first_row );
+
+	if ( count > listbox->rows_size )
+	{
+		SAFE_DELETE( listbox->rows );
+
+		listbox->rows = mem_alloc_clean( count * sizeof(MGuiListboxItem) );
+		listbox->rows_size = count;
+	}
+
+	if ( listbox->scrollbar->flags & FLAG_VISIBLE )
+		scroll_width = listbox->scrollbar->bounds.w;
+
+	item_height = mgui_listbox_get_item_height( listbox );
+
+	for ( i = 0; i < count; i++ )
+	{
+		row = listbox->first_row + i;
+		item = &listbox->rows[i];
+
+		item->parent = cast_elem(listbox);
+		item->selected = ( row == listbox->selected_row );
+
+		text = listbox->provider( cast_elem(listbox), row, listbox->provider_data );
+		mgui_listbox_set_item_text( item, text ? text : _MTEXT("") );
+
+		// The first visible row is always at the top, so the position of a row is known without looking at the other rows.
+		item->pos.x = 0;
+		item->pos.y = (int16)( i * item_height );
+
+		item->bounds.x = listbox->bounds.x;
+		item->bounds.y = listbox->bounds.y + item->pos.y;
+		item->bounds.w = (uint16)( listbox->bounds.w - scroll_width );
+		item->bounds.h = (uint16)item_height;
+
+		item->text_bounds.x = item->bounds.x + listbox->text->pad.left;
+		item->text_bounds.y = item->bounds.y + listbox->text->pad.top;
+	}
+
+	listbox->num_visible = count;
+}
+
+static void mgui_listbox_clear_rows( struct MGuiListbox* listbox )
+{
+	MGuiListboxItem* item;
+	uint32 i;
+
+	for ( i = 0; i < listbox->num_visible; i++ )
+	{
+		item = &listbox->rows[i];
+
+		SAFE_DELETE( item->text );
+		SAFE_DELETE( item->tags );
+	}
+
+	listbox->num_visible = 0;
+}
+
+static uint32 mgui_listbox_get_row_at( struct MGuiListbox* listbox, int16 x, int16 y )
+{
+	uint32 row;
+	int32 scroll_width = 0;
+
+	if ( listbox->scrollbar->flags & FLAG_VISIBLE )
+		scroll_width = listbox->scrollbar->bounds.w;
+
+	if ( x < listbox->bounds.x || x >= listbox->bounds.x + listbox->bounds.w - scroll_width ||
+		 y < listbox->bounds.y || y >= listbox->bounds.y + listbox->bounds.h )
+		 return (uint32)-1;
+
+	row = ( y - listbox->bounds.y ) / mgui_listbox_get_item_height( listbox );
+
+	if ( row >= listbox->max_visible ) return (uint32)-1;
+
+	row += listbox->first_row;
+
+	return row < listbox->num_rows ? row : (uint32)-1;
+}
+
+static MYLLY_INLINE uint16 mgui_listbox_get_item_height( struct MGuiListbox* listbox )
+{
+	return listbox->font->size + listbox->text->pad.top + listbox->text->pad.bottom;
+}
+
 /**
  * @brief Adds a new item to a listbox.
  *
  * @details This function adds a new item to the listbox and returns a pointer
- * to the created item.
+ * to the created item. Virtual listboxes don't store items, so NULL is returned
+ * for them.
  *
  * @param listbox The listbox to add an item to
  * @param text Text that will go on the item
@@ -444,7 +642,13 @@ MGuiListboxItem* mgui_listbox_add_item( MGuiListbox* listbox, const char_t* text
 		 text == NULL )
 		 return NULL;
 
-	item = mem_alloc_clean( sizeof(*item) );
+	// The rows of a virtual listbox come from the data provider.
+	if ( list->provider != NULL ) return NULL;
+
+	if ( item_pool.size == 0 )
+		mgui_pool_initialize( &item_pool, sizeof(*item) );
+
+	item = mgui_pool_alloc( &item_pool );
 	item->parent = listbox;
 	
 	mgui_listbox_set_item_text( item, text );
@@ -464,6 +668,7 @@ MGuiListboxItem* mgui_listbox_add_item( MGuiListbox* listbox, const char_t* text
  * @brief Removes an item from a listbox.
  *
  * @details This function removes a previously added item from a listbox.
+ * This function does nothing if the listbox is virtual.
  *
  * @param listbox The listbox to remove an item from
  * @param item The item to be removed
@@ -473,12 +678,12 @@ void mgui_listbox_remove_item( MGuiListbox* listbox, MGuiListboxItem* item )
 	struct MGuiListbox* list = (struct MGuiListbox*)listbox;
 
 	if ( list == NULL || item == NULL ) return;
+	if ( list->provider != NULL ) return;
 
 	list_remove( list->items, (node_t*)item );
 
 	SAFE_DELETE( item->text );
 	SAFE_DELETE( item->tags );
-	mem_free( item );
 
 	list->first_visible = mgui_listbox_get_first_visible( list );
 
@@ -492,6 +697,9 @@ void mgui_listbox_remove_item( MGuiListbox* listbox, MGuiListboxItem* item )
 		mgui_listbox_update_positions( list, (MGuiListboxItem*)list_begin( list->items ) );
 		mgui_element_request_redraw( listbox );
 	}
+
+	// The height of the item is needed above, so release it only now.
+	mgui_pool_free( &item_pool, item );
 }
 
 /**
@@ -518,7 +726,7 @@ void mgui_listbox_clean( MGuiListbox* listbox )
 
 		SAFE_DELETE( item->text );
 		SAFE_DELETE( item->tags );
-		mem_free( item );
+		mgui_pool_free( &item_pool, item );
 	}
 }
 
@@ -557,7 +765,7 @@ uint32 mgui_listbox_get_item_count( MGuiListbox* listbox )
 	if ( listbox == NULL ) return 0;
 
 	list = (struct MGuiListbox*)listbox;
-	return list->items->size;
+	return list->provider ? list->num_rows : list->items->size;
 }
 
 /**
@@ -831,3 +1039,149 @@ void mgui_listbox_set_selected_colour_i( MGuiListbox* listbox, uint32 col )
 
 	mgui_element_request_redraw( listbox );
 }
+
+/**
+ * @brief Makes a listbox virtual.
+ *
+ * @details This function turns a listbox into a virtual listbox. A virtual listbox
+ * does not store any items, instead it only knows the number of rows and requests
+ * the text of the visible rows from a data provider function. This allows the listbox
+ * to display a huge number of rows without using any extra memory. All the existing
+ * items of the listbox are removed. Virtual listboxes only support selecting a single row,
+ * and items can't be added to or removed from them (use @ref mgui_listbox_set_row_count instead).
+ *
+ * @param listbox The listbox to make virtual
+ * @param rows The number of rows in the listbox
+ * @param provider A function that returns the text of a row (see @ref mgui_listbox_provider_t), or NULL to make the listbox regular again
+ * @param data User data to be passed to the data provider
+ * @sa mgui_listbox_provider_t
+ */
+void mgui_listbox_set_virtual( MGuiListbox* listbox, uint32 rows, mgui_listbox_provider_t provider, void* data )
+{
+	struct MGuiListbox* list;
+
+	if ( listbox == NULL ) return;
+
+	list = (struct MGuiListbox*)listbox;
+
+	mgui_listbox_clean( listbox );
+	mgui_listbox_clear_rows( list );
+
+	list->provider = provider;
+	list->provider_data = data;
+	list->num_rows = provider ? rows : 0;
+	list->first_row = 0;
+	list->first_visible = NULL;
+	list->scroll_offset = 0;
+	list->selected = 0;
+	list->selected_row = (uint32)-1;
+
+	mgui_listbox_update_height( list );
+}
+
+/**
+ * @brief Sets the number of rows in a virtual listbox.
+ *
+ * @details This function changes the number of rows in a virtual listbox.
+ * The visible rows are requested from the data provider again.
+ *
+ * @param listbox The virtual listbox to set the row count of
+ * @param rows The new number of rows
+ */
+void mgui_listbox_set_row_count( MGuiListbox* listbox, uint32 rows )
+{
+	struct MGuiListbox* list;
+
+	if ( listbox == NULL ) return;
+
+	list = (struct MGuiListbox*)listbox;
+	if ( list->provider == NULL ) return;
+
+	list->num_rows = rows;
+
+	if ( list->selected_row != (uint32)-1 && list->selected_row >= rows )
+	{
+		list->selected_row = (uint32)-1;
+		list->selected = 0;
+	}
+
+	mgui_listbox_update_height( list );
+}
+
+/**
+ * @brief Refreshes the visible rows of a virtual listbox.
+ *
+ * @details This function should be called when the data behind a virtual
+ * listbox changes. The visible rows are requested from the data provider
+ * again before the listbox is drawn the next time.
+ *
+ * @param listbox The virtual listbox to refresh
+ */
+void mgui_listbox_refresh_rows( MGuiListbox* listbox )
+{
+	struct MGuiListbox* list;
+
+	if ( listbox == NULL ) return;
+
+	list = (struct MGuiListbox*)listbox;
+	if ( list->provider == NULL ) return;
+
+	list->rows_dirty = true;
+	mgui_element_request_redraw( listbox );
+}
+
+/**
+ * @brief Returns the selected row of a listbox.
+ *
+ * @details This function returns the index of the first selected row in a listbox.
+ *
+ * @param listbox The listbox to get the selected row of
+ * @returns Index of the selected row, or (uint32)-1 if nothing is selected
+ */
+uint32 mgui_listbox_get_selected_row( MGuiListbox* listbox )
+{
+	struct MGuiListbox* list;
+	MGuiListboxItem* item;
+	node_t* node;
+	uint32 row = 0;
+
+	if ( listbox == NULL ) return (uint32)-1;
+
+	list = (struct MGuiListbox*)listbox;
+	if ( list->provider != NULL ) return list->selected_row;
+
+	list_foreach( list->items, node )
+	{
+		item = (MGuiListboxItem*)node;
+		if ( item->selected ) return row;
+
+		row++;
+	}
+
+	return (uint32)-1;
+}
+
+/**
+ * @brief Selects a row in a virtual listbox.
+ *
+ * @details This function selects a row in a virtual listbox.
+ * Any previously selected row will be deselected.
+ *
+ * @param listbox The virtual listbox to select a row in
+ * @param row Index of the row to select, or (uint32)-1 to clear the selection
+ */
+void mgui_listbox_set_selected_row( MGuiListbox* listbox, uint32 row )
+{
+	struct MGuiListbox* list;
+
+	if ( listbox == NULL ) return;
+
+	list = (struct MGuiListbox*)listbox;
+	if ( list->provider == NULL ) return;
+
+	list->selected_row = row < list->num_rows ? row : (uint32)-1;
+	list->selected = list->selected_row != (uint32)-1 ? 1 : 0;
+	list->rows_dirty = true;
+
+	mgui_element_request_redraw( listbox );
+}
@@ -18,7 +18,10 @@
 
 /**
  * @brief GUI listbox.
+ *
  * @details Listbox is an element that allows the user to select one or more items from a list.
+ * A virtual listbox doesn't store any items. Instead it only knows the number of rows,
+ * and fetches the text of the visible rows from a data provider callback.
  */
 struct MGuiListbox {
 	MGuiElement;							///< Inherit MGuiElement members
@@ -30,8 +33,17 @@ struct MGuiListbox {
 	colour_t				select_colour;	///< Background colour used for selected items
 	mgui_listbox_sort_t		sort;			///< Item comparison function used for automatic sorting
 	struct MGuiScrollbar*	scrollbar;		///< The scrollbar element that is shown if the list gets too big
-	int16					scroll_offset;	///< Position of the scrollbar if it is visible
-	uint16					height;			///< Total height of all the items in pixels
+	int32					scroll_offset;	///< Position of the scrollbar if it is visible
+	uint32					height;			///< Total height of all the items in pixels
+	mgui_listbox_provider_t	provider;		///< Data provider of a virtual listbox, NULL if the listbox is not virtual
+	void*					provider_data;	///< User data passed to the data provider
+	uint32					num_rows;		///< Number of rows in a virtual listbox
+	uint32					first_row;		///< Index of the first visible row in a virtual listbox
+	uint32					selected_row;	///< Index of the selected row in a virtual listbox, or (uint32)-1 if nothing is selected
+	MGuiListboxItem*		rows;			///< Cached visible rows of a virtual listbox
+	uint32					num_visible;	///< Number of rows in the cache above
+	uint32					rows_size;		///< Number of rows the cache has room for
+	bool					rows_dirty;		///< The cached rows have to be fetched again before rendering
 };
 
 /**
@@ -76,4 +88,10 @@ void			mgui_listbox_set_selected_colour	( MGuiListbox* listbox, const colour_t*
 uint32			mgui_listbox_get_selected_colour_i	( MGuiListbox* listbox );
 void			mgui_listbox_set_selected_colour_i	( MGuiListbox* listbox, uint32 hex );
 
+void			mgui_listbox_set_virtual			( MGuiListbox* listbox, uint32 rows, mgui_listbox_provider_t provider, void* data );
+void			mgui_listbox_set_row_count			( MGuiListbox* listbox, uint32 rows );
+void			mgui_listbox_refresh_rows			( MGuiListbox* listbox );
+uint32			mgui_listbox_get_selected_row		( MGuiListbox* listbox );
+void			mgui_listbox_set_selected_row		( MGuiListbox* listbox, uint32 row );
+
 #endif /* __MGUI_LISTBOX_H */
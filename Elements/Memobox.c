@@ -13,6 +13,7 @@
 #include "Skin.h"
 #include "Platform/Alloc.h"
 #include "Stringy/Stringy.h"
+#include <string.h>
 
 // --------------------------------------------------
 
@@ -27,11 +28,17 @@ static void		mgui_memobox_on_scroll							( const MGuiEvent* event );
 static void		mgui_memobox_update_scrollbar					( struct MGuiMemobox* memobox );
 static void		mgui_memobox_needs_scrollbar					( struct MGuiMemobox* memobox );
 static void		mgui_memobox_update_display_positions			( struct MGuiMemobox* memobox );
-static void		mgui_memobox_update_display_positions_topbottom	( struct MGuiMemobox* memobox );
-static void		mgui_memobox_update_display_positions_bottomtop	( struct MGuiMemobox* memobox );
-static void		mgui_memobox_process_new_line					( struct MGuiMemobox* memobox, struct MGuiMemoRaw* raw );
-static void		mgui_memobox_wrap_line							( struct MGuiMemobox* memobox, struct MGuiMemoRaw* raw );
-static void		mgui_memobox_refresh_lines						( struct MGuiMemobox* memobox );
+static void		mgui_memobox_update_visible_lines				( struct MGuiMemobox* memobox );
+static void		mgui_memobox_clear_visible_lines				( struct MGuiMemobox* memobox );
+static void		mgui_memobox_pop_raw_line						( struct MGuiMemobox* memobox );
+static void		mgui_memobox_grow_raw_lines						( struct MGuiMemobox* memobox );
+static uint32	mgui_memobox_alloc_text							( struct MGuiMemobox* memobox, uint32 size );
+static uint32	mgui_memobox_count_lines						( struct MGuiMemobox* memobox, struct MGuiMemoRaw* raw );
+static uint32	mgui_memobox_find_raw_line						( struct MGuiMemobox* memobox, uint32 line );
+static uint32	mgui_memobox_get_wrap_width						( struct MGuiMemobox* memobox );
+static void		mgui_memobox_refresh_lines						( struct MGuiMemobox* memobox, bool force );
+
+static MYLLY_INLINE struct MGuiMemoRaw* mgui_memobox_get_raw	( struct MGuiMemobox* memobox, uint32 index );
 
 // --------------------------------------------------
 
@@ -74,7 +81,7 @@ MGuiMemobox* mgui_create_memobox( MGuiElement* parent )
 	MGuiScrollbar* scrollbar;
 	extern MGuiFont* default_font;
 
-	memobox = mem_alloc_clean( sizeof(*memobox) );
+	memobox = mgui_element_alloc( GUI_MEMOBOX, sizeof(*memobox) );
 	mgui_element_create( cast_elem(memobox), parent );
 
 	memobox->type = GUI_MEMOBOX;
@@ -82,9 +89,7 @@ MGuiMemobox* mgui_create_memobox( MGuiElement* parent )
 
 	memobox->max_history = 50;
 	memobox->num_lines = 0;
-	memobox->lines = list_create();
-	memobox->raw_lines = list_create();
-	memobox->first_line = list_end( memobox->lines );
+	memobox->dirty = true;
 
 	memobox->font = default_font;
 	memobox->text->font = default_font;
@@ -147,19 +152,27 @@ static void mgui_memobox_destroy( MGuiElement* memobox )
 
 	mgui_memobox_clear( memobox );
 
-	list_destroy( memo->raw_lines );
-	list_destroy( memo->lines );
+	SAFE_DELETE( memo->lines );
+	SAFE_DELETE( memo->raw_lines );
+	SAFE_DELETE( memo->arena );
 }
 
 static void mgui_memobox_render( MGuiElement* memobox )
 {
+	struct MGuiMemobox* memo;
+	memo = (struct MGuiMemobox*)memobox;
+
+	// Lines are only wrapped and formatted when they're about to be drawn.
+	if ( memo->dirty )
+		mgui_memobox_update_visible_lines( memo );
+
 	memobox->skin->draw_memobox( memobox );
 }
 
 static void mgui_memobox_on_bounds_change( MGuiElement* memobox, bool pos, bool size )
 {
 	if ( size )
-		mgui_memobox_refresh_lines( (struct MGuiMemobox*)memobox );
+		mgui_memobox_refresh_lines( (struct MGuiMemobox*)memobox, false );
 
 	else if ( pos )
 		mgui_memobox_update_display_positions( (struct MGuiMemobox*)memobox );
@@ -180,7 +193,8 @@ static void mgui_memobox_on_flags_change( MGuiElement* memobox, uint32 old )
 
 static void mgui_memobox_on_text_change( MGuiElement* memobox )
 {
-	mgui_memobox_refresh_lines( (struct MGuiMemobox*)memobox );
+	// The font may have changed, so every line has to be wrapped again.
+	mgui_memobox_refresh_lines( (struct MGuiMemobox*)memobox, true );
 }
 
 static void mgui_memobox_on_scroll( const MGuiEvent* event )
@@ -300,22 +314,40 @@ void mgui_memobox_add_line_s( MGuiMemobox* memobox, const char* text )
 void mgui_memobox_add_line_col_s( MGuiMemobox* memobox, const char* text, const colour_t* col )
 {
 	struct MGuiMemobox* memo;
-	struct MGuiMemoRaw* line;
-	size_t len;
+	struct MGuiMemoRaw* raw;
+	uint32 len, offset;
 
 	if ( memobox == NULL || memobox->text == NULL )
 		return;
 
 	memo = (struct MGuiMemobox*)memobox;
-	line = mem_alloc_clean( sizeof(*line) );
 
-	len = mstrlen( text );
+	if ( memo->max_history == 0 )
+		return;
 
-	line->text = mstrdup( text, len );
-	line->colour = *col;
+	// If the line count exceeds the history size pop the oldest line
+	if ( memo->num_raw >= memo->max_history )
+		mgui_memobox_pop_raw_line( memo );
 
-	mgui_memobox_process_new_line( memo, line );
-	mgui_element_request_redraw( memobox );
+	if ( memo->num_raw >= memo->raw_size )
+		mgui_memobox_grow_raw_lines( memo );
+
+	len = (uint32)mstrlen( text );
+
+	offset = mgui_memobox_alloc_text( memo, len + 1 );
+	memcpy( &memo->arena[offset], text, ( len + 1 ) * sizeof(char_t) );
+
+	raw = mgui_memobox_get_raw( memo, memo->num_raw++ );
+	raw->text = offset;
+	raw->len = len;
+	raw->colour = *col;
+	raw->line = memo->next_line;
+	raw->num_lines = mgui_memobox_count_lines( memo, raw );
+
+	memo->next_line += raw->num_lines;
+	memo->total_lines += raw->num_lines;
+
+	mgui_memobox_update_display_positions( memo );
 }
 
 /**
@@ -327,32 +359,21 @@ void mgui_memobox_add_line_col_s( MGuiMemobox* memobox, const char* text, const
  */
 void mgui_memobox_clear( MGuiMemobox* memobox )
 {
-	node_t *node, *tmp;
-	struct MGuiMemoLine* line;
-	struct MGuiMemoRaw* raw;
 	struct MGuiMemobox* memo;
 
 	if ( memobox == NULL ) return;
 
 	memo = (struct MGuiMemobox*)memobox;
 
-	list_foreach_safe( memo->raw_lines, node, tmp )
-	{
-		raw = (struct MGuiMemoRaw*)node;
-		list_remove( memo->raw_lines, node );
-
-		if ( raw->text ) mem_free( raw->text );
-		mem_free( raw );
-	}
+	mgui_memobox_clear_visible_lines( memo );
 
-	list_foreach_safe( memo->lines, node, tmp )
-	{
-		line = (struct MGuiMemoLine*)node;
-		list_remove( memo->lines, node );
-
-		if ( line->text ) mem_free( line->text );
-		mem_free( line );
-	}
+	// The storage is kept around for new lines, just reset the buffers.
+	memo->raw_first = 0;
+	memo->num_raw = 0;
+	memo->arena_head = 0;
+	memo->total_lines = 0;
+	memo->next_line = 0;
+	memo->dirty = true;
 
 	mgui_element_request_redraw( memobox );
 }
@@ -435,27 +456,28 @@ void mgui_memobox_set_lines( MGuiMemobox* memobox, uint32 lines )
 
 	memo = (struct MGuiMemobox*)memobox;
 
-	memo->num_lines = (uint8)lines;
+	memo->num_lines = lines;
 	memo->bounds.h = (uint16)( memo->text->pad.top + memo->text->pad.bottom + memo->num_lines * ( memo->margin + memo->font->size ) - memo->margin );
 
-	mgui_memobox_refresh_lines( memo );
+	mgui_memobox_refresh_lines( memo, false );
 }
 
 /**
- * @brief Returns the number of visible lines in a memobox.
+ * @brief Returns the total number of wrapped lines in a memobox.
  *
- * @details This function returns the number of currently visible
- * lines in a memobox.
+ * @details This function returns the number of lines stored in
+ * the history of a memobox after word wrapping, including the lines
+ * that have been scrolled out of view.
  *
- * @param memobox The memobox to get the visible lines of
- * @returns Number of lines currently visible
+ * @param memobox The memobox to get the number of lines of
+ * @returns Total number of wrapped lines
  */
 uint32 mgui_memobox_get_num_lines( MGuiMemobox* memobox )
 {
 	if ( memobox == NULL )
 		return 0;
 
-	return ((struct MGuiMemobox*)memobox)->lines->size;
+	return ((struct MGuiMemobox*)memobox)->total_lines;
 }
 
 /**
@@ -486,10 +508,22 @@ uint32 mgui_memobox_get_history( MGuiMemobox* memobox )
  */
 void mgui_memobox_set_history( MGuiMemobox* memobox, uint32 lines )
 {
+	struct MGuiMemobox* memo;
+
 	if ( memobox == NULL )
 		return;
 
-	((struct MGuiMemobox*)memobox)->max_history = (uint8)lines;
+	memo = (struct MGuiMemobox*)memobox;
+	memo->max_history = lines;
+
+	if ( memo->num_raw <= lines )
+		return;
+
+	// Get rid of the lines that don't fit into the history anymore.
+	while ( memo->num_raw > lines )
+		mgui_memobox_pop_raw_line( memo );
+
+	mgui_memobox_update_display_positions( memo );
 }
 
 /**
@@ -530,204 +564,346 @@ void mgui_memobox_set_margin( MGuiMemobox* memobox, uint32 margin )
 	memo->margin = (uint8)margin;
 	memo->bounds.h = (uint16)( memo->text->pad.top + memo->text->pad.bottom + memo->num_lines * ( margin + memo->font->size ) );
 
-	mgui_memobox_refresh_lines( memo );
+	mgui_memobox_refresh_lines( memo, false );
 }
 
-static void mgui_memobox_update_display_positions_topbottom( struct MGuiMemobox* memobox )
+static void mgui_memobox_update_display_positions( struct MGuiMemobox* memobox )
+{
+	// The visible lines will be updated right before the memobox is rendered,
+	// so adding several lines at once only updates them once.
+	memobox->dirty = true;
+
+	mgui_element_request_redraw( cast_elem(memobox) );
+}
+
+static void mgui_memobox_update_visible_lines( struct MGuiMemobox* memobox )
 {
-	uint16 line_height, height, display_height;
-	uint16 diff;
-	int32 x, y;
-	node_t* node;
 	struct MGuiMemoLine* line;
+	struct MGuiMemoRaw* raw;
+	MGuiFont* font;
+	MGuiFormatTag *tags, **tag_buf = NULL;
+	uint32 line_height, height, rows, count, scroll, first, skip;
+	uint32 i, index, ntags, max_width;
+	int32 x, y;
+	char_t* buf;
 
-	// Yeah, don't ask how this works... it just does.
-	line_height = memobox->font->size + memobox->margin;			// Height of one text line with spacing
-	height = (uint16)( memobox->lines->size - 1 ) * line_height;	// Height of all text lines together
+	memobox->dirty = false;
 
-	display_height = memobox->bounds.h - memobox->margin - memobox->text->pad.top - line_height;
-	display_height = height > display_height ? display_height : height;
+	mgui_memobox_clear_visible_lines( memobox );
 
-	diff = height <= memobox->bounds.h ? 0 : height - memobox->bounds.h;
+	font = memobox->text->font;
 
-	x = memobox->bounds.x + memobox->text->pad.left;
-	y = memobox->bounds.y + display_height + memobox->text->pad.top + (uint16)( memobox->position * diff );
+	if ( memobox->total_lines == 0 || font == NULL ) return;
+	if ( memobox->bounds.h <= memobox->text->pad.top + memobox->text->pad.bottom ) return;
 
-	memobox->first_line = NULL;
-	memobox->visible_lines = 0;
+	// Find out how many lines fit into the memobox at once.
+	line_height = font->size + memobox->margin;
+	height = memobox->bounds.h - memobox->text->pad.top - memobox->text->pad.bottom;
+
+	rows = ( height + memobox->margin ) / line_height;
+	count = math_min( rows, memobox->total_lines );
+
+	if ( count == 0 ) return;
+
+	// The display position is the offset from the newest line, scaled between 0 and 1.
+	scroll = memobox->total_lines - count;
+	first = scroll - (uint32)( math_clampf( memobox->position, 0, 1 ) * scroll + 0.5f );
 
-	list_foreach_r( memobox->lines, node )
+	if ( count > memobox->lines_size )
 	{
-		line = (struct MGuiMemoLine*)node;
+		SAFE_DELETE( memobox->lines );
 
-		if ( y > memobox->bounds.y + memobox->bounds.h - memobox->text->pad.bottom )
-		{
-			y -= line_height;
-			continue;
-		}
+		memobox->lines = mem_alloc_clean( count * sizeof(struct MGuiMemoLine) );
+		memobox->lines_size = count;
+	}
+
+	max_width = mgui_memobox_get_wrap_width( memobox );
+
+	// If format tags are enabled, fetch the pointer for tags
+	if ( memobox->flags & FLAG_TEXT_TAGS )
+	{
+		tag_buf = &tags;
+	}
+
+	// Find the raw line that contains the first visible line, and wrap only the visible part of the history.
+	index = mgui_memobox_find_raw_line( memobox, first );
+	skip = first - ( mgui_memobox_get_raw( memobox, index )->line - mgui_memobox_get_raw( memobox, 0 )->line );
+
+	for ( i = 0; i < count && index < memobox->num_raw; index++ )
+	{
+		raw = mgui_memobox_get_raw( memobox, index );
 
-		if ( y < memobox->bounds.y + memobox->text->pad.top )
-			break;
+		tags = NULL;
+		ntags = mgui_text_parse_and_get_line( &memobox->arena[raw->text], font, &raw->colour, max_width, &buf, tag_buf );
 
-		if ( !memobox->first_line )
+		while ( buf != NULL )
 		{
-			memobox->first_line = node;
+			if ( skip > 0 )
+			{
+				// This part of the line is above the visible area.
+				mem_free( buf );
+				SAFE_DELETE( tags );
 
-			if ( diff != 0 )
+				skip--;
+			}
+			else
 			{
-				y = memobox->bounds.y + memobox->bounds.h - memobox->font->size - memobox->text->pad.bottom - 2;
+				line = &memobox->lines[i++];
+				line->colour = raw->colour;
+				line->font = font;
+				line->text = buf;
+				line->tags = tags;
+				line->ntags = ntags;
 			}
+
+			if ( i >= count ) break;
+
+			tags = NULL;
+			ntags = mgui_text_parse_and_get_line( NULL, font, &raw->colour, max_width, &buf, tag_buf );
 		}
+	}
+
+	memobox->visible_lines = i;
+
+	x = memobox->bounds.x + memobox->text->pad.left;
 
-		memobox->visible_lines++;
+	for ( i = 0; i < memobox->visible_lines; i++ )
+	{
+		line = &memobox->lines[i];
 
-		line->pos.x = (uint16)x;
-		line->pos.y = (uint16)y;
+		if ( BIT_ON( memobox->flags, FLAG_MEMOBOX_TOPBOTTOM ) )
+		{
+			// Lines are added from the top, the oldest visible line is at the top.
+			y = memobox->bounds.y + memobox->text->pad.top + (int32)( i * line_height );
+		}
+		else
+		{
+			// Lines are added to the bottom and pushed upwards.
+			y = memobox->bounds.y + memobox->bounds.h - memobox->text->pad.bottom - font->size;
+			y -= (int32)( ( memobox->visible_lines - 1 - i ) * line_height );
+		}
 
-		y -= line_height;
+		line->pos.x = (int16)x;
+		line->pos.y = (int16)y;
 	}
 }
 
-static void mgui_memobox_update_display_positions_bottomtop( struct MGuiMemobox* memobox )
+static void mgui_memobox_clear_visible_lines( struct MGuiMemobox* memobox )
 {
-	uint16 line_height, height;
-	uint16 diff;
-	int32 x, y;
-	node_t* node;
 	struct MGuiMemoLine* line;
+	uint32 i;
 
-	line_height = memobox->font->size + memobox->text->pad.bottom;
-	height = (uint16)memobox->lines->size * line_height;
-
-	diff = height <= memobox->bounds.h ? 0 : height - memobox->bounds.h;
+	for ( i = 0; i < memobox->visible_lines; i++ )
+	{
+		line = &memobox->lines[i];
 
-	x = memobox->bounds.x + memobox->text->pad.left;
-	y = memobox->bounds.y + memobox->bounds.h - memobox->font->size - memobox->text->pad.bottom - 2 + (uint16)( memobox->position * diff );
+		SAFE_DELETE( line->text );
+		SAFE_DELETE( line->tags );
+	}
 
-	memobox->first_line = NULL;
 	memobox->visible_lines = 0;
+}
 
-	list_foreach_r( memobox->lines, node )
-	{
-		line = (struct MGuiMemoLine*)node;
-
-		if ( y > memobox->bounds.y + memobox->bounds.h )
-		{
-			y -= line_height;
-			continue;
-		}
-
-		if ( y <= memobox->bounds.y )
-			break;
+static void mgui_memobox_pop_raw_line( struct MGuiMemobox* memobox )
+{
+	struct MGuiMemoRaw* raw;
 
-		if ( !memobox->first_line )
-			memobox->first_line = node;
+	if ( memobox->num_raw == 0 ) return;
 
-		memobox->visible_lines++;
+	raw = mgui_memobox_get_raw( memobox, 0 );
 
-		line->pos.x = (uint16)x;
-		line->pos.y = (uint16)y;
+	memobox->total_lines -= raw->num_lines;
+	memobox->raw_first = ( memobox->raw_first + 1 ) % memobox->raw_size;
+	memobox->num_raw--;
 
-		y -= line_height;
+	// The text of the oldest line marks the beginning of the used part of the arena,
+	// so the space of the popped line is reclaimed automatically.
+	if ( memobox->num_raw == 0 )
+	{
+		memobox->raw_first = 0;
+		memobox->arena_head = 0;
 	}
 }
 
-static void mgui_memobox_update_display_positions( struct MGuiMemobox* memobox )
+static void mgui_memobox_grow_raw_lines( struct MGuiMemobox* memobox )
 {
-	if ( memobox->lines->size == 0 ) return;
+	struct MGuiMemoRaw* lines;
+	uint32 i, size;
 
-	if ( BIT_ON( memobox->flags, FLAG_MEMOBOX_TOPBOTTOM ) )
-		mgui_memobox_update_display_positions_topbottom( memobox );
-	else
-		mgui_memobox_update_display_positions_bottomtop( memobox );
+	size = memobox->raw_size ? memobox->raw_size * 2 : 16;
+	size = math_min( size, memobox->max_history );
+	size = math_max( size, memobox->num_raw + 1 );
 
-	mgui_element_request_redraw( cast_elem(memobox) );
+	lines = mem_alloc( size * sizeof(struct MGuiMemoRaw) );
+
+	// Unroll the ring buffer while copying the old lines.
+	for ( i = 0; i < memobox->num_raw; i++ )
+		lines[i] = *mgui_memobox_get_raw( memobox, i );
+
+	SAFE_DELETE( memobox->raw_lines );
+
+	memobox->raw_lines = lines;
+	memobox->raw_first = 0;
+	memobox->raw_size = size;
 }
 
-static void mgui_memobox_process_new_line( struct MGuiMemobox* memobox, struct MGuiMemoRaw* raw )
+static uint32 mgui_memobox_alloc_text( struct MGuiMemobox* memobox, uint32 size )
 {
-	node_t* node;
-	struct MGuiMemoRaw* oldraw;
-	struct MGuiMemoLine* oldline;
-
-	list_push( memobox->raw_lines, cast_node(raw) );
+	struct MGuiMemoRaw* raw;
+	char_t* arena;
+	uint32 i, tail, used, offset = (uint32)-1;
 
-	if ( memobox->raw_lines->size > memobox->max_history )
+	if ( memobox->num_raw == 0 )
 	{
-		// If the line count exceeds the history size pop some lines
-		node = list_pop_front( memobox->raw_lines );
-		oldraw = (struct MGuiMemoRaw*)node;
+		memobox->arena_head = 0;
 
-		mem_free( oldraw->text );
-		mem_free( oldraw );
+		if ( size <= memobox->arena_size )
+			offset = 0;
 	}
+	else
+	{
+		tail = mgui_memobox_get_raw( memobox, 0 )->text;
 
-	mgui_memobox_wrap_line( memobox, raw );
+		if ( memobox->arena_head > tail )
+		{
+			// The used part of the arena is contiguous. Use the space at the end of the arena,
+			// or wrap around to the beginning if there's no room.
+			if ( memobox->arena_head + size <= memobox->arena_size )
+				offset = memobox->arena_head;
 
-	while ( memobox->lines->size > memobox->max_history )
+			else if ( size < tail )
+				offset = 0;
+		}
+		else if ( memobox->arena_head + size < tail )
+		{
+			offset = memobox->arena_head;
+		}
+	}
+
+	if ( offset == (uint32)-1 )
 	{
-		// Pop some old display lines
-		node = list_pop_front( memobox->lines );
-		oldline = (struct MGuiMemoLine*)node;
+		// Out of space, allocate a bigger arena and pack the old lines to the beginning of it.
+		for ( i = 0, used = size; i < memobox->num_raw; i++ )
+			used += mgui_memobox_get_raw( memobox, i )->len + 1;
+
+		memobox->arena_size = memobox->arena_size ? memobox->arena_size * 2 : 1024;
+
+		while ( memobox->arena_size < used )
+			memobox->arena_size *= 2;
+
+		arena = mem_alloc( memobox->arena_size * sizeof(char_t) );
 
-		mem_free( oldline->text );
-		mem_free( oldline );
+		for ( i = 0, offset = 0; i < memobox->num_raw; i++ )
+		{
+			raw = mgui_memobox_get_raw( memobox, i );
+
+			memcpy( &arena[offset], &memobox->arena[raw->text], ( raw->len + 1 ) * sizeof(char_t) );
+
+			raw->text = offset;
+			offset += raw->len + 1;
+		}
+
+		SAFE_DELETE( memobox->arena );
+		memobox->arena = arena;
 	}
 
-	mgui_memobox_update_display_positions( memobox );
+	memobox->arena_head = offset + size;
+
+	return offset;
 }
 
-static void mgui_memobox_wrap_line( struct MGuiMemobox* memobox, struct MGuiMemoRaw* raw )
+static uint32 mgui_memobox_count_lines( struct MGuiMemobox* memobox, struct MGuiMemoRaw* raw )
 {
-	struct MGuiMemoLine* line;
-	uint32 max_width, ntags;
-	MGuiFormatTag *tags = NULL, **tag_buf = NULL;
-	char* buf;
+	uint32 max_width, count = 0;
+	MGuiFormatTag *tags, **tag_buf = NULL;
+	char_t* buf;
 
-	max_width = memobox->bounds.w - memobox->text->pad.left - memobox->text->pad.right;
+	max_width = mgui_memobox_get_wrap_width( memobox );
 
-	// If format tags are enabled, fetch the pointer for tags
+	// Format tags have to be parsed to get the correct line width.
 	if ( memobox->flags & FLAG_TEXT_TAGS )
 	{
 		tag_buf = &tags;
 	}
-	
-	for ( ntags = mgui_text_parse_and_get_line( raw->text, memobox->text->font, &raw->colour, max_width, &buf, tag_buf ); buf;
-		  ntags = mgui_text_parse_and_get_line( NULL, memobox->text->font, &raw->colour, max_width, &buf, tag_buf ) )
+
+	tags = NULL;
+	mgui_text_parse_and_get_line( &memobox->arena[raw->text], memobox->text->font, &raw->colour, max_width, &buf, tag_buf );
+
+	while ( buf != NULL )
 	{
-		line = mem_alloc_clean( sizeof(*line) );
-		line->colour = raw->colour;
-		line->font = memobox->text->font;
-		line->text = buf;
-		line->tags = tag_buf ? tags : NULL;
-		line->ntags = ntags;
-
-		list_push( memobox->lines, cast_node(line) );
+		count++;
+
+		mem_free( buf );
+		SAFE_DELETE( tags );
+
+		mgui_text_parse_and_get_line( NULL, memobox->text->font, &raw->colour, max_width, &buf, tag_buf );
 	}
+
+	return count;
 }
 
-static void mgui_memobox_refresh_lines( struct MGuiMemobox* memobox )
+static uint32 mgui_memobox_find_raw_line( struct MGuiMemobox* memobox, uint32 line )
 {
-	struct MGuiMemoLine* line;
-	struct MGuiMemoRaw* raw;
-	node_t *node, *tmp;
+	uint32 first, low, high, mid;
+
+	if ( memobox->num_raw == 0 ) return 0;
 
-	// Remove old formatted lines
-	list_foreach_safe( memobox->lines, node, tmp )
+	// Wrapped line indices grow along with the raw lines, so use a binary search.
+	first = mgui_memobox_get_raw( memobox, 0 )->line;
+	low = 0;
+	high = memobox->num_raw - 1;
+
+	while ( low < high )
 	{
-		line = (struct MGuiMemoLine*)node;
-		list_remove( memobox->lines, node );
+		mid = ( low + high + 1 ) / 2;
 
-		if ( line->text ) mem_free( line->text );
-		mem_free( line );
+		if ( mgui_memobox_get_raw( memobox, mid )->line - first <= line )
+			low = mid;
+		else
+			high = mid - 1;
 	}
 
-	// Then re-add every raw line
-	list_foreach( memobox->raw_lines, node )
+	return low;
+}
+
+static uint32 mgui_memobox_get_wrap_width( struct MGuiMemobox* memobox )
+{
+	if ( memobox->bounds.w <= memobox->text->pad.left + memobox->text->pad.right )
+		return 0;
+
+	return memobox->bounds.w - memobox->text->pad.left - memobox->text->pad.right;
+}
+
+static void mgui_memobox_refresh_lines( struct MGuiMemobox* memobox, bool force )
+{
+	struct MGuiMemoRaw* raw;
+	uint32 i, max_width;
+
+	max_width = mgui_memobox_get_wrap_width( memobox );
+
+	// Re-wrap every raw line only if the width of the lines has actually changed.
+	if ( force || max_width != memobox->wrap_width )
 	{
-		raw = (struct MGuiMemoRaw*)node;
-		mgui_memobox_wrap_line( memobox, raw );
+		memobox->wrap_width = max_width;
+		memobox->total_lines = 0;
+		memobox->next_line = 0;
+
+		for ( i = 0; i < memobox->num_raw; i++ )
+		{
+			raw = mgui_memobox_get_raw( memobox, i );
+
+			raw->line = memobox->next_line;
+			raw->num_lines = mgui_memobox_count_lines( memobox, raw );
+
+			memobox->next_line += raw->num_lines;
+			memobox->total_lines += raw->num_lines;
+		}
 	}
 
 	mgui_memobox_update_display_positions( memobox );
 }
+
+static MYLLY_INLINE struct MGuiMemoRaw* mgui_memobox_get_raw( struct MGuiMemobox* memobox, uint32 index )
+{
+	return &memobox->raw_lines[( memobox->raw_first + index ) % memobox->raw_size];
+}
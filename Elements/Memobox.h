@@ -20,10 +20,10 @@
  * @brief Formatted memobox line.
  *
  * @details MGuiMemoLine is a data container for a parsed and formatted
- * line of text in a memobox.
+ * line of text in a memobox. Formatted lines are only created for the
+ * part of the history that is currently visible.
  */
 struct MGuiMemoLine {
-	node_t;					///< Linked list node
 	char_t*			text;	///< Pointer to a text buffer that contains the line without format tags
 	MGuiFont*		font;	///< Pointer to a font data structure that is used to render the line
 	colour_t		colour;	///< Default colour for this memobox line
@@ -34,28 +34,46 @@ struct MGuiMemoLine {
 
 /**
  * @brief Unparsed memobox line.
+ *
  * @details MGuiMemoRaw is a container for an unparsed line of text in a memobox.
+ * The text itself is stored into the string arena of the memobox.
  */
 struct MGuiMemoRaw {
-	node_t;					///< Linked list node
-	char_t*		text;		///< Pointer to a text buffer that contains the unparsed line
+	uint32		text;		///< Offset of the unparsed line in the string arena of the memobox
+	uint32		len;		///< Length of the unparsed line (in characters)
 	colour_t	colour;		///< Default colour for the text
+	uint32		line;		///< Index of the first wrapped line of this line
+	uint32		num_lines;	///< Number of wrapped lines this line takes
 };
 
 /**
  * @brief GUI memobox.
- * @details Memobox is a multiline read-only textbox.
+ *
+ * @details Memobox is a multiline read-only textbox. The history is stored into
+ * a ring buffer of raw lines, and the text of the lines into a ring shaped string
+ * arena, so adding and removing lines takes constant time regardless of the size
+ * of the history. Only the visible part of the history is wrapped and formatted.
  */
 struct MGuiMemobox {
 	MGuiElement;							///< Inherit MGuiElement members
 	float					position;		///< Current scroll position inside the renderable area
 	uint8					margin;			///< Margin between two memobox lines in pixels
-	uint8					max_history;	///< Maximum number of raw input lines to be stored as history
-	uint8					num_lines;		///< Maximum number of visible lines to be shown in the memobox at once
-	uint8					visible_lines;	///< Current number of visible lines
-	list_t*					lines;			///< List of processed and wrapped memobox lines (see @ref MGuiMemoLine)
-	list_t*					raw_lines;		///< List of unprocessed (raw) memobox lines (see @ref MGuiMemoRaw)
-	node_t*					first_line;		///< First visible line to be rendered
+	bool					dirty;			///< The visible lines have to be updated before rendering
+	uint32					max_history;	///< Maximum number of raw input lines to be stored as history
+	uint32					num_lines;		///< Maximum number of visible lines to be shown in the memobox at once
+	uint32					visible_lines;	///< Current number of visible lines
+	struct MGuiMemoLine*	lines;			///< Array of formatted lines that are currently visible (see @ref MGuiMemoLine)
+	uint32					lines_size;		///< Number of formatted lines the array above has room for
+	struct MGuiMemoRaw*		raw_lines;		///< Ring buffer of unprocessed (raw) memobox lines (see @ref MGuiMemoRaw)
+	uint32					raw_first;		///< Index of the oldest raw line in the ring buffer
+	uint32					num_raw;		///< Number of raw lines stored into the ring buffer
+	uint32					raw_size;		///< Number of raw lines the ring buffer has room for
+	char_t*					arena;			///< String arena which contains the text of the raw lines
+	uint32					arena_size;		///< Size of the string arena (in characters)
+	uint32					arena_head;		///< Offset of the next free character in the string arena
+	uint32					total_lines;	///< Total number of wrapped lines in the history
+	uint32					next_line;		///< Wrapped line index of the next raw line to be added
+	uint32					wrap_width;		///< Width the raw lines were last wrapped to
 	struct MGuiScrollbar*	scrollbar;		///< The scrollbar element that is shown if the memobox gets too big
 };
 
@@ -0,0 +1,112 @@
+/**
+ *
+ * @file		Pool.c
+ * @copyright	Tuomo Jauhiainen 2012-2014
+ * @licence		See Licence.txt
+ * @brief		Fixed size object pools.
+ *
+ * @details		A slab allocator for objects that are created and destroyed often (elements, list items).
+ *
+ **/
+
+#include "Pool.h"
+#include "Platform/Alloc.h"
+#include <string.h>
+
+// --------------------------------------------------
+
+#define POOL_ALIGNMENT 16	// Alignment of every object within a slab
+
+static MGuiPool* pools = NULL;	// A list of initialized pools
+
+// --------------------------------------------------
+
+static void mgui_pool_add_slab( MGuiPool* pool );
+
+// --------------------------------------------------
+
+void mgui_pool_initialize( MGuiPool* pool, size_t size )
+{
+	if ( pool == NULL || pool->size != 0 ) return;
+
+	// Every object has to be able to hold the free list pointer.
+	size = math_max( size, sizeof(void*) );
+
+	pool->size = (uint32)( ( size + POOL_ALIGNMENT - 1 ) & ~( POOL_ALIGNMENT - 1 ) );
+	pool->per_slab = math_max( ( POOL_SLAB_SIZE - POOL_ALIGNMENT ) / pool->size, 8 );
+	pool->slabs = NULL;
+	pool->free_list = NULL;
+	pool->num_used = 0;
+
+	// Remember the pool so it can be released when the library is shut down.
+	pool->next = pools;
+	pools = pool;
+}
+
+void mgui_pool_shutdown_all( void )
+{
+	MGuiPool* pool;
+	void *slab, *next;
+
+	for ( pool = pools; pool != NULL; pool = pool->next )
+	{
+		for ( slab = pool->slabs; slab != NULL; slab = next )
+		{
+			next = *(void**)slab;
+			mem_free( slab );
+		}
+
+		pool->slabs = NULL;
+		pool->free_list = NULL;
+		pool->num_used = 0;
+		pool->size = 0;
+	}
+
+	pools = NULL;
+}
+
+void* mgui_pool_alloc( MGuiPool* pool )
+{
+	void* ptr;
+
+	if ( pool->free_list == NULL )
+		mgui_pool_add_slab( pool );
+
+	ptr = pool->free_list;
+	pool->free_list = *(void**)ptr;
+	pool->num_used++;
+
+	memset( ptr, 0, pool->size );
+	return ptr;
+}
+
+void mgui_pool_free( MGuiPool* pool, void* ptr )
+{
+	if ( ptr == NULL ) return;
+
+	*(void**)ptr = pool->free_list;
+	pool->free_list = ptr;
+	pool->num_used--;
+}
+
+static void mgui_pool_add_slab( MGuiPool* pool )
+{
+	uint8* slab;
+	uint8* ptr;
+	uint32 i;
+
+	// The first bytes of a slab are used to link the slabs together.
+	slab = mem_alloc( POOL_ALIGNMENT + pool->size * pool->per_slab );
+
+	*(void**)slab = pool->slabs;
+	pool->slabs = slab;
+
+	// Push the objects to the free list in reverse so that they're used in order.
+	ptr = slab + POOL_ALIGNMENT + pool->size * ( pool->per_slab - 1 );
+
+	for ( i = 0; i < pool->per_slab; i++, ptr -= pool->size )
+	{
+		*(void**)ptr = pool->free_list;
+		pool->free_list = ptr;
+	}
+}
@@ -0,0 +1,42 @@
+/**
+ *
+ * @file		Pool.h
+ * @copyright	Tuomo Jauhiainen 2012-2014
+ * @licence		See Licence.txt
+ * @brief		Fixed size object pools.
+ *
+ * @details		A slab allocator for objects that are created and destroyed often (elements, list items).
+ *
+ **/
+
+#pragma once
+#ifndef __MGUI_POOL_H
+#define __MGUI_POOL_H
+
+#include "MGUI.h"
+
+#define POOL_SLAB_SIZE 16384	///< Preferred size of a single slab in bytes
+
+/**
+ * @brief A pool of fixed size objects.
+ *
+ * @details Objects are allocated from larger slabs of memory and recycled
+ * via a free list when released. Slabs are never returned to the system
+ * until the library is shut down, so creating and destroying elements
+ * repeatedly does not fragment the heap.
+ */
+typedef struct MGuiPool {
+	struct MGuiPool*	next;		///< Next pool in the list of initialized pools
+	void*				slabs;		///< A linked list of allocated slabs
+	void*				free_list;	///< A linked list of released objects
+	uint32				size;		///< Size of a single object in bytes
+	uint32				per_slab;	///< Number of objects within a slab
+	uint32				num_used;	///< Number of objects currently in use
+} MGuiPool;
+
+void		mgui_pool_initialize		( MGuiPool* pool, size_t size );
+void		mgui_pool_shutdown_all		( void );
+void*		mgui_pool_alloc				( MGuiPool* pool );
+void		mgui_pool_free				( MGuiPool* pool, void* ptr );
+
+#endif /* __MGUI_POOL_H */
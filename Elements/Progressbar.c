@@ -59,7 +59,7 @@ MGuiProgressbar* mgui_create_progressbar( MGuiElement* parent )
 {
 	struct MGuiProgressbar* bar;
 
-	bar = mem_alloc_clean( sizeof(*bar) );
+	bar = mgui_element_alloc( GUI_PROGRESSBAR, sizeof(*bar) );
 	bar->flags_int |= INTFLAG_NOTEXT;
 
 	mgui_element_create( cast_elem(bar), parent );
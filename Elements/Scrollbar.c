@@ -12,8 +12,8 @@
 #include "Scrollbar.h"
 #include "Skin.h"
 #include "Renderer.h"
+#include "TimerWheel.h"
 #include "Platform/Alloc.h"
-#include "Platform/Timer.h"
 
 // --------------------------------------------------
 
@@ -71,7 +71,7 @@ MGuiScrollbar* mgui_create_scrollbar( MGuiElement* parent )
 {
 	struct MGuiScrollbar* scrollbar;
 
-	scrollbar = mem_alloc_clean( sizeof(*scrollbar) );
+	scrollbar = mgui_element_alloc( GUI_SCROLLBAR, sizeof(*scrollbar) );
 	scrollbar->flags_int |= INTFLAG_NOTEXT;
 
 	mgui_element_create( cast_elem(scrollbar), parent );
@@ -130,18 +130,14 @@ static void mgui_scrollbar_render( MGuiScrollbar* scrollbar )
 static void mgui_scrollbar_process( MGuiScrollbar* scrollbar )
 {
 	struct MGuiScrollbar* bar = (struct MGuiScrollbar*)scrollbar;
-	uint32 ticks, button_flags = SCROLL_BUTTON1_PRESSED|SCROLL_BUTTON2_PRESSED;
+	uint32 button_flags = SCROLL_BUTTON1_PRESSED|SCROLL_BUTTON2_PRESSED;
 
-	if ( scrollbar == NULL ||
-		 bar->nudge_time == 0 )
-		 return;
-
-	ticks = get_tick_count();
+	if ( scrollbar == NULL ) return;
 
-	if ( BIT_ON( bar->scroll_flags, button_flags ) &&
-		 ticks > bar->nudge_time )
+	// Keep nudging for as long as a button is being pressed.
+	if ( BIT_ON( bar->scroll_flags, button_flags ) )
 	{
-		bar->nudge_time = ticks + 100;
+		mgui_timer_set( scrollbar, 100 );
 
 		mgui_scrollbar_process_nudge( bar );
 		mgui_element_request_redraw( scrollbar );
@@ -227,7 +223,7 @@ static void mgui_scrollbar_on_mouse_click( MGuiScrollbar* scrollbar, int16 x, in
 		if ( flags & button_mask )
 		{
 			// Seems the user is pressing a button, process nudge.
-			bar->nudge_time = get_tick_count() + 500;
+			mgui_timer_set( scrollbar, 500 );
 
 			mgui_scrollbar_process_nudge( bar );
 		}
@@ -251,7 +247,7 @@ static void mgui_scrollbar_on_mouse_release( MGuiScrollbar* scrollbar, int16 x,
 	if ( bar->scroll_flags & press_mask )
 	{
 		bar->scroll_flags &= ~press_mask;
-		bar->nudge_time = 0;
+		mgui_timer_cancel( scrollbar );
 
 		mgui_element_request_redraw( scrollbar );
 	}
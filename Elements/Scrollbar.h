@@ -48,7 +48,6 @@ struct MGuiScrollbar {
 	float			bar_position;	///< The position of the scrollbar, relative to content_size
 	float			bar_size;		///< The relative size of the scrollbar (scaled between 0 and 1)
 	uint32			scroll_flags;	///< Internal scrollbar flags (see @ref SCROLLBAR_FLAGS)
-	uint32			nudge_time;		///< Timestamp when the next nudge should happen
 };
 
 MGuiScrollbar* mgui_create_scrollbar	( MGuiElement* parent );
@@ -60,7 +60,7 @@ MGuiSprite* mgui_create_sprite( MGuiElement* parent )
 {
 	struct MGuiSprite* sprite;
 
-	sprite = mem_alloc_clean( sizeof(*sprite) );
+	sprite = mgui_element_alloc( GUI_SPRITE, sizeof(*sprite) );
 	sprite->flags_int |= INTFLAG_NOTEXT;
 
 	mgui_element_create( cast_elem(sprite), parent );
@@ -29,86 +29,96 @@ static bool parse_colour_tag( const char_t* text, uint32* in );
 static bool parse_end_tag( const char_t* text, char_t* in );
 static bool mgui_text_parse_tag( const char_t** ptext, MGuiFormatTag tags[], uint32* ntag, uint32* index, const colour_t* def );
 static void mgui_text_parse_format_tags2( MGuiText* text, uint32 num_tags );
+static void mgui_text_allocate_buffers( MGuiText* text, size_t size );
+static void mgui_text_free_buffers( MGuiText* text );
 
 // --------------------------------------------------
 
-MGuiText* mgui_text_create( void )
+void mgui_text_initialize( MGuiText* text )
 {
-	MGuiText* text;
-	text = (MGuiText*)mem_alloc_clean( sizeof(*text) );
-
+	// The text is stored within the element, so it has already been zeroed.
 	text->alignment = ALIGN_CENTER;
 	text->colour.hex = COL_TEXT;
-
-	return text;
 }
 
 void mgui_text_destroy( MGuiText* text )
 {
 	if ( text == NULL ) return;
 
-	SAFE_DELETE( text->buffer );
-	SAFE_DELETE( text->buffer_tags );
-
-	mem_free( text );
+	mgui_text_free_buffers( text );
+	SAFE_DELETE( text->tags );
 }
 
 static void mgui_text_update_buffers( MGuiText* text, const char_t* tmp, size_t len )
 {
 	uint32 tags;
-	size_t size;
 
 	if ( text == NULL ) return;
 
 	text->len = len;
 
 	// Do we need to reallocate memory for the new buffer?
-	if ( len + 1 > text->bufsize )
+	if ( len + 1 > text->bufsize ||
+		 ( text->flags & TFLAG_TAGS && text->buffer_tags == NULL ) )
 	{
-		// Delete old buffers
-		SAFE_DELETE( text->buffer );
-		SAFE_DELETE( text->buffer_tags );
-
-		// Allocate new buffers
-		if ( text->flags & TFLAG_TAGS )
-		{
-			size = len * sizeof(char_t) + 1;
+		mgui_text_allocate_buffers( text, len + 1 );
+	}
 
-			text->buffer = mem_alloc( size );
-			text->buffer_tags = mstrdup( tmp, len );
-			text->bufsize = len + 1;
+	if ( text->flags & TFLAG_TAGS )
+	{
+		mstrcpy( text->buffer_tags, tmp, text->bufsize );
 
-			tags = mgui_text_strip_format_tags( text->buffer_tags, text->buffer, text->bufsize );
-			mgui_text_parse_format_tags2( text, tags );
+		tags = mgui_text_strip_format_tags( text->buffer_tags, text->buffer, text->bufsize );
+		mgui_text_parse_format_tags2( text, tags );
 
-			text->len = mstrlen( text->buffer );
-		}
-		else
-		{
-			text->buffer = mstrdup( tmp, len );
-			text->buffer_tags = NULL;
-			text->bufsize = len + 1;
-		}
+		text->len = mstrlen( text->buffer );
 	}
 	else
 	{
-		// It's safe to use the old buffers
-		if ( text->flags & TFLAG_TAGS )
-		{
-			mstrcpy( text->buffer_tags, tmp, text->bufsize );
+		mstrcpy( text->buffer, tmp, text->bufsize );
+	}
 
-			tags = mgui_text_strip_format_tags( text->buffer_tags, text->buffer, text->bufsize );
-			mgui_text_parse_format_tags2( text, tags );
+	// The text will be measured once the layout transaction it was changed in is committed.
+	if ( text->flags & TFLAG_DEFERRED ) return;
 
-			text->len = mstrlen( text->buffer );
-		}
-		else
-		{
-			mstrcpy( text->buffer, tmp, text->bufsize );
-		}
+	mgui_text_update_dimensions( text );
+}
+
+static void mgui_text_allocate_buffers( MGuiText* text, size_t size )
+{
+	uint32 buffers;
+
+	mgui_text_free_buffers( text );
+
+	// Text with format tags needs a second buffer for the raw text.
+	buffers = ( text->flags & TFLAG_TAGS ) ? 2 : 1;
+
+	if ( size * buffers <= lengthof(text->inline_buf) )
+	{
+		// Short strings fit into the inline buffer, no need to allocate anything.
+		text->bufsize = lengthof(text->inline_buf) / buffers;
+		text->buffer = text->inline_buf;
+		text->buffer_tags = ( buffers > 1 ) ? text->inline_buf + text->bufsize : NULL;
 	}
+	else
+	{
+		text->bufsize = size;
+		text->buffer = mem_alloc( size * sizeof(char_t) );
+		text->buffer_tags = ( buffers > 1 ) ? mem_alloc( size * sizeof(char_t) ) : NULL;
+	}
+}
 
-	mgui_text_update_dimensions( text );
+static void mgui_text_free_buffers( MGuiText* text )
+{
+	if ( text->buffer != text->inline_buf )
+		SAFE_DELETE( text->buffer );
+
+	if ( text->buffer_tags != text->inline_buf + lengthof(text->inline_buf) / 2 )
+		SAFE_DELETE( text->buffer_tags );
+
+	text->buffer = NULL;
+	text->buffer_tags = NULL;
+	text->bufsize = 0;
 }
 
 void mgui_text_set_buffer( MGuiText* text, const char_t* fmt, ... )
@@ -234,7 +244,7 @@ void mgui_text_update_position( MGuiText* text )
 uint32 mgui_text_get_closest_char( MGuiText* text, uint16 x, uint16 y )
 {
 	uint32 dist, ch, i, tmp;
-	uint16 cx, cy;
+	int32 cx, spacing;
 
 	if ( text == NULL ) return 0;
 
@@ -243,10 +253,19 @@ uint32 mgui_text_get_closest_char( MGuiText* text, uint16 x, uint16 y )
 
 	dist = 0xFFFF;
 	ch = 0;
+	cx = 0;
+
+	spacing = mgui_font_get_spacing( text->font );
 
 	for ( i = 0; i < text->len + 1; i++ )
 	{
-		mgui_text_get_char_pos( text, i, &cx, &cy );
+		// Position of the character i is the width of all the characters before it.
+		if ( i > 0 )
+		{
+			cx += mgui_font_get_char_width( text->font, text->buffer[i-1] );
+			if ( i > 1 ) cx += spacing;
+		}
+
 		tmp = math_abs( cx - x );
 
 		if ( tmp < dist )
@@ -254,6 +273,11 @@ uint32 mgui_text_get_closest_char( MGuiText* text, uint16 x, uint16 y )
 			dist = tmp;
 			ch = i;
 		}
+		else if ( cx > x )
+		{
+			// We've passed the point, the characters only get further away from here.
+			break;
+		}
 	}
 
 	return ch;
@@ -261,8 +285,8 @@ uint32 mgui_text_get_closest_char( MGuiText* text, uint16 x, uint16 y )
 
 void mgui_text_get_char_pos( MGuiText* text, uint32 idx, uint16* x, uint16* y )
 {
-	char_t tmp[512];
-	uint32 w, h;
+	uint32 i;
+	int32 w, spacing;
 
 	if ( text == NULL ) return;
 
@@ -273,11 +297,18 @@ void mgui_text_get_char_pos( MGuiText* text, uint32 idx, uint16* x, uint16* y )
 		return;
 	}
 
-	mstrcpy( tmp, text->buffer, math_min( idx+1, lengthof(tmp) ) );
-	renderer->measure_text( text->font->data, tmp, &w, &h );
+	idx = math_min( idx, text->len );
+	spacing = mgui_font_get_spacing( text->font );
+
+	// Spacing only goes between characters, the same as in mgui_text_get_closest_char.
+	for ( i = 0, w = 0; i < idx; i++ )
+	{
+		w += mgui_font_get_char_width( text->font, text->buffer[i] );
+		if ( i > 0 ) w += spacing;
+	}
 
-	*x = (uint16)w;
-	*y = (uint16)h;
+	*x = (uint16)math_max( w, 0 );
+	*y = (uint16)mgui_font_get_height( text->font );
 }
 
 void mgui_text_set_default_colour( MGuiText* text )
@@ -594,13 +625,13 @@ static void mgui_text_parse_format_tags2( MGuiText* text, uint32 num_tags )
 
 uint32 mgui_text_parse_and_get_line( const char_t* text, MGuiFont* font, const colour_t* def, uint32 max_width, char_t** buf_in, MGuiFormatTag** tags_in )
 {
-	uint32 width = 0, w, h, i = 0, flags;
+	uint32 width = 0, i = 0, flags;
 	uint32 space = 0, ntag = 0, len = 0, index = 0;
+	int32 pad;
 	bool has_tags = false;
 	const char_t *s, *last_space = NULL;
-	char_t *t, tmp[2];
+	char_t *t;
 
-	static uint32 pad = 0;
 	static char_t tmpbuf[1024];
 	static MGuiFormatTag tmptags[32], prev_tag;
 	static const char_t* ptr = NULL;
@@ -639,15 +670,12 @@ uint32 mgui_text_parse_and_get_line( const char_t* text, MGuiFont* font, const c
 		prev_tag.index = (uint16)-1;
 		prev_tag.flags = 0;
 		prev_tag.colour.hex = 0;
-
-		// Measure padding between two characters.
-		renderer->measure_text( font->data, _MTEXT("XX"), &pad, &h );
-		renderer->measure_text( font->data, _MTEXT("X"), &w, &h );
-
-		pad -= 2 * w;
 	}	
 
-	tmpbuf[0] = tmp[1] = '\0';
+	// Padding between two characters.
+	pad = mgui_font_get_spacing( font );
+
+	tmpbuf[0] = '\0';
 	t = tmpbuf;
 
 	for ( ; *s; )
@@ -671,14 +699,12 @@ uint32 mgui_text_parse_and_get_line( const char_t* text, MGuiFont* font, const c
 			continue;
 		}
 
-		// Measure the width of the current character and add it to the total line width.
-		tmp[0] = *s;
-
-		renderer->measure_text( font->data, tmp, &w, &h );
-		width += w + pad;
+		// Add the width of the current character to the total line width.
+		width += mgui_font_get_char_width( font, *s ) + pad;
 
 		// Do we have anough text for a new line?
-		if ( width > max_width || *s == '\n' )
+		// Always take at least one character per line, otherwise a narrow line would never end.
+		if ( ( width > max_width && len > 0 ) || *s == '\n' )
 		{
 			break;
 		}
@@ -18,6 +18,8 @@
 #include "Renderer.h"
 #include <stdarg.h>
 
+#define TEXT_INLINE_SIZE 32	// Size of the inline buffer short strings are stored into (in characters)
+
 typedef struct MGuiText
 {
 	char_t*			buffer;			// Text buffer for the actual text
@@ -36,10 +38,12 @@ typedef struct MGuiText
 	uint32			num_tags;		// Number of colour tags in the array
 
 	struct { uint8 top, bottom, left, right; } pad;	// Text padding 
+
+	char_t			inline_buf[TEXT_INLINE_SIZE];	// Storage for short strings, used instead of allocating the buffers
 } MGuiText;
 
 // Helper functions
-MGuiText*	mgui_text_create				( void );
+void		mgui_text_initialize			( MGuiText* text );
 void		mgui_text_destroy				( MGuiText* text );
 
 void		mgui_text_set_buffer			( MGuiText* text, const char_t* fmt, ... );
@@ -0,0 +1,160 @@
+/**
+ *
+ * @file		TimerWheel.c
+ * @copyright	Tuomo Jauhiainen 2012-2014
+ * @licence		See Licence.txt
+ * @brief		Element timer scheduling.
+ *
+ * @details		A timer wheel used to call the process callback of an element when its deadline has passed.
+ *
+ **/
+
+#include "TimerWheel.h"
+#include "Stats.h"
+#include "Platform/Timer.h"
+
+// --------------------------------------------------
+
+#define TIMER_WHEEL_MASK ( TIMER_WHEEL_SLOTS - 1 )
+
+static MGuiElement*	wheel[TIMER_WHEEL_SLOTS];	// Scheduled elements, hashed by their deadline
+static uint32		current_slot	= 0;		// The slot (in ticks >> TIMER_WHEEL_SHIFT) that was processed last
+static uint32		num_timers		= 0;		// Number of scheduled elements
+
+// --------------------------------------------------
+
+static void mgui_timer_unlink( MGuiElement* element );
+
+// --------------------------------------------------
+
+void mgui_timer_set( MGuiElement* element, uint32 delay )
+{
+	MGuiElement** slot;
+	uint32 ticks;
+
+	if ( element == NULL || element->callbacks->process == NULL ) return;
+
+	ticks = get_tick_count();
+
+	// Make sure a timer set from within a callback won't be processed again during the same call.
+	delay = math_max( delay, 1 );
+
+	if ( element->flags_int & INTFLAG_TIMER )
+		mgui_timer_unlink( element );
+
+	// An empty wheel can start from the current time, there's nothing to catch up to.
+	if ( num_timers == 0 )
+		current_slot = ticks >> TIMER_WHEEL_SHIFT;
+
+	element->timer = ticks + delay;
+	element->flags_int |= INTFLAG_TIMER;
+
+	slot = &wheel[( element->timer >> TIMER_WHEEL_SHIFT ) & TIMER_WHEEL_MASK];
+
+	element->timer_prev = NULL;
+	element->timer_next = *slot;
+
+	if ( *slot != NULL )
+		(*slot)->timer_prev = element;
+
+	*slot = element;
+	num_timers++;
+}
+
+void mgui_timer_cancel( MGuiElement* element )
+{
+	if ( element == NULL ) return;
+
+	if ( element->flags_int & INTFLAG_TIMER )
+		mgui_timer_unlink( element );
+}
+
+void mgui_timer_process( uint32 ticks )
+{
+	MGuiElement* element;
+	uint32 i, steps, slot;
+	int32 diff;
+
+	if ( num_timers == 0 )
+	{
+		current_slot = ticks >> TIMER_WHEEL_SHIFT;
+		return;
+	}
+
+	// Visit every slot that has passed since the last call, including the current one.
+	diff = (int32)( ( ticks >> TIMER_WHEEL_SHIFT ) - current_slot );
+	steps = diff < 0 ? 1 : math_min( (uint32)diff + 1, TIMER_WHEEL_SLOTS );
+
+	for ( i = 0; i < steps; i++ )
+	{
+		slot = ( current_slot + i ) & TIMER_WHEEL_MASK;
+
+		// A slot may also contain timers for the following revolutions of the wheel, so the
+		// deadlines have to be checked. The list is rescanned after every callback because
+		// the callback is free to schedule or cancel timers, or even destroy elements.
+		for ( ;; )
+		{
+			for ( element = wheel[slot]; element != NULL; element = element->timer_next )
+			{
+				if ( (int32)( element->timer - ticks ) <= 0 ) break;
+			}
+
+			if ( element == NULL ) break;
+
+			mgui_timer_unlink( element );
+
+			MGUI_STATS_INC( elements_processed );
+			element->callbacks->process( element );
+		}
+	}
+
+	current_slot = ticks >> TIMER_WHEEL_SHIFT;
+}
+
+uint32 mgui_timer_get_next_wakeup( uint32 ticks )
+{
+	MGuiElement* element;
+	uint32 i, next;
+	int32 diff, end;
+
+	if ( num_timers == 0 ) return MGUI_WAIT_INFINITE;
+
+	next = MGUI_WAIT_INFINITE;
+
+	// Start from the last processed slot, there may be expired timers that haven't been processed yet.
+	for ( i = 0; i < TIMER_WHEEL_SLOTS; i++ )
+	{
+		for ( element = wheel[( current_slot + i ) & TIMER_WHEEL_MASK]; element != NULL; element = element->timer_next )
+		{
+			diff = (int32)( element->timer - ticks );
+
+			if ( diff <= 0 ) return 0;
+			next = math_min( next, (uint32)diff );
+		}
+
+		// Every timer in the remaining slots expires after this slot has ended.
+		end = (int32)( ( ( current_slot + i + 1 ) << TIMER_WHEEL_SHIFT ) - ticks );
+
+		if ( end > 0 && next < (uint32)end )
+			break;
+	}
+
+	return next;
+}
+
+static void mgui_timer_unlink( MGuiElement* element )
+{
+	if ( element->timer_prev != NULL )
+		element->timer_prev->timer_next = element->timer_next;
+	else
+		wheel[( element->timer >> TIMER_WHEEL_SHIFT ) & TIMER_WHEEL_MASK] = element->timer_next;
+
+	if ( element->timer_next != NULL )
+		element->timer_next->timer_prev = element->timer_prev;
+
+	element->timer_next = NULL;
+	element->timer_prev = NULL;
+	element->flags_int &= ~INTFLAG_TIMER;
+
+	num_timers--;
+}
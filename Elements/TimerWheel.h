@@ -0,0 +1,26 @@
+/**
+ *
+ * @file		TimerWheel.h
+ * @copyright	Tuomo Jauhiainen 2012-2014
+ * @licence		See Licence.txt
+ * @brief		Element timer scheduling.
+ *
+ * @details		A timer wheel used to call the process callback of an element when its deadline has passed.
+ *
+ **/
+
+#pragma once
+#ifndef __MGUI_TIMERWHEEL_H
+#define __MGUI_TIMERWHEEL_H
+
+#include "Element.h"
+
+#define TIMER_WHEEL_SLOTS	64	///< Number of slots in the timer wheel (a power of two)
+#define TIMER_WHEEL_SHIFT	4	///< Each slot covers 1 << TIMER_WHEEL_SHIFT milliseconds
+
+void		mgui_timer_set					( MGuiElement* element, uint32 delay );
+void		mgui_timer_cancel				( MGuiElement* element );
+void		mgui_timer_process				( uint32 ticks );
+uint32		mgui_timer_get_next_wakeup		( uint32 ticks );
+
+#endif /* __MGUI_TIMERWHEEL_H */
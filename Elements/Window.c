@@ -12,6 +12,7 @@
 #include "Window.h"
 #include "WindowButton.h"
 #include "WindowTitlebar.h"
+#include "HitGrid.h"
 #include "Renderer.h"
 #include "Skin.h"
 #include "Font.h"
@@ -74,7 +75,7 @@ MGuiWindow* mgui_create_window( MGuiElement* parent )
 	struct MGuiWindow* window;
 	extern MGuiFont* default_font;
 
-	window = mem_alloc_clean( sizeof(*window) );
+	window = mgui_element_alloc( GUI_WINDOW, sizeof(*window) );
 	mgui_element_create( cast_elem(window), parent );
 
 	window->flags |= (FLAG_BORDER|FLAG_SHADOW|FLAG_BACKGROUND|FLAG_WINDOW_TITLEBAR|FLAG_WINDOW_CLOSEBTN|FLAG_MOUSECTRL|FLAG_DRAGGABLE|FLAG_WINDOW_RESIZABLE);
@@ -264,6 +265,8 @@ static void mgui_window_on_flags_change( MGuiElement* window, uint32 old )
 		}
 	}
 
+	// The titlebar or the close button may have been added or removed.
+	mgui_hitgrid_invalidate( window );
 	mgui_element_request_redraw( window );
 }
 
@@ -308,7 +311,8 @@ static void mgui_window_on_mouse_release( MGuiElement* window, int16 x, int16 y,
 {
 	struct MGuiWindow* wnd;
 	MGuiEvent event;
-	node_t* node;
+	uint32 i;
+	rectangle_t r;
 
 	wnd = (struct MGuiWindow*)window;
 
@@ -316,6 +320,14 @@ static void mgui_window_on_mouse_release( MGuiElement* window, int16 x, int16 y,
 
 	if ( wnd->resize_flags == 0 ) return;
 
+	// Get rid of the resize rectangle and whatever the window used to cover.
+	r.x = wnd->window_bounds.x;
+	r.y = wnd->window_bounds.y;
+	r.w = math_max( wnd->window_bounds.w, wnd->resize_rect.w );
+	r.h = math_max( wnd->window_bounds.h, wnd->resize_rect.h );
+
+	mgui_element_request_redraw_rect( &r );
+
 	x = wnd->window_bounds.w + ( ( wnd->resize_flags & RESIZE_HORIZ ) ? x - wnd->click_offset.x : 0 );
 	y = wnd->window_bounds.h + ( ( wnd->resize_flags & RESIZE_VERT ) ? y - wnd->click_offset.y : 0 );
 
@@ -327,6 +339,7 @@ static void mgui_window_on_mouse_release( MGuiElement* window, int16 x, int16 y,
 
 	mgui_window_on_bounds_change( window, false, true );
 	mgui_element_request_redraw( window );
+	mgui_hitgrid_update( window );
 
 	if ( wnd->flags & FLAG_CACHE_TEXTURE )
 		mgui_element_resize_cache( window );
@@ -344,27 +357,38 @@ static void mgui_window_on_mouse_release( MGuiElement* window, int16 x, int16 y,
 		window->event_handler( &event );
 	}
 
-	if ( wnd->children == NULL ) return;
+	if ( wnd->num_children == 0 ) return;
 
-	list_foreach( wnd->children, node )
+	for ( i = 0; i < wnd->num_children; i++ )
 	{
-		mgui_element_update_rel_pos( cast_elem(node) );
+		mgui_element_update_rel_pos( wnd->children[i] );
 	}
 }
 
 static void mgui_window_on_mouse_drag( MGuiElement* window, int16 x, int16 y )
 {
 	struct MGuiWindow* wnd = (struct MGuiWindow*)window;
+	rectangle_t r;
 
 	if ( wnd->resize_flags == 0 ) return;
 
 	x = wnd->window_bounds.w + ( ( wnd->resize_flags & RESIZE_HORIZ ) ? x - wnd->click_offset.x : 0 );
 	y = wnd->window_bounds.h + ( ( wnd->resize_flags & RESIZE_VERT ) ? y - wnd->click_offset.y : 0 );
 
+	// The resize rectangle may extend outside the window, so redraw the area
+	// covered by both the old and the new rectangle.
+	r.x = wnd->window_bounds.x;
+	r.y = wnd->window_bounds.y;
+	r.w = math_max( wnd->window_bounds.w, wnd->resize_rect.w );
+	r.h = math_max( wnd->window_bounds.h, wnd->resize_rect.h );
+
 	wnd->resize_rect.w = ( x < wnd->min_size.w ) ? wnd->min_size.w : x;
 	wnd->resize_rect.h = ( y < wnd->min_size.h ) ? wnd->min_size.h : y;
 
-	mgui_element_request_redraw_all();
+	r.w = math_max( r.w, wnd->resize_rect.w );
+	r.h = math_max( r.h, wnd->resize_rect.h );
+
+	mgui_element_request_redraw_rect( &r );
 }
 
 /**
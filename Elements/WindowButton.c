@@ -12,6 +12,7 @@
 #include "WindowButton.h"
 #include "WindowTitlebar.h"
 #include "Window.h"
+#include "DrawList.h"
 #include "Skin.h"
 #include "InputHook.h"
 #include "Input/Input.h"
@@ -57,7 +58,7 @@ MGuiWindowButton* mgui_create_windowbutton( MGuiWindow* parent )
 	MGuiWindowButton* button;
 	extern MGuiFont* wndbutton_font; // Font used for the close button X
 
-	button = mem_alloc_clean( sizeof(*button) );
+	button = mgui_element_alloc( GUI_WINDOWBUTTON, sizeof(*button) );
 	button->flags_int = INTFLAG_NOPARENT;
 
 	mgui_element_create( cast_elem(button), NULL );
@@ -159,6 +160,7 @@ static void mgui_windowbutton_on_mouse_release( MGuiElement* button, int16 x, in
 	if ( btn->window == NULL ) return;
 	
 	btn->window->flags &= ~FLAG_VISIBLE;
+	mgui_drawlist_invalidate( cast_elem(btn->window) );
 
 	if ( btn->window->event_handler )
 	{
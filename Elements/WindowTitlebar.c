@@ -11,6 +11,7 @@
 
 #include "WindowTitlebar.h"
 #include "InputHook.h"
+#include "HitGrid.h"
 #include "Skin.h"
 #include "Font.h"
 #include "Platform/Alloc.h"
@@ -52,7 +53,7 @@ MGuiTitlebar* mgui_create_titlebar( MGuiWindow* parent )
 {
 	MGuiTitlebar* titlebar;
 
-	titlebar = mem_alloc_clean( sizeof(*titlebar) );
+	titlebar = mgui_element_alloc( GUI_TITLEBAR, sizeof(*titlebar) );
 	titlebar->flags_int = INTFLAG_NOTEXT|INTFLAG_NOPARENT;
 
 	mgui_element_create( cast_elem(titlebar), NULL );
@@ -105,21 +106,27 @@ static void mgui_titlebar_on_mouse_drag( MGuiElement* element, int16 x, int16 y
 {
 	MGuiTitlebar* titlebar;
 	struct MGuiWindow* window;
-	node_t* node;
+	uint32 i;
 	MGuiEvent event;
+	rectangle_t old;
 
 	titlebar = (MGuiTitlebar*)element;
 	window = (struct MGuiWindow*)titlebar->window;
 
 	if ( window == NULL ) return;
 
-	mgui_element_request_redraw_all();
+	old = window->window_bounds;
 
 	window->bounds.x = x - window->click_offset.x;
 	window->bounds.y = y - window->click_offset.y;
 
 	window->callbacks->on_bounds_change( cast_elem(window), true, false );
 
+	// Redraw the area the window was dragged from and the area it was dragged to.
+	mgui_element_request_redraw_rect( &old );
+	mgui_element_request_redraw_rect( &window->window_bounds );
+	mgui_hitgrid_update( cast_elem(window) );
+
 	if ( window->event_handler )
 	{
 		event.type = EVENT_DRAG;
@@ -131,10 +138,10 @@ static void mgui_titlebar_on_mouse_drag( MGuiElement* element, int16 x, int16 y
 		window->event_handler( &event );
 	}
 
-	if ( window->children == NULL ) return;
+	if ( window->num_children == 0 ) return;
 
-	list_foreach( window->children, node )
+	for ( i = 0; i < window->num_children; i++ )
 	{
-		mgui_element_update_abs_pos( cast_elem(node) );
+		mgui_element_update_abs_pos( window->children[i] );
 	}
 }
@@ -12,6 +12,7 @@
 #include "InputHook.h"
 #include "Element.h"
 #include "Renderer.h"
+#include "TimerWheel.h"
 #include "WindowTitlebar.h"
 
 // --------------------------------------------------
@@ -23,6 +24,7 @@ static bool		mgui_input_handle_mouse_move	( InputEvent* event );
 static bool		mgui_input_handle_mouse_wheel	( InputEvent* event );
 static bool		mgui_input_handle_lmb_up		( InputEvent* event );
 static bool		mgui_input_handle_lmb_down		( InputEvent* event );
+static void		mgui_input_process_mouse_move	( void );
 
 // --------------------------------------------------
 
@@ -31,6 +33,9 @@ static MGuiElement*	pressed		= NULL; // Element being pressed down currently
 static MGuiElement*	dragged		= NULL;	// Element that is being dragged
 static MGuiElement*	mousefocus	= NULL; // The element that has the mouse focus
 static MGuiElement*	kbfocus		= NULL;	// The element that has the keyboard focus
+static bool			move_queued	= false;	// There is a mouse move event waiting to be processed
+static int16		move_x		= 0;	// Latest cursor position of the queued mouse move
+static int16		move_y		= 0;
 
 // --------------------------------------------------
 
@@ -65,6 +70,12 @@ void mgui_input_cleanup_references( MGuiElement* element )
 	if ( element == kbfocus ) kbfocus = NULL;
 }
 
+void mgui_input_process( void )
+{
+	// Resolve the hovered element once per frame, using the latest cursor position.
+	mgui_input_process_mouse_move();
+}
+
 /**
  * @brief Returns the element that has keyboard focus.
  *
@@ -118,6 +129,9 @@ void mgui_set_focus( MGuiElement* element )
 		kbfocus = element;
 		element->flags_int |= INTFLAG_FOCUS;
 
+		// Start the animations of the element, if it has any.
+		mgui_timer_set( element, 0 );
+
 		mgui_element_request_redraw( kbfocus );
 
 		if ( kbfocus->event_handler )
@@ -133,6 +147,9 @@ void mgui_set_focus( MGuiElement* element )
 
 static bool mgui_input_handle_char( InputEvent* event )
 {
+	// Any queued mouse movement happened before this event.
+	mgui_input_process_mouse_move();
+
 	if ( kbfocus && kbfocus->callbacks->on_character )
 	{
 		return kbfocus->callbacks->on_character( kbfocus, (char_t)event->keyboard.key );
@@ -143,6 +160,8 @@ static bool mgui_input_handle_char( InputEvent* event )
 
 static bool mgui_input_handle_key_up( InputEvent* event )
 {
+	mgui_input_process_mouse_move();
+
 	if ( kbfocus && kbfocus->callbacks->on_key_press )
 	{
 		return kbfocus->callbacks->on_key_press( kbfocus, event->keyboard.key, false );
@@ -153,6 +172,8 @@ static bool mgui_input_handle_key_up( InputEvent* event )
 
 static bool mgui_input_handle_key_down( InputEvent* event )
 {
+	mgui_input_process_mouse_move();
+
 	if ( kbfocus && kbfocus->callbacks->on_key_press )
 	{
 		return kbfocus->callbacks->on_key_press( kbfocus, event->keyboard.key, true );
@@ -162,13 +183,28 @@ static bool mgui_input_handle_key_down( InputEvent* event )
 }
 
 static bool mgui_input_handle_mouse_move( InputEvent* event )
+{
+	// Consecutive moves are merged into one, which is processed when something
+	// else happens or at the latest when the next frame is processed.
+	move_x = event->mouse.x;
+	move_y = event->mouse.y;
+	move_queued = true;
+
+	return true;
+}
+
+static void mgui_input_process_mouse_move( void )
 {
 	int16 x, y;
 	MGuiElement* element;
 	MGuiEvent guievent;
 
-	x = event->mouse.x;
-	y = event->mouse.y;
+	if ( !move_queued ) return;
+
+	move_queued = false;
+
+	x = move_x;
+	y = move_y;
 
 	if ( dragged && dragged->callbacks->on_mouse_drag )
 		dragged->callbacks->on_mouse_drag( dragged, x, y );
@@ -179,7 +215,7 @@ static bool mgui_input_handle_mouse_move( InputEvent* event )
 		if ( hovered && hovered->callbacks->on_mouse_move )
 			hovered->callbacks->on_mouse_move( hovered, x, y );
 
-		return true;
+		return;
 	}
 
 	if ( hovered )
@@ -219,13 +255,13 @@ static bool mgui_input_handle_mouse_move( InputEvent* event )
 			hovered->event_handler( &guievent );
 		}
 	}
-
-	return true;
 }
 
 static bool mgui_input_handle_mouse_wheel( InputEvent* event )
 {
 	UNREFERENCED_PARAM( event );
+
+	mgui_input_process_mouse_move();
 	return true;
 }
 
@@ -234,6 +270,8 @@ static bool mgui_input_handle_lmb_up( InputEvent* event )
 	int16 x, y;
 	MGuiEvent guievent;
 
+	mgui_input_process_mouse_move();
+
 	x = event->mouse.x;
 	y = event->mouse.y;
 
@@ -269,6 +307,8 @@ static bool mgui_input_handle_lmb_down( InputEvent* event )
 	MGuiElement* element;
 	MGuiEvent guievent;
 
+	mgui_input_process_mouse_move();
+
 	x = event->mouse.x;
 	y = event->mouse.y;
 
@@ -348,6 +388,8 @@ static bool mgui_input_handle_lmb_down( InputEvent* event )
 			kbfocus = pressed;
 			pressed->flags_int |= INTFLAG_FOCUS;
 
+			mgui_timer_set( pressed, 0 );
+
 			if ( kbfocus->event_handler )
 			{
 				guievent.type = EVENT_FOCUS_ENTER;
@@ -19,5 +19,6 @@
 void			mgui_input_initialize_hooks		( void );
 void			mgui_input_shutdown_hooks		( void );
 void			mgui_input_cleanup_references	( MGuiElement* element );
+void			mgui_input_process				( void );
 
 #endif /* __MYLLY_GUI_INPUTHOOK_H */
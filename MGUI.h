@@ -45,6 +45,8 @@ MGUI_ELEMENT_DECL( MGuiWindow );
 #define cast_elem(x) ((MGuiElement*)x)
 #define cast_node(x) ((node_t*)x)
 
+#define MGUI_WAIT_INFINITE ((uint32)-1)	///< Returned by @ref mgui_get_next_wakeup when there is nothing scheduled
+
 /**
  * @brief Mylly GUI initialization parameters.
  * @sa mgui_initialize
@@ -223,7 +225,8 @@ typedef struct {
 	MGUI_EVENT		type;		///< Type of the event (@ref MGUI_EVENT)
 	MGuiElement*	element;	///< The element which triggered this event
 	void*			data;		///< User specified data
-	MGuiListboxItem* item;		///< Selected listbox item
+	MGuiListboxItem* item;		///< Selected listbox item (NULL if the listbox is virtual)
+	uint32			row;		///< Index of the selected row
 } MGuiListEvent;
 
 /**
@@ -295,6 +298,64 @@ typedef void ( *mgui_event_handler_t )( const MGuiEvent* event );
  */
 typedef int ( *mgui_listbox_sort_t )( const MGuiListboxItem* item1, const MGuiListboxItem* item2 );
 
+/**
+ * @brief Virtual listbox data provider.
+ *
+ * @details This is the prototype for a function that provides the
+ * text of a single row to a virtual listbox. The provider is only
+ * called for the rows that are visible. The returned text can contain
+ * format tags if @ref FLAG_TEXT_TAGS is enabled, and it is copied by
+ * the listbox.
+ *
+ * @param listbox The listbox requesting the text
+ * @param row Index of the row
+ * @param data User specified data
+ * @returns Text of the row, or NULL if the row should be left empty
+ * @sa mgui_listbox_set_virtual
+ */
+typedef const char_t* ( *mgui_listbox_provider_t )( MGuiListbox* listbox, uint32 row, void* data );
+
+/**
+ * @brief Statistics of a single frame.
+ *
+ * @details This struct contains the amount of work done by MGUI during
+ * a single frame (from one @ref mgui_process call to the next). The statistics
+ * are only collected if the library has been built with MGUI_ENABLE_STATS defined.
+ *
+ * @sa mgui_get_frame_stats, mgui_set_frame_stats_callback
+ */
+typedef struct MGuiFrameStats {
+	uint32	elements_visited;	///< Number of elements visited while rendering
+	uint32	elements_rendered;	///< Number of elements actually drawn
+	uint32	elements_processed;	///< Number of elements processed (expired timers)
+	uint32	draw_rect;			///< Number of draw_rect calls
+	uint32	draw_triangle;		///< Number of draw_triangle calls
+	uint32	draw_pixel;			///< Number of draw_pixel calls
+	uint32	draw_textured_rect;	///< Number of draw_textured_rect calls
+	uint32	draw_text;			///< Number of draw_text calls
+	uint32	draw_render_target;	///< Number of draw_render_target calls
+	uint32	measure_text;		///< Number of measure_text calls
+	uint32	clip_changes;		///< Number of times the clip region was changed
+	uint32	target_switches;	///< Number of render target switches
+	uint32	cache_refreshes;	///< Number of element cache textures redrawn
+	uint32	time_input;			///< Time spent processing input, in microseconds
+	uint32	time_process;		///< Time spent processing elements and layout, in microseconds
+	uint32	time_render;		///< Time spent rendering, in microseconds
+	uint32	time_pre_process;	///< Time spent refreshing cache textures, in microseconds
+} MGuiFrameStats;
+
+/**
+ * @brief Frame statistics callback.
+ *
+ * @details A user specified function that is called at the end of every frame
+ * when frame statistics are enabled.
+ *
+ * @param stats Statistics of the frame that just ended
+ * @param data User specified data
+ * @sa mgui_set_frame_stats_callback
+ */
+typedef void ( *mgui_frame_stats_callback_t )( const MGuiFrameStats* stats, void* data );
+
 
 __BEGIN_DECLS
 
@@ -308,8 +369,16 @@ MGUI_EXPORT void	mgui_pre_process			( void );
 MGUI_EXPORT void	mgui_process				( void );
 MGUI_EXPORT void	mgui_force_redraw			( void );
 MGUI_EXPORT void	mgui_resize					( uint16 width, uint16 height );
+MGUI_EXPORT void	mgui_begin_update			( void );
+MGUI_EXPORT void	mgui_end_update				( void );
+MGUI_EXPORT uint32	mgui_get_next_wakeup		( void );
+MGUI_EXPORT void	mgui_get_frame_stats		( MGuiFrameStats* stats );
+MGUI_EXPORT void	mgui_set_frame_stats_callback ( mgui_frame_stats_callback_t callback, void* data );
 MGUI_EXPORT void	mgui_set_renderer			( MGuiRenderer* renderer );
 MGUI_EXPORT void	mgui_set_skin				( const char_t* skinimg );
+MGUI_EXPORT void	mgui_set_texture_budget		( uint32 bytes );
+MGUI_EXPORT void	mgui_set_texture_cache		( bool enabled );
+MGUI_EXPORT void	mgui_set_async_loading		( bool enabled );
 
 MGUI_EXPORT MGuiElement* mgui_get_focus				( void );
 MGUI_EXPORT void	mgui_set_focus				( MGuiElement* element );
@@ -475,6 +544,11 @@ MGUI_EXPORT void			mgui_listbox_get_selected_colour	( MGuiListbox* listbox, colo
 MGUI_EXPORT void			mgui_listbox_set_selected_colour	( MGuiListbox* listbox, const colour_t* col );
 MGUI_EXPORT uint32			mgui_listbox_get_selected_colour_i	( MGuiListbox* listbox );
 MGUI_EXPORT void			mgui_listbox_set_selected_colour_i	( MGuiListbox* listbox, uint32 hex );
+MGUI_EXPORT void			mgui_listbox_set_virtual			( MGuiListbox* listbox, uint32 rows, mgui_listbox_provider_t provider, void* data );
+MGUI_EXPORT void			mgui_listbox_set_row_count			( MGuiListbox* listbox, uint32 rows );
+MGUI_EXPORT void			mgui_listbox_refresh_rows			( MGuiListbox* listbox );
+MGUI_EXPORT uint32			mgui_listbox_get_selected_row		( MGuiListbox* listbox );
+MGUI_EXPORT void			mgui_listbox_set_selected_row		( MGuiListbox* listbox, uint32 row );
 
 /** @}
  *  @defgroup memobox Memobox functions
@@ -12,6 +12,13 @@
 #include "MGUI.h"
 #include "Element.h"
 #include "Texture.h"
+#include "Loader.h"
+#include "Damage.h"
+#include "HitGrid.h"
+#include "DrawList.h"
+#include "Pool.h"
+#include "TimerWheel.h"
+#include "Stats.h"
 #include "Renderer.h"
 #include "SkinSimple.h"
 #include "SkinTextured.h"
@@ -19,6 +26,7 @@
 #include "Platform/Timer.h"
 #include "Platform/Window.h"
 #include "InputHook.h"
+#include <string.h>
 
 // --------------------------------------------------
 
@@ -36,11 +44,15 @@ bool				redraw_cache	= false;	// An element has requested a cache redraw
 list_t*				layers			= NULL;		// A list of rendered layers
 uint32				tick_count		= 0;		// Current tick count
 uint32				params			= 0;		// The parameters MGUI was initialized with
+uint32				update_depth	= 0;		// Number of open layout transactions
 
 // --------------------------------------------------
 
 static void mgui_initialize_elements( void );
 static void mgui_invalidate_elements( void );
+static void mgui_initialize_resources( uint32 resources );
+static void mgui_invalidate_resources( uint32 resources );
+static void mgui_resolve_layout( void );
 
 // --------------------------------------------------
 
@@ -52,7 +64,9 @@ static void mgui_invalidate_elements( void );
  * You can use this function to hook user input automatically, or force
  * MGUI to redraw the window only when there is something new to draw.
  *
- * @param wndhandle A handle to the window that MGUI will draw to (HWND on Windows, syswindow_t on linux - see Lib-Platform)
+ * @param wndhandle A handle to the window that MGUI will draw to (HWND on Windows, syswindow_t on linux - see Lib-Platform).
+ * Can be NULL when MGUI is used without a window (headless renderer), the size of the drawing area
+ * should then be set using @ref mgui_resize
  * @param parameters - A bitfield for special initialization parameters (see @ref MGUI_PARAMETERS)
  * @sa MGUI_PARAMETERS
  */
@@ -77,7 +91,8 @@ void mgui_initialize( void* wndhandle, uint32 parameters )
 	params = parameters;
 
 	// Get the initial size of the window.
-	get_window_drawable_size( wndhandle, &draw_size.ux, &draw_size.uy );
+	if ( wndhandle != NULL )
+		get_window_drawable_size( wndhandle, &draw_size.ux, &draw_size.uy );
 
 	draw_rect.x = 0;
 	draw_rect.y = 0;
@@ -123,9 +138,15 @@ void mgui_shutdown( void )
 
 	SAFE_DELETE( skin );
 
+	// Wait for the background loads to finish before the resources are destroyed.
+	mgui_loader_shutdown();
+
 	mgui_fontmgr_shutdown();
 	mgui_texturemgr_shutdown();
 
+	// All the elements are gone now, release the memory pools they were allocated from.
+	mgui_pool_shutdown_all();
+
 	mgui_input_shutdown_hooks();
 
 	if ( params & MGUI_PROCESS_INPUT ||
@@ -148,6 +169,14 @@ void mgui_pre_process( void )
 	node_t* node;
 	MGuiElement* element;
 
+	// Finalize the resources which have been loaded in the background.
+	mgui_loader_process();
+
+	// Apply layout changes first, they may have invalidated some of the caches.
+	MGUI_STATS_BEGIN( STATS_PHASE_PROCESS );
+	mgui_resolve_layout();
+	MGUI_STATS_END( STATS_PHASE_PROCESS );
+
 	// Do we have cached textures to refresh?
 	if ( !redraw_cache )
 		return;
@@ -156,6 +185,8 @@ void mgui_pre_process( void )
 	if ( renderer == NULL || layers == NULL )
 		return;
 
+	MGUI_STATS_BEGIN( STATS_PHASE_PRE_PROCESS );
+
 	renderer->begin();
 	renderer->set_draw_mode( DRAWING_2D );
 
@@ -172,6 +203,8 @@ void mgui_pre_process( void )
 
 	renderer->end();
 	redraw_cache = false;
+
+	MGUI_STATS_END( STATS_PHASE_PRE_PROCESS );
 }
 
 /**
@@ -185,21 +218,65 @@ void mgui_process( void )
 {
 	node_t* node;
 	MGuiElement* element;
+	const rectangle_t* rects;
+	uint32 num_rects;
+	bool damaged;
+
+	MGUI_STATS_BEGIN( STATS_PHASE_INPUT );
 
 	if ( params & MGUI_PROCESS_INPUT )
 		process_window_messages( system_window, input_process );
 
 	else if ( params & MGUI_HOOK_INPUT )
 		input_process( NULL );
+
+	// Process the mouse movement that has been queued since the last frame.
+	mgui_input_process();
+
+	MGUI_STATS_END( STATS_PHASE_INPUT );
 	
 	tick_count = get_tick_count();
 
 	if ( renderer == NULL || layers == NULL )
 		return;
+
+	MGUI_STATS_BEGIN( STATS_PHASE_PROCESS );
+
+	// Finalize the resources which have been loaded in the background.
+	mgui_loader_process();
+
+	// Only the elements whose timers have expired need processing.
+	mgui_timer_process( tick_count );
+
+	// Make sure the layout is up to date before drawing anything.
+	mgui_resolve_layout();
+
+	MGUI_STATS_END( STATS_PHASE_PROCESS );
 	
-	// Redraw the scene, process and render all elements.
+	// Redraw the scene, render all elements.
 	if ( redraw_all )
 	{
+		MGUI_STATS_BEGIN( STATS_PHASE_RENDER );
+
+		damaged = BIT_ON( params, MGUI_USE_DRAW_EVENT ) &&
+				  BIT_ON( renderer->properties, REND_SUPPORTS_DAMAGE );
+
+		// Redraw only the parts of the window that have actually changed, if possible.
+		mgui_damage_begin_frame( damaged );
+
+		// Everything damaged so far is drawn during this frame, only damage added from now on needs another one.
+		refresh_all = false;
+
+		// Tell the renderer that this scene draws to the screen (an empty list means the whole screen).
+		if ( BIT_ON( renderer->properties, REND_SUPPORTS_DAMAGE ) )
+		{
+			num_rects = mgui_damage_get_rects( &rects );
+			renderer->set_damage_rects( rects, num_rects );
+		}
+
+		// Find out which layers are covered by opaque layers on top of them.
+		mgui_drawlist_begin_frame();
+
 		renderer->begin();
 		
 		list_foreach( layers, node )
@@ -207,25 +284,14 @@ void mgui_process( void )
 			element = cast_elem(node);
 
 			if ( element->flags & FLAG_VISIBLE )
-			{
-				mgui_element_render( element );
-				mgui_element_process( element );
-			}
+				mgui_drawlist_render( element );
 		}
 
 		renderer->end();
-	}
 
-	// Do processing only, don't render anything.
-	else
-	{
-		list_foreach( layers, node )
-		{
-			element = cast_elem(node);
+		mgui_damage_end_frame();
 
-			if ( element->flags & FLAG_VISIBLE )
-				mgui_element_process( element );
-		}
+		MGUI_STATS_END( STATS_PHASE_RENDER );
 	}
 
 	if ( params & MGUI_USE_DRAW_EVENT )
@@ -243,6 +309,8 @@ void mgui_process( void )
 			refresh_all = false;
 		}
 	}
+
+	MGUI_STATS_END_FRAME();
 }
 
 /**
@@ -256,6 +324,7 @@ void mgui_process( void )
  */
 void mgui_force_redraw( void )
 {
+	mgui_damage_add_all();
 	redraw_all = true;
 }
 
@@ -286,10 +355,16 @@ void mgui_set_renderer( MGuiRenderer* rend )
 		renderer_data = *rend;
 		renderer = &renderer_data;
 
+		// Count the renderer calls when collecting frame statistics.
+		MGUI_STATS_HOOK_RENDERER( renderer );
+
 		// Initialize everything with the new renderer.
 		mgui_texturemgr_initialize_all();
 		mgui_fontmgr_initialize_all();
 		mgui_initialize_elements();
+
+		// The new renderer has nothing drawn yet.
+		mgui_damage_add_all();
 	}
 	else
 	{
@@ -322,6 +397,170 @@ void mgui_set_skin( const char_t* skinimg )
 		skin = defskin;
 }
 
+/**
+ * @brief Sets the memory budget for textures.
+ *
+ * @details When a texture is no longer used by anything, it is kept in memory
+ * in case it's needed again later. Once the textures use more memory than the
+ * budget allows, the unused textures are destroyed, the least recently used one first.
+ * Textures which are still being used are never destroyed. The default budget is 0,
+ * which means that unused textures are destroyed right away.
+ *
+ * @param bytes The amount of memory the textures are allowed to use, in bytes
+ */
+void mgui_set_texture_budget( uint32 bytes )
+{
+	mgui_texturemgr_set_budget( bytes );
+}
+
+/**
+ * @brief Enables or disables caching of texture pixels.
+ *
+ * @details When enabled, the decoded pixels of each texture are kept in memory,
+ * so the textures can be re-created without reading the image files again when
+ * the renderer is changed or reset. The cached pixels count towards the texture
+ * memory budget. This requires a renderer which supports creating textures from pixels.
+ *
+ * @param enabled true to keep the pixels in memory, false to release them
+ */
+void mgui_set_texture_cache( bool enabled )
+{
+	mgui_texturemgr_set_cache( enabled );
+}
+
+/**
+ * @brief Enables or disables asynchronous resource loading.
+ *
+ * @details When enabled, image files are read and decoded and fonts are rasterized
+ * on a background thread. The resources are finalized when @ref mgui_pre_process
+ * or @ref mgui_process is called, until then the elements using them are drawn
+ * without them. Textures require a renderer which supports creating textures from
+ * pixels, fonts a renderer which sets REND_THREADED_FONTS. Everything else is
+ * still loaded right away.
+ *
+ * @param enabled true to load resources in the background, false to load them right away
+ */
+void mgui_set_async_loading( bool enabled )
+{
+	mgui_loader_set_enabled( enabled );
+}
+
+/**
+ * @brief Starts a layout transaction.
+ *
+ * @details This function starts a batch of layout changes. Until the
+ * transaction is committed using @ref mgui_end_update, changing the position,
+ * size or text of an element only records the change. The layout is then
+ * resolved once, top-down, when the transaction is committed or at the latest
+ * when @ref mgui_process is called. Transactions can be nested, the changes
+ * are applied when the outermost transaction ends.
+ *
+ * @sa mgui_end_update
+ */
+void mgui_begin_update( void )
+{
+	update_depth++;
+}
+
+/**
+ * @brief Commits a layout transaction.
+ *
+ * @details This function ends a batch of layout changes started with
+ * @ref mgui_begin_update. When the outermost transaction ends, all the recorded
+ * changes are applied: every changed element is repositioned, its text
+ * is measured and its callbacks are called only once.
+ *
+ * @sa mgui_begin_update
+ */
+void mgui_end_update( void )
+{
+	if ( update_depth == 0 ) return;
+
+	if ( --update_depth == 0 )
+		mgui_resolve_layout();
+}
+
+/**
+ * @brief Returns the time until MGUI needs to be processed again.
+ *
+ * @details This function returns the number of milliseconds until
+ * the next element timer (cursor blinking, scrollbar nudging etc.) expires.
+ * When MGUI has been initialized with @ref MGUI_USE_DRAW_EVENT, the application
+ * can use this value to sleep or wait for input events between frames instead
+ * of calling @ref mgui_process constantly. Input events should still wake the
+ * application up.
+ *
+ * @returns Time until the next call to @ref mgui_process is needed in milliseconds,
+ * 0 if something is waiting to be drawn, or @ref MGUI_WAIT_INFINITE if nothing has been scheduled
+ */
+uint32 mgui_get_next_wakeup( void )
+{
+	uint32 wakeup;
+
+	// There's a scene waiting to be drawn, process it right away.
+	if ( redraw_all || refresh_all )
+		return 0;
+
+	wakeup = mgui_timer_get_next_wakeup( get_tick_count() );
+
+	// Resources are being loaded in the background, check for them every now and then.
+	if ( mgui_loader_is_busy() )
+		wakeup = math_min( wakeup, LOADER_POLL_INTERVAL );
+
+	return wakeup;
+}
+
+/**
+ * @brief Returns the statistics of the last frame.
+ *
+ * @details This function returns the amount of work done by MGUI during
+ * the last complete frame: elements visited and drawn, renderer calls by type,
+ * cache refreshes and the time spent in each phase of the frame. The statistics
+ * are only collected if the library has been built with MGUI_ENABLE_STATS defined,
+ * otherwise every counter will be zero.
+ *
+ * @param stats A pointer to an @ref MGuiFrameStats struct that will receive the statistics
+ */
+void mgui_get_frame_stats( MGuiFrameStats* stats )
+{
+#ifdef MGUI_ENABLE_STATS
+	extern MGuiFrameStats last_frame_stats;
+#endif
+
+	if ( stats == NULL ) return;
+
+#ifdef MGUI_ENABLE_STATS
+	*stats = last_frame_stats;
+#else
+	memset( stats, 0, sizeof(*stats) );
+#endif
+}
+
+/**
+ * @brief Sets a callback for frame statistics.
+ *
+ * @details This function sets a function that will be called at the end of
+ * every frame (at the end of @ref mgui_process) with the statistics of that frame.
+ * The callback is never called if the library has been built without MGUI_ENABLE_STATS.
+ *
+ * @param callback The function to be called, or NULL to disable the callback
+ * @param data User specified data that will be passed to the callback
+ * @sa mgui_frame_stats_callback_t
+ */
+void mgui_set_frame_stats_callback( mgui_frame_stats_callback_t callback, void* data )
+{
+#ifdef MGUI_ENABLE_STATS
+	extern mgui_frame_stats_callback_t frame_stats_callback;
+	extern void* frame_stats_data;
+
+	frame_stats_callback = callback;
+	frame_stats_data = data;
+#else
+	UNREFERENCED_PARAM( callback );
+	UNREFERENCED_PARAM( data );
+#endif
+}
+
 /**
  * @brief Lets MGUI know that the size of the window has changed.
  *
@@ -333,10 +572,10 @@ void mgui_set_skin( const char_t* skinimg )
  */
 void mgui_resize( uint16 width, uint16 height )
 {
-	node_t *node, *node2;
+	node_t* node;
+	uint32 i;
 	MGuiElement* element;
-	MGuiRenderer* tmprend;
-	bool reset;
+	uint32 lost = 0;
 
 	draw_rect.w = draw_size.w = width;
 	draw_rect.h = draw_size.h = height;
@@ -345,38 +584,47 @@ void mgui_resize( uint16 width, uint16 height )
 
 	if ( renderer != NULL )
 	{
-		tmprend = renderer;
-		reset = BIT_ON( renderer->properties, REND_RESET_ON_RESIZE );
+		if ( BIT_ON( renderer->properties, REND_RESET_ON_RESIZE ) )
+		{
+			// The renderer may tell which resources it loses, otherwise everything has to be reloaded.
+			lost = renderer->properties & ( REND_RESET_TARGETS|REND_RESET_TEXTURES|REND_RESET_FONTS );
+
+			if ( lost == 0 )
+				lost = REND_RESET_TARGETS|REND_RESET_TEXTURES|REND_RESET_FONTS;
+		}
 
-		// Invalidate everything (fonts, textures, render caches).
-		if ( reset )
-			mgui_set_renderer( NULL );
+		// Release only the resources that will not survive the reset.
+		mgui_invalidate_resources( lost );
 
 		// Let the renderer know the new window size.
-		tmprend->resize( width, height ); 
+		renderer->resize( width, height );
 
-		// Reinitialize everything (fonts, textures, render caches).
-		if ( reset )
-			mgui_set_renderer( tmprend );
+		// Recreate the lost resources.
+		mgui_initialize_resources( lost );
 	}
 
-	// Update all canvases.
+	// The hit grids have to be resized as well.
+	mgui_hitgrid_invalidate_all();
+
+	// Update all canvases. The changes are collected into a single transaction
+	// so every element is re-laid out only once.
+	mgui_begin_update();
+
 	list_foreach( layers, node )
 	{
 		element = cast_elem(node);
 
 		if ( element->type == GUI_CANVAS )
 		{
-			if ( element->children == NULL ) continue;
-
-			list_foreach( element->children, node2 )
+			for ( i = 0; i < element->num_children; i++ )
 			{
-				mgui_element_update_child_pos( cast_elem(node2) );
+				mgui_element_update_child_pos( element->children[i] );
 			}
-
 		}
 	}
 
+	mgui_end_update();
+
 	mgui_element_request_redraw_all();
 }
 
@@ -437,3 +685,48 @@ static void mgui_invalidate_elements( void )
 		mgui_element_invalidate( cast_elem(node) );
 	}
 }
+
+static void mgui_initialize_resources( uint32 resources )
+{
+	// Recreate the given classes of renderer resources (see REND_RESET_* flags).
+	if ( resources & REND_RESET_TEXTURES )
+		mgui_texturemgr_initialize_all();
+
+	if ( resources & REND_RESET_FONTS )
+		mgui_fontmgr_initialize_all();
+
+	if ( resources & REND_RESET_TARGETS )
+		mgui_initialize_elements();
+}
+
+static void mgui_invalidate_resources( uint32 resources )
+{
+	// Release the given classes of renderer resources (see REND_RESET_* flags).
+	if ( resources & REND_RESET_FONTS )
+		mgui_fontmgr_invalidate_all();
+
+	if ( resources & REND_RESET_TEXTURES )
+		mgui_texturemgr_invalidate_all();
+
+	if ( resources & REND_RESET_TARGETS )
+		mgui_invalidate_elements();
+}
+
+static void mgui_resolve_layout( void )
+{
+	node_t* node;
+	uint32 depth;
+
+	if ( layers == NULL ) return;
+
+	// Resolve the changes outside of the transaction so that they are actually applied.
+	depth = update_depth;
+	update_depth = 0;
+
+	list_foreach( layers, node )
+	{
+		mgui_element_resolve_layout( cast_elem(node) );
+	}
+
+	update_depth = depth;
+}
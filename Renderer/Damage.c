@@ -0,0 +1,216 @@
+/**********************************************************************
+ *
+ * PROJECT:		Mylly GUI
+ * FILE:		Damage.c
+ * LICENCE:		See Licence.txt
+ * PURPOSE:		Dirty rectangle (damage region) tracking.
+ *
+ *				(c) Tuomo Jauhiainen 2012-13
+ *
+ **********************************************************************/
+
+#include "Damage.h"
+
+// --------------------------------------------------
+
+extern rectangle_t draw_rect;
+
+// --------------------------------------------------
+
+static rectangle_t	damage[MAX_DAMAGE_RECTS];				// Areas damaged since the last redraw
+static uint32		num_damage				= 0;			// Number of rectangles in the damage region
+static bool			damage_full				= true;			// The whole window has been damaged
+static rectangle_t	frame_damage[MAX_DAMAGE_RECTS];			// Areas being redrawn during the current frame
+static uint32		num_frame_damage		= 0;			// Number of rectangles being redrawn
+static bool			frame_full				= true;			// The whole window is being redrawn
+
+// --------------------------------------------------
+
+static MYLLY_INLINE bool	mgui_damage_clip		( rectangle_t* rect );
+static MYLLY_INLINE bool	mgui_damage_overlaps	( const rectangle_t* a, const rectangle_t* b );
+static MYLLY_INLINE bool	mgui_damage_contains	( const rectangle_t* a, const rectangle_t* b );
+static MYLLY_INLINE void	mgui_damage_union		( rectangle_t* dst, const rectangle_t* a, const rectangle_t* b );
+static MYLLY_INLINE uint32	mgui_damage_area		( const rectangle_t* rect );
+static MYLLY_INLINE void	mgui_damage_remove		( uint32 index );
+
+// --------------------------------------------------
+
+void mgui_damage_add( const rectangle_t* rect )
+{
+	rectangle_t r, tmp;
+	uint32 i, best;
+	uint32 growth, best_growth;
+
+	if ( damage_full || rect == NULL ) return;
+
+	r = *rect;
+
+	// Ignore areas that are completely outside the window.
+	if ( !mgui_damage_clip( &r ) ) return;
+
+	// Merge the new rectangle with every rectangle it touches. Merging can make
+	// the rectangle touch new ones, so keep going until nothing changes.
+	for ( i = 0; i < num_damage; )
+	{
+		if ( mgui_damage_contains( &damage[i], &r ) )
+			return;
+
+		if ( mgui_damage_overlaps( &damage[i], &r ) )
+		{
+			mgui_damage_union( &r, &r, &damage[i] );
+			mgui_damage_remove( i );
+
+			i = 0;
+			continue;
+		}
+
+		i++;
+	}
+
+	if ( num_damage < MAX_DAMAGE_RECTS )
+	{
+		damage[num_damage++] = r;
+	}
+	else
+	{
+		// Out of rectangles, merge with the one that grows the least.
+		best = 0;
+		best_growth = (uint32)-1;
+
+		for ( i = 0; i < num_damage; i++ )
+		{
+			mgui_damage_union( &tmp, &r, &damage[i] );
+			growth = mgui_damage_area( &tmp ) - mgui_damage_area( &damage[i] );
+
+			if ( growth < best_growth )
+			{
+				best = i;
+				best_growth = growth;
+			}
+		}
+
+		mgui_damage_union( &damage[best], &damage[best], &r );
+		r = damage[best];
+	}
+
+	// If the damage covers the whole window, there's no reason to keep track of it.
+	if ( mgui_damage_contains( &r, &draw_rect ) )
+		mgui_damage_add_all();
+}
+
+void mgui_damage_add_all( void )
+{
+	damage_full = true;
+	num_damage = 0;
+}
+
+void mgui_damage_begin_frame( bool partial )
+{
+	uint32 i;
+
+	// An empty region means that a redraw was requested without telling us where,
+	// so assume the worst and redraw everything.
+	if ( partial && !damage_full && num_damage > 0 )
+	{
+		for ( i = 0; i < num_damage; i++ )
+			frame_damage[i] = damage[i];
+
+		num_frame_damage = num_damage;
+		frame_full = false;
+	}
+	else
+	{
+		num_frame_damage = 0;
+		frame_full = true;
+	}
+
+	// Anything damaged from now on will be drawn during the next frame.
+	damage_full = false;
+	num_damage = 0;
+}
+
+void mgui_damage_end_frame( void )
+{
+	num_frame_damage = 0;
+	frame_full = true;
+}
+
+uint32 mgui_damage_get_rects( const rectangle_t** rects )
+{
+	if ( rects != NULL )
+		*rects = frame_damage;
+
+	return frame_full ? 0 : num_frame_damage;
+}
+
+bool mgui_damage_test( const rectangle_t* rect )
+{
+	uint32 i;
+
+	if ( frame_full ) return true;
+
+	for ( i = 0; i < num_frame_damage; i++ )
+	{
+		if ( mgui_damage_overlaps( &frame_damage[i], rect ) )
+			return true;
+	}
+
+	return false;
+}
+
+static MYLLY_INLINE bool mgui_damage_clip( rectangle_t* rect )
+{
+	int32 x1, y1, x2, y2;
+
+	x1 = math_max( rect->x, draw_rect.x );
+	y1 = math_max( rect->y, draw_rect.y );
+	x2 = math_min( rect->x + rect->w, draw_rect.x + draw_rect.w );
+	y2 = math_min( rect->y + rect->h, draw_rect.y + draw_rect.h );
+
+	if ( x2 <= x1 || y2 <= y1 ) return false;
+
+	rect->x = (int16)x1;
+	rect->y = (int16)y1;
+	rect->w = (uint16)( x2 - x1 );
+	rect->h = (uint16)( y2 - y1 );
+
+	return true;
+}
+
+static MYLLY_INLINE bool mgui_damage_overlaps( const rectangle_t* a, const rectangle_t* b )
+{
+	return ( a->x < b->x + b->w && b->x < a->x + a->w &&
+			 a->y < b->y + b->h && b->y < a->y + a->h );
+}
+
+static MYLLY_INLINE bool mgui_damage_contains( const rectangle_t* a, const rectangle_t* b )
+{
+	return ( b->x >= a->x && b->x + b->w <= a->x + a->w &&
+			 b->y >= a->y && b->y + b->h <= a->y + a->h );
+}
+
+static MYLLY_INLINE void mgui_damage_union( rectangle_t* dst, const rectangle_t* a, const rectangle_t* b )
+{
+	int32 x1, y1, x2, y2;
+
+	x1 = math_min( a->x, b->x );
+	y1 = math_min( a->y, b->y );
+	x2 = math_max( a->x + a->w, b->x + b->w );
+	y2 = math_max( a->y + a->h, b->y + b->h );
+
+	dst->x = (int16)x1;
+	dst->y = (int16)y1;
+	dst->w = (uint16)( x2 - x1 );
+	dst->h = (uint16)( y2 - y1 );
+}
+
+static MYLLY_INLINE uint32 mgui_damage_area( const rectangle_t* rect )
+{
+	return (uint32)rect->w * rect->h;
+}
+
+static MYLLY_INLINE void mgui_damage_remove( uint32 index )
+{
+	// The order of the rectangles doesn't matter, fill the hole with the last one.
+	damage[index] = damage[--num_damage];
+}
@@ -0,0 +1,27 @@
+/**********************************************************************
+ *
+ * PROJECT:		Mylly GUI
+ * FILE:		Damage.h
+ * LICENCE:		See Licence.txt
+ * PURPOSE:		Dirty rectangle (damage region) tracking.
+ *
+ *				(c) Tuomo Jauhiainen 2012-13
+ *
+ **********************************************************************/
+
+#pragma once
+#ifndef __MGUI_DAMAGE_H
+#define __MGUI_DAMAGE_H
+
+#include "MGUI.h"
+#include "Renderer.h"
+
+void		mgui_damage_add				( const rectangle_t* rect );
+void		mgui_damage_add_all			( void );
+
+void		mgui_damage_begin_frame		( bool partial );
+void		mgui_damage_end_frame		( void );
+uint32		mgui_damage_get_rects		( const rectangle_t** rects );
+bool		mgui_damage_test			( const rectangle_t* rect );
+
+#endif /* __MGUI_DAMAGE_H */
@@ -52,7 +52,8 @@ MGuiRenderer* mgui_directx9_initialize( void* wnd )
 	renderer.properties = REND_SUPPORTS_TEXTTAGS |
 						  REND_SUPPORTS_TEXTURES |
 						  REND_SUPPORTS_TARGETS |
-						  REND_RESET_ON_RESIZE;
+						  REND_RESET_ON_RESIZE |
+						  REND_RESET_TARGETS;
 
 	renderer.begin					= CRenderer::Begin;
 	renderer.end					= CRenderer::End;
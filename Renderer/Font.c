@@ -12,19 +12,53 @@
 #include "Font.h"
 #include "Skin.h"
 #include "Renderer.h"
+#include "Loader.h"
+#include "Element.h"
 #include "Stringy/Stringy.h"
 #include "Platform/Alloc.h"
 #include <assert.h>
 
+typedef struct MGuiFontName {
+	struct MGuiFontName* next;	// Next name in the same hash table bucket
+	uint32			hash;		// Hash of the name
+	char_t			name[1];	// The name itself, allocated along with the struct
+} MGuiFontName;
+
+typedef struct MGuiFontJob {
+	MGuiLoadJob;							// Loader job base
+	MGuiFont*		font;					// The font being loaded, NULL if it was destroyed or changed in the meantime
+	const char_t*	name;					// Interned name of the font
+	uint8			size;					// Properties of the font at the time the job was queued
+	uint8			flags;
+	uint8			charset;
+	uint32			first_char;
+	uint32			last_char;
+	MGuiRendFont*	( *load_font )( const char_t* font, uint8 size, uint8 flags, uint8 charset, uint32 firstc, uint32 lastc );
+	MGuiRendFont*	data;					// The loaded font
+} MGuiFontJob;
+
 extern MGuiRenderer* renderer;
 static list_t* fonts;
+static MGuiFont* font_table[FONT_HASH_SIZE];		// Fonts hashed by their properties
+static MGuiFontName* font_names[FONT_HASH_SIZE];	// Interned font names
 
 MGuiFont*			default_font = NULL;	// Default font for all elements
 MGuiFont*			wndbutton_font = NULL;	// Font used for the close button X
 
 static void			mgui_font_destroy_unconditional( MGuiFont* font );
+static void			mgui_font_load			( MGuiFont* font );
+static bool			mgui_font_load_async	( MGuiFont* font );
+static void			mgui_font_job_load		( MGuiLoadJob* job );
+static void			mgui_font_job_finish	( MGuiLoadJob* job );
 static MGuiFont*	mgui_font_find			( const char_t* name, uint8 size, uint8 flags, uint8 charset, char_t firstc, char_t lastc );
+static const char_t* mgui_font_intern_name	( const char_t* name );
+static uint32		mgui_font_hash_name		( const char_t* name );
+static uint32		mgui_font_hash			( const char_t* name, uint8 size, uint8 flags, uint8 charset, char_t firstc, char_t lastc );
+static void			mgui_font_hash_insert	( MGuiFont* font );
+static void			mgui_font_hash_remove	( MGuiFont* font );
 static uint8		mgui_font_get_charset	( uint32 charset );
+static void			mgui_font_build_metrics	( MGuiFont* font );
+static void			mgui_font_free_metrics	( MGuiFont* font );
 
 void mgui_fontmgr_initialize( void )
 {
@@ -37,6 +71,8 @@ void mgui_fontmgr_initialize( void )
 void mgui_fontmgr_shutdown( void )
 {
 	node_t *node, *tmp;
+	MGuiFontName *name, *next;
+	uint32 i;
 
 	list_foreach_safe( fonts, node, tmp )
 	{
@@ -45,6 +81,19 @@ void mgui_fontmgr_shutdown( void )
 
 	list_destroy( fonts );
 	fonts = NULL;
+
+	// The interned names are kept around until the very end.
+	for ( i = 0; i < FONT_HASH_SIZE; i++ )
+	{
+		for ( name = font_names[i]; name != NULL; name = next )
+		{
+			next = name->next;
+			mem_free( name );
+		}
+
+		font_names[i] = NULL;
+		font_table[i] = NULL;
+	}
 }
 
 void mgui_fontmgr_initialize_all( void )
@@ -59,7 +108,7 @@ void mgui_fontmgr_initialize_all( void )
 		font = (MGuiFont*)node;
 
 		if ( font->data == NULL )
-			font->data = renderer->load_font( font->name, font->size, font->flags, mgui_font_get_charset( font->charset ), font->first_char, font->last_char );
+			mgui_font_load( font );
 	}
 }
 
@@ -70,6 +119,9 @@ void mgui_fontmgr_invalidate_all( void )
 
 	if ( renderer == NULL ) return;
 
+	// Fonts still being loaded have to arrive before they can be destroyed.
+	mgui_loader_flush();
+
 	list_foreach( fonts, node )
 	{
 		font = (MGuiFont*)node;
@@ -79,6 +131,8 @@ void mgui_fontmgr_invalidate_all( void )
 			renderer->destroy_font( font->data );
 			font->data = NULL;
 		}
+
+		mgui_font_free_metrics( font );
 	}
 }
 
@@ -90,8 +144,8 @@ MGuiFont* mgui_font_create( const char_t* name, uint8 size, uint8 flags, uint8 c
 MGuiFont* mgui_font_create_range( const char_t* name, uint8 size, uint8 flags, uint8 charset, char_t firstc, char_t lastc )
 {
 	MGuiFont* font;
-	size_t len;
 
+	name = mgui_font_intern_name( name );
 	font = mgui_font_find( name, size, flags, charset, firstc, lastc );
 
 	if ( font && font != default_font && font != wndbutton_font )
@@ -100,10 +154,8 @@ MGuiFont* mgui_font_create_range( const char_t* name, uint8 size, uint8 flags, u
 		return font;
 	}
 	
-	len = mstrsize( name );
-
 	font = (MGuiFont*)mem_alloc_clean( sizeof(*font) );
-	font->name = mem_alloc( len2size(len) );
+	font->name = name;
 	font->size = size;
 	font->flags = flags;
 	font->charset = charset;
@@ -112,12 +164,11 @@ MGuiFont* mgui_font_create_range( const char_t* name, uint8 size, uint8 flags, u
 	font->refcount = 1;
 	font->data = NULL;
 
-	mstrcpy( font->name, name, len );
-
 	if ( renderer != NULL )
-		font->data = renderer->load_font( name, size, flags, mgui_font_get_charset( charset ), firstc, lastc );
+		mgui_font_load( font );
 
 	list_push( fonts, &font->node );
+	mgui_font_hash_insert( font );
 
 	return font;
 }
@@ -136,25 +187,32 @@ static void mgui_font_destroy_unconditional( MGuiFont* font )
 	if ( font == NULL ) return;
 	if ( --(font->refcount) ) return;
 
+	// The result of a background load is thrown away when it arrives.
+	if ( font->job != NULL )
+		font->job->font = NULL;
+
 	if ( font->data != NULL && renderer != NULL )
 		renderer->destroy_font( font->data );
 
-	SAFE_DELETE( font->name );
+	mgui_font_free_metrics( font );
+	mgui_font_hash_remove( font );
 
 	list_remove( fonts, &font->node );
 	mem_free( font );
 }
 
-MGuiFont* mgui_font_find( const char_t* name, uint8 size, uint8 flags, uint8 charset, char_t firstc, char_t lastc )
+static MGuiFont* mgui_font_find( const char_t* name, uint8 size, uint8 flags, uint8 charset, char_t firstc, char_t lastc )
 {
-	node_t* node;
 	MGuiFont* font;
+	uint32 hash;
 
-	list_foreach( fonts, node )
-	{
-		font = (MGuiFont*)node;
+	// The name has to be interned already, so names can be compared by pointer.
+	hash = mgui_font_hash( name, size, flags, charset, firstc, lastc );
 
-		if ( mstrequal( font->name, name ) &&
+	for ( font = font_table[hash % FONT_HASH_SIZE]; font != NULL; font = font->hash_next )
+	{
+		if ( font->hash == hash &&
+			 font->name == name &&
 			 font->size == size &&
 			 font->flags == flags &&
 			 font->charset == charset &&
@@ -170,11 +228,12 @@ MGuiFont* mgui_font_find( const char_t* name, uint8 size, uint8 flags, uint8 cha
 
 MGuiFont* mgui_font_set_font( MGuiFont* font, const char_t* name )
 {
-	size_t len;
 	MGuiFont* fnt;
 
 	if ( font == NULL ) return NULL;
 
+	name = mgui_font_intern_name( name );
+
 	if ( font->refcount > 1 ||
 		 font == default_font ||
 		 font == wndbutton_font )
@@ -199,12 +258,9 @@ MGuiFont* mgui_font_set_font( MGuiFont* font, const char_t* name )
 	}
 
 	// Ok, it seems we're the only ones using this font so it's perfectly safe to modify it
-	if ( font->name )
-		mem_free( font->name );
-
-	len = mstrsize( name );
-	font->name = mem_alloc( len );
-	mstrcpy( font->name, name, len );
+	mgui_font_hash_remove( font );
+	font->name = name;
+	mgui_font_hash_insert( font );
 
 	mgui_font_reinitialize( font );
 
@@ -237,7 +293,10 @@ MGuiFont* mgui_font_set_size( MGuiFont* font, uint8 size )
 		}
 	}
 
+	mgui_font_hash_remove( font );
 	font->size = size;
+	mgui_font_hash_insert( font );
+
 	mgui_font_reinitialize( font );
 
 	return font;
@@ -269,7 +328,10 @@ MGuiFont* mgui_font_set_flags( MGuiFont* font, uint8 flags )
 		}
 	}
 
+	mgui_font_hash_remove( font );
 	font->flags = flags;
+	mgui_font_hash_insert( font );
+
 	mgui_font_reinitialize( font );
 
 	return font;
@@ -301,7 +363,10 @@ MGuiFont* mgui_font_set_charset( MGuiFont* font, uint8 charset )
 		}
 	}
 
+	mgui_font_hash_remove( font );
 	font->charset = charset;
+	mgui_font_hash_insert( font );
+
 	mgui_font_reinitialize( font );
 
 	return font;
@@ -312,9 +377,268 @@ void mgui_font_reinitialize( MGuiFont* font )
 	if ( font == NULL || renderer == NULL ) return;
 
 	if ( font->data )
+	{
 		renderer->destroy_font( font->data );
+		font->data = NULL;
+	}
+
+	// A font with the old properties may still be on its way.
+	if ( font->job != NULL )
+	{
+		font->job->font = NULL;
+		font->job = NULL;
+	}
+
+	// The character widths will be measured again when they're needed.
+	mgui_font_free_metrics( font );
+
+	mgui_font_load( font );
+}
+
+uint32 mgui_font_get_char_width( MGuiFont* font, char_t c )
+{
+	uint32 w, h, ch;
+	char_t tmp[2];
+
+	if ( font == NULL || font->data == NULL || renderer == NULL ) return 0;
+
+	if ( font->advances == NULL )
+		mgui_font_build_metrics( font );
+
+	ch = *(uchar_t*)&c;
+
+	if ( ch >= font->adv_first && ch <= font->adv_last )
+		return font->advances[ch - font->adv_first];
+
+	// The character is not within the range of the font, measure it separately.
+	tmp[0] = c;
+	tmp[1] = '\0';
+
+	renderer->measure_text( font->data, tmp, &w, &h );
+
+	return w;
+}
+
+int32 mgui_font_get_spacing( MGuiFont* font )
+{
+	if ( font == NULL || font->data == NULL || renderer == NULL ) return 0;
+
+	if ( font->advances == NULL )
+		mgui_font_build_metrics( font );
+
+	return font->spacing;
+}
+
+uint32 mgui_font_get_height( MGuiFont* font )
+{
+	if ( font == NULL ) return 0;
+	if ( font->data == NULL || renderer == NULL ) return font->size;
+
+	if ( font->advances == NULL )
+		mgui_font_build_metrics( font );
+
+	return font->height;
+}
+
+static void mgui_font_load( MGuiFont* font )
+{
+	if ( font->job != NULL ) return;
+
+	// Text using the font is not drawn until the font has been loaded.
+	if ( mgui_font_load_async( font ) ) return;
+
+	font->data = renderer->load_font( font->name, font->size, font->flags, mgui_font_get_charset( font->charset ), font->first_char, font->last_char );
+}
+
+static bool mgui_font_load_async( MGuiFont* font )
+{
+	MGuiFontJob* job;
+
+	if ( !mgui_loader_is_enabled() ) return false;
+	if ( BIT_OFF( renderer->properties, REND_THREADED_FONTS ) ) return false;
+
+	job = mem_alloc_clean( sizeof(*job) );
+	job->load = mgui_font_job_load;
+	job->finish = mgui_font_job_finish;
+	job->font = font;
+	job->name = font->name;
+	job->size = font->size;
+	job->flags = font->flags;
+	job->charset = mgui_font_get_charset( font->charset );
+	job->first_char = font->first_char;
+	job->last_char = font->last_char;
+	job->load_font = renderer->load_font;
+
+	if ( !mgui_loader_queue( (MGuiLoadJob*)job ) )
+	{
+		mem_free( job );
+		return false;
+	}
+
+	font->job = job;
+	return true;
+}
+
+static void mgui_font_job_load( MGuiLoadJob* job )
+{
+	MGuiFontJob* fjob = (MGuiFontJob*)job;
+
+	// Called from the worker thread. The name is interned, so it stays valid until the font manager is shut down.
+	fjob->data = fjob->load_font( fjob->name, fjob->size, fjob->flags, fjob->charset, fjob->first_char, fjob->last_char );
+}
+
+static void mgui_font_job_finish( MGuiLoadJob* job )
+{
+	MGuiFontJob* fjob = (MGuiFontJob*)job;
+	MGuiFont* font = fjob->font;
+
+	// The job is freed below, so make sure the font doesn't point to it anymore.
+	if ( font != NULL )
+		font->job = NULL;
+
+	if ( font != NULL && renderer != NULL )
+	{
+		font->data = fjob->data;
+
+		// Text using the font has been measured without it, so it has to be measured again.
+		mgui_font_free_metrics( font );
+		mgui_element_refresh_font_all( font );
+	}
+	else if ( fjob->data != NULL && renderer != NULL )
+	{
+		renderer->destroy_font( fjob->data );
+	}
+
+	mem_free( fjob );
+}
+
+static const char_t* mgui_font_intern_name( const char_t* name )
+{
+	MGuiFontName* entry;
+	uint32 hash;
+	size_t len;
+
+	if ( name == NULL ) return NULL;
+
+	hash = mgui_font_hash_name( name );
+
+	for ( entry = font_names[hash % FONT_HASH_SIZE]; entry != NULL; entry = entry->next )
+	{
+		if ( entry->hash == hash && mstrequal( entry->name, name ) )
+			return entry->name;
+	}
+
+	// First time we see this name, store a copy of it.
+	len = mstrsize( name );
+
+	entry = mem_alloc( sizeof(*entry) + len2size(len) );
+	entry->hash = hash;
+	entry->next = font_names[hash % FONT_HASH_SIZE];
+
+	mstrcpy( entry->name, name, len );
+	font_names[hash % FONT_HASH_SIZE] = entry;
+
+	return entry->name;
+}
+
+static uint32 mgui_font_hash_name( const char_t* name )
+{
+	uint32 hash = 2166136261u;
+
+	// FNV-1a
+	for ( ; *name; name++ )
+		hash = ( hash ^ (uint32)*name ) * 16777619u;
+
+	return hash;
+}
+
+static uint32 mgui_font_hash( const char_t* name, uint8 size, uint8 flags, uint8 charset, char_t firstc, char_t lastc )
+{
+	uint32 hash = 2166136261u;
+
+	// Interned names are unique, so the address of the name can be used instead of its contents.
+	hash = ( hash ^ (uint32)( (size_t)name >> 3 ) ) * 16777619u;
+	hash = ( hash ^ ( size | ( flags << 8 ) | ( charset << 16 ) ) ) * 16777619u;
+	hash = ( hash ^ ( *(uchar_t*)&firstc | ( *(uchar_t*)&lastc << 16 ) ) ) * 16777619u;
+
+	return hash;
+}
+
+static void mgui_font_hash_insert( MGuiFont* font )
+{
+	uint32 bucket;
+
+	font->hash = mgui_font_hash( font->name, font->size, font->flags, font->charset, font->first_char, font->last_char );
+	bucket = font->hash % FONT_HASH_SIZE;
+
+	font->hash_next = font_table[bucket];
+	font_table[bucket] = font;
+}
+
+static void mgui_font_hash_remove( MGuiFont* font )
+{
+	MGuiFont** prev;
+
+	for ( prev = &font_table[font->hash % FONT_HASH_SIZE]; *prev != NULL; prev = &(*prev)->hash_next )
+	{
+		if ( *prev == font )
+		{
+			*prev = font->hash_next;
+			break;
+		}
+	}
+
+	font->hash_next = NULL;
+}
+
+static void mgui_font_build_metrics( MGuiFont* font )
+{
+	uint32 first, last, c, w, h, pad;
+	char_t tmp[2];
+
+	first = *(uchar_t*)&font->first_char;
+	last = *(uchar_t*)&font->last_char;
+
+	// Use the same default range as the renderers do.
+	first = first > 0x20 ? first : 0x20;
+	last = last > first ? last : 0xFF;
+
+	font->advances = mem_alloc( ( last - first + 1 ) * sizeof(uint16) );
+	font->adv_first = first;
+	font->adv_last = last;
+
+	if ( renderer->measure_glyphs != NULL )
+	{
+		renderer->measure_glyphs( font->data, first, last, font->advances );
+	}
+	else
+	{
+		// The renderer can't measure the whole range at once, do it the slow way.
+		tmp[1] = '\0';
+
+		for ( c = first; c <= last; c++ )
+		{
+			tmp[0] = (char_t)c;
+			renderer->measure_text( font->data, tmp, &w, &h );
+
+			font->advances[c - first] = (uint16)w;
+		}
+	}
+
+	// Measure padding between two characters.
+	renderer->measure_text( font->data, _MTEXT("XX"), &pad, &h );
+	renderer->measure_text( font->data, _MTEXT("X"), &w, &h );
+
+	font->spacing = (int32)pad - 2 * (int32)w;
+	font->height = h;
+}
+
+static void mgui_font_free_metrics( MGuiFont* font )
+{
+	SAFE_DELETE( font->advances );
 
-	font->data = renderer->load_font( font->name, font->size, font->flags, font->charset, font->first_char, font->last_char );
+	font->adv_first = 0;
+	font->adv_last = 0;
 }
 
 static uint8 mgui_font_get_charset( uint32 charset )
@@ -17,16 +17,28 @@
 #include "Renderer.h"
 #include "Types/List.h"
 
-typedef struct {
+#define FONT_HASH_SIZE 64		// Number of buckets in the font and font name hash tables
+
+struct MGuiFontJob;
+
+typedef struct MGuiFont {
 	node_t			node;		// Linked list node
+	struct MGuiFont* hash_next;	// Next font in the same hash table bucket
+	uint32			hash;		// Hash of the font properties
 	MGuiRendFont*	data;		// Renderer font data
-	char_t*			name;		// The name of the font
+	const char_t*	name;		// The name of the font (interned, equal names share the same pointer)
 	uint8			size;		// Size (height)
 	uint8			flags;		// Font flags, defined in MGUI.h
 	uint8			charset;	// Character set
 	char_t			first_char;	// First character in range
 	char_t			last_char;	// Last character in range
 	uint32			refcount;	// Reference count
+	uint16*			advances;	// Character width table, built when the font is measured for the first time
+	uint32			adv_first;	// First character in the width table
+	uint32			adv_last;	// Last character in the width table
+	int32			spacing;	// Additional spacing between two adjacent characters
+	uint32			height;		// Height of a line of text
+	struct MGuiFontJob* job;	// Background load in progress, NULL if the font is not being loaded
 } MGuiFont;
 
 void		mgui_fontmgr_initialize		( void );
@@ -45,4 +57,8 @@ MGuiFont*	mgui_font_set_charset		( MGuiFont* font, uint8 charset );
 
 void		mgui_font_reinitialize		( MGuiFont* font );
 
+uint32		mgui_font_get_char_width	( MGuiFont* font, char_t c );
+int32		mgui_font_get_spacing		( MGuiFont* font );
+uint32		mgui_font_get_height		( MGuiFont* font );
+
 #endif /* __MGUI_FONT_H */
@@ -0,0 +1,110 @@
+/**********************************************************************
+ *
+ * PROJECT:		Mylly GUI Renderer (Headless)
+ * FILE:		Headless.c
+ * LICENCE:		See Licence.txt
+ * PURPOSE:		A headless renderer for Mylly GUI. Doesn't draw anything,
+ *				only counts and optionally records the calls made to it.
+ *				Meant for benchmarking and automated testing.
+ *
+ *				(c) Tuomo Jauhiainen 2013
+ *
+ **********************************************************************/
+
+#include "Headless.h"
+#include "Renderer.h"
+#include "Platform/Alloc.h"
+#include <string.h>
+
+// --------------------------------------------------
+
+static MGuiRenderer	renderer;
+MGuiHeadlessStats	stats;
+MGuiHeadlessCall*	calls			= NULL;
+uint32				num_calls		= 0;
+uint32				calls_size		= 0;
+bool				recording		= false;
+bool				initialized		= false;
+
+// --------------------------------------------------
+
+MGuiRenderer* mgui_headless_initialize( uint32 width, uint32 height )
+{
+	renderer.properties = REND_SUPPORTS_TEXTTAGS|REND_SUPPORTS_TEXTURES|REND_SUPPORTS_TARGETS|REND_SUPPORTS_DAMAGE;
+
+	renderer.begin					= renderer_begin;
+	renderer.end					= renderer_end;
+	renderer.resize					= renderer_resize;
+	renderer.set_damage_rects		= renderer_set_damage_rects;
+	renderer.set_draw_mode			= renderer_set_draw_mode;
+	renderer.set_draw_colour		= renderer_set_draw_colour;
+	renderer.set_draw_depth			= renderer_set_draw_depth;
+	renderer.set_draw_transform		= renderer_set_draw_transform;
+	renderer.reset_draw_transform	= renderer_reset_draw_transform;
+	renderer.start_clip				= renderer_start_clip;
+	renderer.end_clip				= renderer_end_clip;
+	renderer.draw_rect				= renderer_draw_rect;
+	renderer.draw_triangle			= renderer_draw_triangle;
+	renderer.draw_pixel				= renderer_draw_pixel;
+	renderer.load_texture			= renderer_load_texture;
+	renderer.destroy_texture		= renderer_destroy_texture;
+	renderer.draw_textured_rect		= renderer_draw_textured_rect;
+	renderer.load_font				= renderer_load_font;
+	renderer.destroy_font			= renderer_destroy_font;
+	renderer.draw_text				= renderer_draw_text;
+	renderer.measure_text			= renderer_measure_text;
+	renderer.measure_glyphs			= renderer_measure_glyphs;
+	renderer.create_render_target	= renderer_create_render_target;
+	renderer.destroy_render_target	= renderer_destroy_render_target;
+	renderer.draw_render_target		= renderer_draw_render_target;
+	renderer.enable_render_target	= renderer_enable_render_target;
+	renderer.disable_render_target	= renderer_disable_render_target;
+	renderer.screen_pos_to_world	= renderer_screen_pos_to_world;
+	renderer.world_pos_to_screen	= renderer_world_pos_to_screen;
+
+	renderer_resize( width, height );
+	mgui_headless_reset_stats();
+
+	initialized = true;
+
+	return &renderer;
+}
+
+void mgui_headless_shutdown( void )
+{
+	if ( !initialized ) return;
+
+	SAFE_DELETE( calls );
+
+	num_calls = 0;
+	calls_size = 0;
+	recording = false;
+	initialized = false;
+}
+
+void mgui_headless_get_stats( MGuiHeadlessStats* out )
+{
+	if ( out == NULL ) return;
+
+	*out = stats;
+}
+
+void mgui_headless_reset_stats( void )
+{
+	memset( &stats, 0, sizeof(stats) );
+}
+
+void mgui_headless_set_recording( bool enable )
+{
+	recording = enable;
+	num_calls = 0;
+}
+
+const MGuiHeadlessCall* mgui_headless_get_calls( uint32* count )
+{
+	// Returns the calls made during the last scene (between begin and end).
+	if ( count != NULL )
+		*count = num_calls;
+
+	return calls;
+}
@@ -0,0 +1,72 @@
+/**********************************************************************
+ *
+ * PROJECT:		Mylly GUI Renderer (Headless)
+ * FILE:		Headless.h
+ * LICENCE:		See Licence.txt
+ * PURPOSE:		A headless renderer for Mylly GUI. Doesn't draw anything,
+ *				only counts and optionally records the calls made to it.
+ *				Meant for benchmarking and automated testing.
+ *
+ *				(c) Tuomo Jauhiainen 2013
+ *
+ **********************************************************************/
+
+#pragma once
+#ifndef __MYLLY_GUI_HEADLESS_H
+#define __MYLLY_GUI_HEADLESS_H
+
+#include "MGUI/Renderer/Renderer.h"
+
+// Types of the recorded renderer calls
+typedef enum {
+	CALL_DRAW_RECT,
+	CALL_DRAW_TRIANGLE,
+	CALL_DRAW_PIXEL,
+	CALL_DRAW_TEXTURED_RECT,
+	CALL_DRAW_TEXT,
+	CALL_DRAW_RENDER_TARGET,
+	CALL_START_CLIP,
+	CALL_END_CLIP,
+	CALL_ENABLE_TARGET,
+	CALL_DISABLE_TARGET,
+} HEADLESS_CALL;
+
+// A single recorded renderer call
+typedef struct {
+	HEADLESS_CALL	type;		// Type of the call
+	int32			x, y;		// Position (for text, the position of the first character)
+	uint32			w, h;		// Size (for text, the size of the text using the headless font metrics)
+	colour_t		colour;		// Draw colour at the time of the call
+} MGuiHeadlessCall;
+
+// Renderer call counters, accumulated until reset
+typedef struct {
+	uint32	frames;				// Number of begin/end pairs
+	uint32	draw_rect;			// Number of draw_rect calls
+	uint32	draw_triangle;		// Number of draw_triangle calls
+	uint32	draw_pixel;			// Number of draw_pixel calls
+	uint32	draw_textured_rect;	// Number of draw_textured_rect calls
+	uint32	draw_text;			// Number of draw_text calls
+	uint32	draw_target;		// Number of draw_render_target calls
+	uint32	measure_text;		// Number of measure_text calls
+	uint32	measure_glyphs;		// Number of measure_glyphs calls
+	uint32	clip_changes;		// Number of start_clip and end_clip calls
+	uint32	target_switches;	// Number of enable_render_target and disable_render_target calls
+	uint32	colour_changes;		// Number of set_draw_colour calls
+	uint32	damage_rects;		// Number of damage rectangles passed to the renderer
+	uint32	text_chars;			// Number of characters drawn
+	uint32	pixels;				// Number of pixels covered by drawn rectangles
+} MGuiHeadlessStats;
+
+__BEGIN_DECLS
+
+MYLLY_API MGuiRenderer*				mgui_headless_initialize	( uint32 width, uint32 height );
+MYLLY_API void						mgui_headless_shutdown		( void );
+MYLLY_API void						mgui_headless_get_stats		( MGuiHeadlessStats* stats );
+MYLLY_API void						mgui_headless_reset_stats	( void );
+MYLLY_API void						mgui_headless_set_recording	( bool enable );
+MYLLY_API const MGuiHeadlessCall*	mgui_headless_get_calls		( uint32* count );
+
+__END_DECLS
+
+#endif /* __MYLLY_GUI_HEADLESS_H */
@@ -0,0 +1,332 @@
+/**********************************************************************
+ *
+ * PROJECT:		Mylly GUI - Headless Renderer
+ * FILE:		Renderer.c
+ * LICENCE:		See Licence.txt
+ * PURPOSE:		A headless renderer for Mylly GUI.
+ *
+ *				(c) Tuomo Jauhiainen 2013
+ *
+ **********************************************************************/
+
+#include "Renderer.h"
+#include "Platform/Alloc.h"
+#include "Stringy/Stringy.h"
+#include <string.h>
+
+// --------------------------------------------------
+
+typedef struct {
+	MGuiRendFont	data;
+	uint32			advance;	// Width of every character, the font is monospaced
+} RendFont;
+
+// --------------------------------------------------
+
+static uint32		screen_width	= 0;
+static uint32		screen_height	= 0;
+static colour_t		draw_colour		= { 0 };
+static DRAW_MODE	draw_mode		= DRAWING_INVALID;
+extern MGuiHeadlessStats	stats;
+extern MGuiHeadlessCall*	calls;
+extern uint32		num_calls;
+extern uint32		calls_size;
+extern bool			recording;
+
+// --------------------------------------------------
+
+static void		renderer_record_call		( HEADLESS_CALL type, int32 x, int32 y, uint32 w, uint32 h );
+
+// --------------------------------------------------
+
+void renderer_begin( void )
+{
+	// Only the calls of the latest scene are kept.
+	num_calls = 0;
+}
+
+void renderer_end( void )
+{
+	stats.frames++;
+}
+
+void renderer_resize( uint32 w, uint32 h )
+{
+	screen_width = w;
+	screen_height = h;
+}
+
+void renderer_set_damage_rects( const rectangle_t rects[], uint32 count )
+{
+	UNREFERENCED_PARAM( rects );
+
+	stats.damage_rects += count;
+}
+
+DRAW_MODE renderer_set_draw_mode( DRAW_MODE mode )
+{
+	DRAW_MODE old = draw_mode;
+
+	draw_mode = mode;
+	return old;
+}
+
+void renderer_set_draw_colour( const colour_t* col )
+{
+	draw_colour = *col;
+	stats.colour_changes++;
+}
+
+void renderer_set_draw_depth( float z_depth )
+{
+	UNREFERENCED_PARAM( z_depth );
+}
+
+void renderer_set_draw_transform( const matrix4_t* mat )
+{
+	UNREFERENCED_PARAM( mat );
+}
+
+void renderer_reset_draw_transform( void )
+{
+}
+
+void renderer_start_clip( int32 x, int32 y, uint32 w, uint32 h )
+{
+	stats.clip_changes++;
+	renderer_record_call( CALL_START_CLIP, x, y, w, h );
+}
+
+void renderer_end_clip( void )
+{
+	stats.clip_changes++;
+	renderer_record_call( CALL_END_CLIP, 0, 0, screen_width, screen_height );
+}
+
+void renderer_draw_rect( int32 x, int32 y, uint32 w, uint32 h )
+{
+	stats.draw_rect++;
+	stats.pixels += w * h;
+
+	renderer_record_call( CALL_DRAW_RECT, x, y, w, h );
+}
+
+void renderer_draw_triangle( int32 x1, int32 y1, int32 x2, int32 y2, int32 x3, int32 y3 )
+{
+	int32 x, y;
+
+	stats.draw_triangle++;
+
+	// Record the bounding box of the triangle.
+	x = math_min( x1, math_min( x2, x3 ) );
+	y = math_min( y1, math_min( y2, y3 ) );
+
+	renderer_record_call( CALL_DRAW_TRIANGLE, x, y,
+						  math_max( x1, math_max( x2, x3 ) ) - x,
+						  math_max( y1, math_max( y2, y3 ) ) - y );
+}
+
+void renderer_draw_pixel( int32 x, int32 y )
+{
+	stats.draw_pixel++;
+	stats.pixels++;
+
+	renderer_record_call( CALL_DRAW_PIXEL, x, y, 1, 1 );
+}
+
+MGuiRendTexture* renderer_load_texture( const char_t* path, uint32* width, uint32* height )
+{
+	MGuiRendTexture* texture;
+
+	// No image data is actually loaded, every texture has the same fixed size.
+	UNREFERENCED_PARAM( path );
+
+	texture = mem_alloc( sizeof(*texture) );
+	texture->width = 256;
+	texture->height = 256;
+
+	*width = texture->width;
+	*height = texture->height;
+
+	return texture;
+}
+
+void renderer_destroy_texture( MGuiRendTexture* texture )
+{
+	if ( texture == NULL ) return;
+
+	mem_free( texture );
+}
+
+void renderer_draw_textured_rect( const MGuiRendTexture* texture, int32 x, int32 y, uint32 w, uint32 h, const float uv[] )
+{
+	UNREFERENCED_PARAM( texture );
+	UNREFERENCED_PARAM( uv );
+
+	stats.draw_textured_rect++;
+	stats.pixels += w * h;
+
+	renderer_record_call( CALL_DRAW_TEXTURED_RECT, x, y, w, h );
+}
+
+MGuiRendFont* renderer_load_font( const char_t* name, uint8 size, uint8 flags, uint8 charset, uint32 firstc, uint32 lastc )
+{
+	RendFont* font;
+
+	if ( name == NULL ||
+		 *name == '\0' )
+		 return NULL;
+
+	font = mem_alloc( sizeof(*font) );
+
+	font->data.size = size;
+	font->data.flags = flags;
+	font->data.charset = charset;
+	font->data.first_char = firstc;
+	font->data.last_char = lastc;
+
+	// Use simple monospaced metrics so that the layout is the same on every platform.
+	font->advance = math_max( size / 2, 1 );
+
+	if ( flags & FFLAG_BOLD )
+		font->advance++;
+
+	return (MGuiRendFont*)font;
+}
+
+void renderer_destroy_font( MGuiRendFont* font )
+{
+	if ( font == NULL ) return;
+
+	mem_free( font );
+}
+
+void renderer_draw_text( const MGuiRendFont* fnt, const char_t* text, int32 x, int32 y,
+						 uint32 flags, const MGuiFormatTag tags[], uint32 ntags )
+{
+	const RendFont* font = (const RendFont*)fnt;
+	uint32 len;
+
+	UNREFERENCED_PARAM( flags );
+	UNREFERENCED_PARAM( tags );
+	UNREFERENCED_PARAM( ntags );
+
+	if ( font == NULL || text == NULL ) return;
+
+	len = mstrlen( text );
+
+	stats.draw_text++;
+	stats.text_chars += len;
+
+	renderer_record_call( CALL_DRAW_TEXT, x, y, font->advance * len, font->data.size );
+}
+
+void renderer_measure_text( const MGuiRendFont* fnt, const char_t* text, uint32* w, uint32* h )
+{
+	const RendFont* font = (const RendFont*)fnt;
+
+	stats.measure_text++;
+
+	if ( font == NULL )
+	{
+		*w = *h = 1;
+		return;
+	}
+
+	*w = font->advance * mstrlen( text );
+	*h = font->data.size;
+}
+
+void renderer_measure_glyphs( const MGuiRendFont* fnt, uint32 firstc, uint32 lastc, uint16 advances[] )
+{
+	const RendFont* font = (const RendFont*)fnt;
+	uint32 c;
+
+	stats.measure_glyphs++;
+
+	for ( c = firstc; c <= lastc; c++ )
+		advances[c - firstc] = font ? (uint16)font->advance : 1;
+}
+
+MGuiRendTarget* renderer_create_render_target( uint32 width, uint32 height )
+{
+	MGuiRendTarget* target;
+
+	target = mem_alloc( sizeof(*target) );
+	target->width = width;
+	target->height = height;
+
+	return target;
+}
+
+void renderer_destroy_render_target( MGuiRendTarget* target )
+{
+	if ( target == NULL ) return;
+
+	mem_free( target );
+}
+
+void renderer_draw_render_target( const MGuiRendTarget* target, int32 x, int32 y, uint32 w, uint32 h )
+{
+	UNREFERENCED_PARAM( target );
+
+	stats.draw_target++;
+	stats.pixels += w * h;
+
+	renderer_record_call( CALL_DRAW_RENDER_TARGET, x, y, w, h );
+}
+
+void renderer_enable_render_target( const MGuiRendTarget* target, int32 x, int32 y )
+{
+	stats.target_switches++;
+	renderer_record_call( CALL_ENABLE_TARGET, x, y, target->width, target->height );
+}
+
+void renderer_disable_render_target( const MGuiRendTarget* target )
+{
+	stats.target_switches++;
+	renderer_record_call( CALL_DISABLE_TARGET, 0, 0, target->width, target->height );
+}
+
+void renderer_screen_pos_to_world( const vector3_t* src, vector3_t* dst )
+{
+	// There is no 3D projection, screen and world coordinates are the same.
+	if ( dst != NULL )
+		*dst = *src;
+}
+
+void renderer_world_pos_to_screen( const vector3_t* src, vector3_t* dst )
+{
+	if ( dst != NULL )
+		*dst = *src;
+}
+
+static void renderer_record_call( HEADLESS_CALL type, int32 x, int32 y, uint32 w, uint32 h )
+{
+	MGuiHeadlessCall* tmp;
+	MGuiHeadlessCall* call;
+
+	if ( !recording ) return;
+
+	if ( num_calls >= calls_size )
+	{
+		calls_size = calls_size ? calls_size * 2 : 256;
+		tmp = mem_alloc( calls_size * sizeof(MGuiHeadlessCall) );
+
+		if ( calls != NULL )
+		{
+			memcpy( tmp, calls, num_calls * sizeof(MGuiHeadlessCall) );
+			mem_free( calls );
+		}
+
+		calls = tmp;
+	}
+
+	call = &calls[num_calls++];
+	call->type = type;
+	call->x = x;
+	call->y = y;
+	call->w = w;
+	call->h = h;
+	call->colour = draw_colour;
+}
@@ -0,0 +1,23 @@
+-- Mylly GUI headless renderer
+
+project "Lib-MGUI-Renderer-Headless"
+	kind "StaticLib"
+	language "C"
+	files { "*.h", "*.c", "premake4.lua" }
+	includedirs { ".", "..", "../..", "../../.." }
+	vpaths { [""] = { "../Libraries/MGUI/Renderer/Headless" } }
+	location ( "../../../../Projects/" .. os.get() .. "/" .. _ACTION )
+
+	-- Linux specific stuff
+	configuration "linux"
+		targetextension ".a"
+		buildoptions { "-fms-extensions" } -- Unnamed struct/union fields within structs/unions
+		configuration "Debug" targetname "mguiheadlessd"
+		configuration "Release" targetname "mguiheadless"
+
+	-- Windows specific stuff
+	configuration "windows"
+		targetextension ".lib"
+		buildoptions { "/wd4201" } -- C4201: nameless struct/union
+		configuration "Debug" targetname "mguirendheadlessd"
+		configuration "Release" targetname "mguirendheadless"
@@ -0,0 +1,265 @@
+/**********************************************************************
+ *
+ * PROJECT:		Mylly GUI
+ * FILE:		Loader.c
+ * LICENCE:		See Licence.txt
+ * PURPOSE:		Background resource loading.
+ *
+ *				(c) Tuomo Jauhiainen 2012-13
+ *
+ **********************************************************************/
+
+#include "Loader.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+typedef HANDLE				loader_thread_t;
+typedef CRITICAL_SECTION	loader_mutex_t;
+typedef CONDITION_VARIABLE	loader_cond_t;
+
+#define loader_mutex_init(m)		InitializeCriticalSection( m )
+#define loader_mutex_destroy(m)		DeleteCriticalSection( m )
+#define loader_mutex_lock(m)		EnterCriticalSection( m )
+#define loader_mutex_unlock(m)		LeaveCriticalSection( m )
+#define loader_cond_init(c)			InitializeConditionVariable( c )
+#define loader_cond_destroy(c)		((void)(c))
+#define loader_cond_wait(c,m)		SleepConditionVariableCS( c, m, INFINITE )
+#define loader_cond_signal(c)		WakeConditionVariable( c )
+#define loader_cond_broadcast(c)	WakeAllConditionVariable( c )
+#else
+#include <pthread.h>
+
+typedef pthread_t			loader_thread_t;
+typedef pthread_mutex_t		loader_mutex_t;
+typedef pthread_cond_t		loader_cond_t;
+
+#define loader_mutex_init(m)		pthread_mutex_init( m, NULL )
+#define loader_mutex_destroy(m)		pthread_mutex_destroy( m )
+#define loader_mutex_lock(m)		pthread_mutex_lock( m )
+#define loader_mutex_unlock(m)		pthread_mutex_unlock( m )
+#define loader_cond_init(c)			pthread_cond_init( c, NULL )
+#define loader_cond_destroy(c)		pthread_cond_destroy( c )
+#define loader_cond_wait(c,m)		pthread_cond_wait( c, m )
+#define loader_cond_signal(c)		pthread_cond_signal( c )
+#define loader_cond_broadcast(c)	pthread_cond_broadcast( c )
+#endif
+
+// --------------------------------------------------
+
+static bool				enabled			= false;	// Should resources be loaded in the background
+static bool				running			= false;	// Has the worker thread been started
+static bool				quit			= false;	// The worker thread should exit
+static bool				busy			= false;	// The worker thread is loading something
+static loader_thread_t	thread;						// The worker thread
+static loader_mutex_t	mutex;						// Protects the job queues
+static loader_cond_t	work_cond;					// Signaled when a job is queued
+static loader_cond_t	idle_cond;					// Signaled when the worker has finished a job
+static MGuiLoadJob*		pending_first	= NULL;		// Jobs waiting for the worker thread
+static MGuiLoadJob*		pending_last	= NULL;
+static MGuiLoadJob*		done_first		= NULL;		// Jobs waiting to be finalized
+static MGuiLoadJob*		done_last		= NULL;
+
+// --------------------------------------------------
+
+static bool			mgui_loader_start		( void );
+static void			mgui_loader_run			( void );
+static void			mgui_loader_append		( MGuiLoadJob** first, MGuiLoadJob** last, MGuiLoadJob* job );
+
+#ifdef _WIN32
+static DWORD WINAPI	mgui_loader_thread		( LPVOID param );
+#else
+static void*		mgui_loader_thread		( void* param );
+#endif
+
+// --------------------------------------------------
+
+void mgui_loader_shutdown( void )
+{
+	if ( !running ) return;
+
+	// Let the worker finish what it was doing and wait for it to exit.
+	loader_mutex_lock( &mutex );
+	quit = true;
+	loader_cond_broadcast( &work_cond );
+	loader_mutex_unlock( &mutex );
+
+#ifdef _WIN32
+	WaitForSingleObject( thread, INFINITE );
+	CloseHandle( thread );
+#else
+	pthread_join( thread, NULL );
+#endif
+
+	running = false;
+	quit = false;
+
+	// Finalize whatever is left, the owners will release the results.
+	mgui_loader_process();
+
+	loader_cond_destroy( &idle_cond );
+	loader_cond_destroy( &work_cond );
+	loader_mutex_destroy( &mutex );
+}
+
+void mgui_loader_set_enabled( bool enable )
+{
+	enabled = enable;
+}
+
+bool mgui_loader_is_enabled( void )
+{
+	return enabled;
+}
+
+bool mgui_loader_is_busy( void )
+{
+	bool ret;
+
+	if ( !running ) return false;
+
+	loader_mutex_lock( &mutex );
+	ret = ( pending_first != NULL || done_first != NULL || busy );
+	loader_mutex_unlock( &mutex );
+
+	return ret;
+}
+
+bool mgui_loader_queue( MGuiLoadJob* job )
+{
+	if ( !enabled || job == NULL ) return false;
+
+	// The worker thread is started when it's needed for the first time.
+	if ( !running && !mgui_loader_start() )
+		return false;
+
+	job->next = NULL;
+
+	loader_mutex_lock( &mutex );
+	mgui_loader_append( &pending_first, &pending_last, job );
+	loader_cond_signal( &work_cond );
+	loader_mutex_unlock( &mutex );
+
+	return true;
+}
+
+void mgui_loader_process( void )
+{
+	MGuiLoadJob *job, *next;
+
+	// Take the whole list of finished jobs at once so the worker isn't kept waiting.
+	if ( running ) loader_mutex_lock( &mutex );
+
+	job = done_first;
+	done_first = NULL;
+	done_last = NULL;
+
+	if ( running ) loader_mutex_unlock( &mutex );
+
+	for ( ; job != NULL; job = next )
+	{
+		next = job->next;
+		job->finish( job );
+	}
+}
+
+void mgui_loader_flush( void )
+{
+	if ( !running ) return;
+
+	// Wait until everything that has been queued is loaded, then finalize it all.
+	loader_mutex_lock( &mutex );
+
+	while ( pending_first != NULL || busy )
+		loader_cond_wait( &idle_cond, &mutex );
+
+	loader_mutex_unlock( &mutex );
+
+	mgui_loader_process();
+}
+
+static bool mgui_loader_start( void )
+{
+	loader_mutex_init( &mutex );
+	loader_cond_init( &work_cond );
+	loader_cond_init( &idle_cond );
+
+#ifdef _WIN32
+	thread = CreateThread( NULL, 0, mgui_loader_thread, NULL, 0, NULL );
+	running = ( thread != NULL );
+#else
+	running = ( pthread_create( &thread, NULL, mgui_loader_thread, NULL ) == 0 );
+#endif
+
+	if ( !running )
+	{
+		// Without a thread everything will be loaded right away.
+		loader_cond_destroy( &idle_cond );
+		loader_cond_destroy( &work_cond );
+		loader_mutex_destroy( &mutex );
+	}
+
+	return running;
+}
+
+static void mgui_loader_run( void )
+{
+	MGuiLoadJob* job;
+
+	loader_mutex_lock( &mutex );
+
+	for ( ;; )
+	{
+		while ( pending_first == NULL && !quit )
+			loader_cond_wait( &work_cond, &mutex );
+
+		if ( pending_first == NULL ) break;
+
+		job = pending_first;
+		pending_first = job->next;
+		if ( pending_first == NULL ) pending_last = NULL;
+
+		busy = true;
+		loader_mutex_unlock( &mutex );
+
+		// Do the slow part (file I/O, decoding) without holding the lock.
+		job->load( job );
+
+		loader_mutex_lock( &mutex );
+
+		job->next = NULL;
+		mgui_loader_append( &done_first, &done_last, job );
+
+		busy = false;
+		loader_cond_broadcast( &idle_cond );
+	}
+
+	loader_mutex_unlock( &mutex );
+}
+
+static void mgui_loader_append( MGuiLoadJob** first, MGuiLoadJob** last, MGuiLoadJob* job )
+{
+	if ( *last ) (*last)->next = job;
+	else *first = job;
+
+	*last = job;
+}
+
+#ifdef _WIN32
+static DWORD WINAPI mgui_loader_thread( LPVOID param )
+{
+	UNREFERENCED_PARAM( param );
+
+	mgui_loader_run();
+	return 0;
+}
+#else
+static void* mgui_loader_thread( void* param )
+{
+	UNREFERENCED_PARAM( param );
+
+	mgui_loader_run();
+	return NULL;
+}
+#endif
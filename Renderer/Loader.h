@@ -0,0 +1,37 @@
+/**********************************************************************
+ *
+ * PROJECT:		Mylly GUI
+ * FILE:		Loader.h
+ * LICENCE:		See Licence.txt
+ * PURPOSE:		Background resource loading.
+ *
+ *				(c) Tuomo Jauhiainen 2012-13
+ *
+ **********************************************************************/
+
+#pragma once
+#ifndef __MGUI_LOADER_H
+#define __MGUI_LOADER_H
+
+#include "MGUI.h"
+
+#define LOADER_POLL_INTERVAL 15		// How often finished loads should be checked for while waiting for events, in milliseconds
+
+typedef struct MGuiLoadJob MGuiLoadJob;
+
+struct MGuiLoadJob {
+	MGuiLoadJob*	next;						// Next job in the queue
+	void			( *load )	( MGuiLoadJob* job );	// Does the actual loading, called from the worker thread
+	void			( *finish )	( MGuiLoadJob* job );	// Finalizes the job and frees it, called from the thread running MGUI
+};
+
+void		mgui_loader_shutdown		( void );
+void		mgui_loader_set_enabled		( bool enable );
+bool		mgui_loader_is_enabled		( void );
+bool		mgui_loader_is_busy			( void );
+
+bool		mgui_loader_queue			( MGuiLoadJob* job );
+void		mgui_loader_process			( void );
+void		mgui_loader_flush			( void );
+
+#endif /* __MGUI_LOADER_H */
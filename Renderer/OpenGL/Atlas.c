@@ -0,0 +1,239 @@
+/**********************************************************************
+ *
+ * PROJECT:		Mylly GUI - OpenGL Renderer
+ * FILE:		Atlas.c
+ * LICENCE:		See Licence.txt
+ * PURPOSE:		An OpenGL reference renderer for Mylly GUI.
+ *				Texture atlas shared by textures and fonts.
+ *
+ *				(c) Tuomo Jauhiainen 2013
+ *
+ **********************************************************************/
+
+#include "Atlas.h"
+#include "Renderer.h"
+#include "Platform/Alloc.h"
+
+// --------------------------------------------------
+
+static AtlasPage*	pages			= NULL;		// List of atlas pages, the first page is never destroyed
+static uint32		max_size		= 0;		// Maximum texture size supported by the driver
+
+// --------------------------------------------------
+
+static AtlasPage*	mgui_opengl_atlas_create_page	( uint32 size );
+static void			mgui_opengl_atlas_destroy_page	( AtlasPage* page );
+static void			mgui_opengl_atlas_reset_page	( AtlasPage* page );
+static bool			mgui_opengl_atlas_pack			( AtlasPage* page, uint32 width, uint32 height, uint32* x, uint32* y );
+static void			mgui_opengl_atlas_upload		( uint32 x, uint32 y, uint32 width, uint32 height, GLenum format, GLenum type, const void* pixels );
+
+// --------------------------------------------------
+
+void mgui_opengl_atlas_initialize( void )
+{
+	GLint size = 0;
+
+	glGetIntegerv( GL_MAX_TEXTURE_SIZE, &size );
+	max_size = size > 0 ? (uint32)size : ATLAS_PAGE_SIZE;
+
+	// Create the first page right away, untextured primitives use its white block.
+	pages = mgui_opengl_atlas_create_page( math_min( ATLAS_PAGE_SIZE, max_size ) );
+}
+
+void mgui_opengl_atlas_shutdown( void )
+{
+	AtlasPage* page;
+
+	while ( pages != NULL )
+	{
+		page = pages;
+		pages = page->next;
+
+		glDeleteTextures( 1, &page->texture );
+		mem_free( page );
+	}
+}
+
+AtlasPage* mgui_opengl_atlas_get_page( void )
+{
+	return pages;
+}
+
+bool mgui_opengl_atlas_add( AtlasRegion* region, uint32 width, uint32 height, GLenum format, GLenum type, const void* pixels )
+{
+	AtlasPage *page, *last = NULL;
+	uint32 x, y, size;
+
+	if ( region == NULL || pixels == NULL || width == 0 || height == 0 ) return false;
+
+	// Find the first page with enough room for the image.
+	for ( page = pages; page != NULL; page = page->next )
+	{
+		if ( mgui_opengl_atlas_pack( page, width, height, &x, &y ) ) break;
+		last = page;
+	}
+
+	if ( page == NULL )
+	{
+		// All pages are full, add a new one. Images larger than the default page get a page of their own.
+		for ( size = ATLAS_PAGE_SIZE; size < width + 2 || size < height + ATLAS_WHITE_SIZE + 4; size <<= 1 ) {}
+
+		if ( size > max_size ) return false;
+
+		page = mgui_opengl_atlas_create_page( size );
+		if ( page == NULL ) return false;
+
+		if ( last != NULL ) last->next = page;
+		else pages = page;
+
+		if ( !mgui_opengl_atlas_pack( page, width, height, &x, &y ) ) return false;
+	}
+
+	glBindTexture( GL_TEXTURE_2D, page->texture );
+	mgui_opengl_atlas_upload( x, y, width, height, format, type, pixels );
+
+	page->regions++;
+
+	region->page = page;
+	region->u = (float)x / page->size;
+	region->v = (float)y / page->size;
+	region->u_scale = (float)width / page->size;
+	region->v_scale = (float)height / page->size;
+
+	return true;
+}
+
+void mgui_opengl_atlas_remove( AtlasRegion* region )
+{
+	AtlasPage* page;
+
+	if ( region == NULL || region->page == NULL ) return;
+
+	page = region->page;
+	region->page = NULL;
+
+	// The space used by single images is not reclaimed, but empty pages are recycled as a whole.
+	if ( --page->regions > 0 ) return;
+
+	if ( page == pages )
+		mgui_opengl_atlas_reset_page( page );
+	else
+		mgui_opengl_atlas_destroy_page( page );
+}
+
+static AtlasPage* mgui_opengl_atlas_create_page( uint32 size )
+{
+	AtlasPage* page;
+	void* clear;
+	static const uint32 white[ATLAS_WHITE_SIZE*ATLAS_WHITE_SIZE] = {
+		0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF,
+		0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF,
+		0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF,
+		0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF,
+	};
+
+	page = mem_alloc_clean( sizeof(*page) );
+	page->size = size;
+
+	// Start with a transparent page so the gaps between images don't contain garbage.
+	clear = mem_alloc_clean( size * size * sizeof(uint32) );
+
+	glGenTextures( 1, &page->texture );
+	glBindTexture( GL_TEXTURE_2D, page->texture );
+
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+
+	glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, clear );
+
+	mem_free( clear );
+
+	mgui_opengl_atlas_upload( 1, 1, ATLAS_WHITE_SIZE, ATLAS_WHITE_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, white );
+
+	// Sample the middle of the white block, so filtering never picks up the neighbouring texels.
+	page->white_u = ( 1 + ATLAS_WHITE_SIZE * 0.5f ) / size;
+	page->white_v = ( 1 + ATLAS_WHITE_SIZE * 0.5f ) / size;
+
+	mgui_opengl_atlas_reset_page( page );
+
+	return page;
+}
+
+static void mgui_opengl_atlas_destroy_page( AtlasPage* page )
+{
+	AtlasPage* prev;
+
+	for ( prev = pages; prev != NULL && prev->next != page; prev = prev->next ) {}
+	if ( prev != NULL ) prev->next = page->next;
+
+	glDeleteTextures( 1, &page->texture );
+	mem_free( page );
+}
+
+static void mgui_opengl_atlas_reset_page( AtlasPage* page )
+{
+	// The white block occupies the beginning of the first shelf.
+	page->shelf_x = ATLAS_WHITE_SIZE + 2;
+	page->shelf_y = 0;
+	page->shelf_h = ATLAS_WHITE_SIZE + 2;
+	page->regions = 0;
+}
+
+static bool mgui_opengl_atlas_pack( AtlasPage* page, uint32 width, uint32 height, uint32* x, uint32* y )
+{
+	uint32 shelf_x, shelf_y, shelf_h;
+
+	// Each image is surrounded by a one pixel border, which is filled with the edges of the image.
+	width += 2;
+	height += 2;
+
+	shelf_x = page->shelf_x;
+	shelf_y = page->shelf_y;
+	shelf_h = page->shelf_h;
+
+	if ( shelf_x + width > page->size )
+	{
+		// Start a new shelf below the current one.
+		shelf_y += shelf_h;
+		shelf_x = 0;
+		shelf_h = 0;
+	}
+
+	if ( shelf_x + width > page->size ||
+		 shelf_y + height > page->size )
+		 return false;
+
+	*x = shelf_x + 1;
+	*y = shelf_y + 1;
+
+	page->shelf_x = shelf_x + width;
+	page->shelf_y = shelf_y;
+	page->shelf_h = math_max( shelf_h, height );
+
+	return true;
+}
+
+static void mgui_opengl_atlas_upload( uint32 x, uint32 y, uint32 width, uint32 height, GLenum format, GLenum type, const void* pixels )
+{
+	glPushClientAttrib( GL_CLIENT_PIXEL_STORE_BIT );
+
+	glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, width );
+
+	glTexSubImage2D( GL_TEXTURE_2D, 0, x, y, width, height, format, type, pixels );
+
+	// Repeat the edges of the image into the border, so that linear filtering doesn't blend in the neighbouring images.
+	glTexSubImage2D( GL_TEXTURE_2D, 0, x - 1, y, 1, height, format, type, pixels );
+	glTexSubImage2D( GL_TEXTURE_2D, 0, x, y - 1, width, 1, format, type, pixels );
+
+	glPixelStorei( GL_UNPACK_SKIP_PIXELS, width - 1 );
+	glTexSubImage2D( GL_TEXTURE_2D, 0, x + width, y, 1, height, format, type, pixels );
+
+	glPixelStorei( GL_UNPACK_SKIP_PIXELS, 0 );
+	glPixelStorei( GL_UNPACK_SKIP_ROWS, height - 1 );
+	glTexSubImage2D( GL_TEXTURE_2D, 0, x, y + height, width, 1, format, type, pixels );
+
+	glPopClientAttrib();
+}
@@ -0,0 +1,51 @@
+/**********************************************************************
+ *
+ * PROJECT:		Mylly GUI - OpenGL Renderer
+ * FILE:		Atlas.h
+ * LICENCE:		See Licence.txt
+ * PURPOSE:		An OpenGL reference renderer for Mylly GUI.
+ *				Texture atlas shared by textures and fonts.
+ *
+ *				(c) Tuomo Jauhiainen 2013
+ *
+ **********************************************************************/
+
+#pragma once
+#ifndef __MYLLY_GUI_OPENGL_ATLAS_H
+#define __MYLLY_GUI_OPENGL_ATLAS_H
+
+#include "Extensions.h"
+
+#define ATLAS_PAGE_SIZE		1024	// Default width and height of an atlas page
+#define ATLAS_WHITE_SIZE	4		// Size of the white block on each page
+
+// A single texture that images are packed into. Each page also contains a block of
+// white texels, which is used to draw untextured primitives without switching textures.
+typedef struct AtlasPage {
+	struct AtlasPage*	next;
+	GLuint				texture;		// OpenGL texture of the page
+	uint32				size;			// Width and height of the page in pixels
+	uint32				shelf_x;		// Position of the next image on the current shelf
+	uint32				shelf_y;		// Top of the current shelf
+	uint32				shelf_h;		// Height of the current shelf
+	uint32				regions;		// Number of images on the page
+	float				white_u;		// Texture coordinates of the white block
+	float				white_v;
+} AtlasPage;
+
+// Location of an image within an atlas page.
+typedef struct {
+	AtlasPage*	page;			// Page the image has been packed into
+	float		u;				// Texture coordinates of the image on the page
+	float		v;
+	float		u_scale;		// Size of the image relative to the page
+	float		v_scale;
+} AtlasRegion;
+
+void			mgui_opengl_atlas_initialize	( void );
+void			mgui_opengl_atlas_shutdown		( void );
+AtlasPage*		mgui_opengl_atlas_get_page		( void );
+bool			mgui_opengl_atlas_add			( AtlasRegion* region, uint32 width, uint32 height, GLenum format, GLenum type, const void* pixels );
+void			mgui_opengl_atlas_remove		( AtlasRegion* region );
+
+#endif /* __MYLLY_GUI_OPENGL_ATLAS_H */
@@ -25,6 +25,7 @@
 
 bool MYLLY_EXT_framebuffer_object = false;
 bool MYLLY_ARB_vertex_buffer_object = false;
+bool MYLLY_ARB_map_buffer_range = false;
 bool MYLLY_GL_2_0 = false;
 
 // --------------------------------------------------
@@ -41,8 +42,9 @@ glDeleteBuffersARB_t __glDeleteBuffersARB = NULL;
 glBufferDataARB_t __glBufferDataARB = NULL;
 glBufferSubDataARB_t __glBufferSubDataARB = NULL;
 glMapBufferARB_t __glMapBufferARB = NULL;
-glMapBufferRangeARB_t __glMapBufferRangeARB = NULL;
 glUnmapBufferARB_t __glUnmapBufferARB = NULL;
+
+glMapBufferRangeARB_t __glMapBufferRangeARB = NULL;
 glFlushMappedBufferRangeARB_t __glFlushMappedBufferRangeARB = NULL;
 
 glDrawBuffers_t __glDrawBuffers = NULL;
@@ -51,6 +53,7 @@ glDrawBuffers_t __glDrawBuffers = NULL;
 
 static void mgui_opengl_load_framebuffer_object_EXT( void );
 static void mgui_opengl_load_vertex_buffer_object_ARB( void );
+static void mgui_opengl_load_map_buffer_range_ARB( void );
 static void mgui_opengl_load_gl_2_0( void );
 static size_t mgui_opengl_substr_len( const char* str, char c );
 static bool mgui_opengl_get_extension( const char* name );
@@ -66,6 +69,9 @@ void mgui_opengl_initialize_extensions( void )
 
 	if ( mgui_opengl_get_extension( "GL_ARB_vertex_buffer_object" ) )
 		mgui_opengl_load_vertex_buffer_object_ARB();
+
+	if ( mgui_opengl_get_extension( "GL_ARB_map_buffer_range" ) )
+		mgui_opengl_load_map_buffer_range_ARB();
 }
 
 static void mgui_opengl_load_framebuffer_object_EXT( void )
@@ -91,13 +97,22 @@ static void mgui_opengl_load_vertex_buffer_object_ARB( void )
 	result = ( ( __glBufferDataARB = (glBufferDataARB_t)myllyGetProcAddress( (const GLubyte*)"glBufferDataARB" ) ) != NULL ) && result;
 	result = ( ( __glBufferSubDataARB = (glBufferSubDataARB_t)myllyGetProcAddress( (const GLubyte*)"glBufferSubDataARB" ) ) != NULL ) && result;
 	result = ( ( __glMapBufferARB = (glMapBufferARB_t)myllyGetProcAddress( (const GLubyte*)"glMapBufferARB" ) ) != NULL ) && result;
-	result = ( ( __glMapBufferRangeARB = (glMapBufferRangeARB_t)myllyGetProcAddress( (const GLubyte*)"glMapBufferRangeARB" ) ) != NULL ) && result;
 	result = ( ( __glUnmapBufferARB = (glUnmapBufferARB_t)myllyGetProcAddress( (const GLubyte*)"glUnmapBufferARB" ) ) != NULL ) && result;
-	result = ( ( __glFlushMappedBufferRangeARB = (glFlushMappedBufferRangeARB_t)myllyGetProcAddress( (const GLubyte*)"glFlushMappedBufferRangeARB" ) ) != NULL ) && result;
 
 	MYLLY_ARB_vertex_buffer_object = result;
 }
 
+static void mgui_opengl_load_map_buffer_range_ARB( void )
+{
+	bool result = true;
+
+	// ARB_map_buffer_range is a core subset extension, its entry points don't have the ARB suffix.
+	result = ( ( __glMapBufferRangeARB = (glMapBufferRangeARB_t)myllyGetProcAddress( (const GLubyte*)"glMapBufferRange" ) ) != NULL ) && result;
+	result = ( ( __glFlushMappedBufferRangeARB = (glFlushMappedBufferRangeARB_t)myllyGetProcAddress( (const GLubyte*)"glFlushMappedBufferRange" ) ) != NULL ) && result;
+
+	MYLLY_ARB_map_buffer_range = result;
+}
+
 static void mgui_opengl_load_gl_2_0( void )
 {
 	bool result = true;
@@ -118,7 +133,7 @@ static bool mgui_opengl_get_extension( const char* name )
 	{
 		n = mgui_opengl_substr_len( s, ' ' );
 
-		if ( n == len && strncmp( name, s, n ) )
+		if ( n == len && strncmp( name, s, n ) == 0 )
 			return true;
 
 		s += n+1;
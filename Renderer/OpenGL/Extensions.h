@@ -62,9 +62,7 @@ typedef void ( EXTAPIENTRY *glDeleteBuffersARB_t )( GLsizei n, GLuint* ids );
 typedef void ( EXTAPIENTRY *glBufferDataARB_t )( GLenum target, GLsizei size, const void* data, GLenum usage );
 typedef void ( EXTAPIENTRY *glBufferSubDataARB_t )( GLenum target, GLint offset, GLsizei size, void* data );
 typedef void* ( EXTAPIENTRY *glMapBufferARB_t )( GLenum target, GLenum access );
-typedef void* ( EXTAPIENTRY *glMapBufferRangeARB_t )( GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access );
 typedef GLboolean ( EXTAPIENTRY *glUnmapBufferARB_t )( GLenum target );
-typedef void ( EXTAPIENTRY *glFlushMappedBufferRangeARB_t )( GLenum target, GLintptr offset, GLsizeiptr length );
 
 glGenBuffersARB_t __glGenBuffersARB;
 glBindBufferARB_t __glBindBufferARB;
@@ -72,9 +70,7 @@ glDeleteBuffersARB_t __glDeleteBuffersARB;
 glBufferDataARB_t __glBufferDataARB;
 glBufferSubDataARB_t __glBufferSubDataARB;
 glMapBufferARB_t __glMapBufferARB;
-glMapBufferRangeARB_t __glMapBufferRangeARB;
 glUnmapBufferARB_t __glUnmapBufferARB;
-glFlushMappedBufferRangeARB_t __glFlushMappedBufferRangeARB;
 
 #define glGenBuffersARB __glGenBuffersARB
 #define glBindBufferARB __glBindBufferARB
@@ -82,8 +78,22 @@ glFlushMappedBufferRangeARB_t __glFlushMappedBufferRangeARB;
 #define glBufferDataARB __glBufferDataARB
 #define glBufferSubDataARB __glBufferSubDataARB
 #define glMapBufferARB __glMapBufferARB
-#define glMapBufferRangeARB __glMapBufferRangeARB
 #define glUnmapBufferARB __glUnmapBufferARB
+
+
+// --------------------------------------------------
+// --- ARB_map_buffer_range
+// --------------------------------------------------
+
+extern bool MYLLY_ARB_map_buffer_range;
+
+typedef void* ( EXTAPIENTRY *glMapBufferRangeARB_t )( GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access );
+typedef void ( EXTAPIENTRY *glFlushMappedBufferRangeARB_t )( GLenum target, GLintptr offset, GLsizeiptr length );
+
+glMapBufferRangeARB_t __glMapBufferRangeARB;
+glFlushMappedBufferRangeARB_t __glFlushMappedBufferRangeARB;
+
+#define glMapBufferRangeARB __glMapBufferRangeARB
 #define glFlushMappedBufferRangeARB __glFlushMappedBufferRangeARB
 
 
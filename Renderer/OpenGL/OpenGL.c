@@ -59,6 +59,7 @@ MGuiRenderer* mgui_opengl_initialize( void* window )
 	renderer.destroy_font			= renderer_destroy_font;
 	renderer.draw_text				= renderer_draw_text;
 	renderer.measure_text			= renderer_measure_text;
+	renderer.measure_glyphs			= renderer_measure_glyphs;
 	renderer.create_render_target	= renderer_create_render_target;
 	renderer.destroy_render_target	= renderer_destroy_render_target;
 	renderer.draw_render_target		= renderer_draw_render_target;
@@ -14,6 +14,8 @@
 
 #include "OpenGL.h"
 #include "Renderer.h"
+#include "Platform/Alloc.h"
+#include <string.h>
 
 // --------------------------------------------------
 
@@ -69,43 +71,37 @@ void mgui_opengl_swap_buffers( void )
 	SwapBuffers( dc );
 }
 
-GLuint mgui_opengl_load_bitmap_texture( const char_t* path, uint32* width, uint32* height )
+void* mgui_opengl_load_bitmap( const char_t* path, uint32* width, uint32* height )
 {
-	uint32 w = 32, h = 32;
 	HBITMAP bitmap;
-	GLuint texture;
+	void* pixels;
 	BITMAP bm = { 0 };
 
 	// Attempt to load the bitmap.
 	bitmap = (HBITMAP)LoadImage( GetModuleHandle( NULL ), path, IMAGE_BITMAP, 0, 0, LR_LOADFROMFILE|LR_CREATEDIBSECTION );
 
-	if ( bitmap == NULL ) return 0;
+	if ( bitmap == NULL ) return NULL;
 
 	// Get info about the loaded bitmap (dimensions).
 	GetObject( bitmap, sizeof(bm), &bm );
 
+	// Only 32bit bitmaps can be copied as they are.
+	if ( bm.bmBits == NULL || bm.bmBitsPixel != 32 )
+	{
+		DeleteObject( bitmap );
+		return NULL;
+	}
+
 	*width = bm.bmWidth;
 	*height = bm.bmHeight;
 
-	// Make sure that the dimensions are a power of two (required for the texture).
-	while ( w < *width ) w <<= 1;
-	while ( h < *height ) h <<= 1;
-
-	// Create a texture and copy the bitmap to it.
-	glGenTextures( 1, &texture );
-	glBindTexture( GL_TEXTURE_2D, texture );
+	// Copy the pixels, the renderer packs them into the texture atlas.
+	pixels = mem_alloc( bm.bmWidthBytes * bm.bmHeight );
+	memcpy( pixels, bm.bmBits, bm.bmWidthBytes * bm.bmHeight );
 
-	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
-	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
-	
-	glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, bm.bmWidth, bm.bmHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, bm.bmBits );
-	
 	DeleteObject( bitmap );
 
-	*width = w;
-	*height = h;
-
-	return texture;
+	return pixels;
 }
 
 #endif /* _WIN32 */
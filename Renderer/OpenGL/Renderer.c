@@ -12,10 +12,14 @@
 #include "Renderer.h"
 #include "Platform/Alloc.h"
 #include "../Shared/Windows/FontLoader.h"
+#include <string.h>
 
 // --------------------------------------------------
 
-#define MAX_VERT (1024)
+#define MAX_QUADS		(16384)								// Maximum number of quads per draw call (limited by 16bit indices)
+#define MAX_VERTICES	(4*MAX_QUADS)
+#define MAX_INDICES		(6*MAX_QUADS)
+#define STREAM_SIZE		(4*MAX_VERTICES*sizeof(Vertex))		// Size of the streaming vertex buffer in bytes
 
 // --------------------------------------------------
 
@@ -25,7 +29,7 @@ typedef struct {
 	uint32		width;
 	uint32		height;
 	void*		texture_bits;
-	GLuint		texture;
+	AtlasRegion	region;
 	float**		tex_coords;
 	uint32		tex_data_len;
 } Font;
@@ -34,7 +38,7 @@ typedef struct {
 
 typedef struct {
 	MGuiRendTexture	data;
-	GLuint			texture;
+	AtlasRegion		region;
 	void*			texture_bits;
 } Texture;
 
@@ -60,16 +64,20 @@ typedef struct {
 // --------------------------------------------------
 
 static uint32		num_vertices			= 0;			// Number of vetrices stored into the buffer
-static uint32		num_indices				= 0;			// Number of indices stored into the index buffer
 static Vertex*		vertex					= NULL;			// Pointer to current vertex
-static GLushort*	index					= NULL;			// Pointer to current index
-static Vertex		vertex_buffer[MAX_VERT];				// Vertex buffer
-static GLushort		index_buffer[MAX_VERT];					// Index buffer
+static Vertex		vertex_buffer[MAX_VERTICES];			// Vertices of the current batch
+static GLushort		index_buffer[MAX_INDICES];				// Indices for a batch of quads, these never change
+static GLuint		stream_vbo				= 0;			// Streaming vertex buffer object (0 if VBOs are not supported)
+static GLuint		index_vbo				= 0;			// Static index buffer object
+static uint32		stream_offset			= 0;			// Write offset of the streaming vertex buffer in bytes
 static DRAW_MODE	draw_mode				= DRAWING_2D;	// Current draw mode
 static GLbyte		colour[4]				= { 0,0,0,0 };	// Current drawing colour in OpenGL format
 static colour_t		draw_colour				= { 0 };		// Current drawing colour
 static float		draw_depth				= 1.0f;			// Current drawing z depth
 static GLuint		draw_texture			= 0;			// Current texture pointer
+static AtlasPage*	draw_page				= NULL;			// Atlas page of the current texture (NULL for render targets)
+static float		white_u					= 0.0f;			// Texture coordinates used for untextured primitives
+static float		white_v					= 0.0f;
 static rectangle_t	clip_rect;								// Clip rectangle
 static bool			is_clipping				= false;		// Is clipping mode active?
 static LINE_STATUS	line_status				= LINE_IDLE;	// Text underline status
@@ -87,7 +95,9 @@ MYLLY_INLINE static void	renderer_add_vertex_2d			( int32 x, int32 y, float z );
 MYLLY_INLINE static void	renderer_add_vertex_tex			( int32 x, int32 y, float u, float v );
 MYLLY_INLINE static void	renderer_add_vertex_tex_2d		( int32 x, int32 y, float z, float u, float v );
 MYLLY_INLINE static void	renderer_check_buffer_for_space	( uint32 vertices );
+MYLLY_INLINE static void	renderer_set_texture			( GLuint texture, AtlasPage* page );
 MYLLY_INLINE static uint32	renderer_draw_char				( const Font* font, uint32 c, int32 x, int32 y, uint32 flags );
+MYLLY_INLINE static uint32	renderer_get_char_advance		( const Font* font, uint32 c );
 static void					renderer_process_tag			( const MGuiFormatTag* tag );
 static void					renderer_process_underline		( const Font* font, int32 x, int32 y, int32* x2, int32* y2, colour_t* line_colour );
 static void					renderer_create_font_texture	( void* data, uint32 width, uint32 height, void** texture, uint32* texture_pitch );
@@ -95,18 +105,61 @@ static void					renderer_create_bitmap_texture	( void* data, uint32 width, uint3
 
 // These are platform dependent functions, so they're defined in OpenGLWin32.c.
 void						mgui_opengl_swap_buffers		( void );
-GLuint						mgui_opengl_load_bitmap_texture	( const char_t* path, uint32* width, uint32* height );
+void*						mgui_opengl_load_bitmap			( const char_t* path, uint32* width, uint32* height );
 
 // --------------------------------------------------
 
 void renderer_initialize( void )
 {
-	// Nothing to do here.
+	uint32 i;
+	GLushort idx;
+
+	// Textures and fonts are packed into shared pages so that most of the GUI can be drawn
+	// without switching textures. Untextured primitives use the white block of the page.
+	mgui_opengl_atlas_initialize();
+
+	// Everything is drawn as quads (triangles are quads with the last vertex repeated),
+	// so the indices are the same for every batch and can be built only once.
+	for ( i = 0, idx = 0; i < MAX_INDICES; i += 6, idx += 4 )
+	{
+		index_buffer[i+0] = idx;
+		index_buffer[i+1] = (GLushort)( idx+1 );
+		index_buffer[i+2] = (GLushort)( idx+2 );
+		index_buffer[i+3] = (GLushort)( idx+1 );
+		index_buffer[i+4] = (GLushort)( idx+3 );
+		index_buffer[i+5] = (GLushort)( idx+2 );
+	}
+
+	if ( !MYLLY_ARB_vertex_buffer_object ) return;
+
+	glGenBuffersARB( 1, &index_vbo );
+	glBindBufferARB( GL_ELEMENT_ARRAY_BUFFER_ARB, index_vbo );
+	glBufferDataARB( GL_ELEMENT_ARRAY_BUFFER_ARB, sizeof(index_buffer), index_buffer, GL_STATIC_DRAW_ARB );
+	glBindBufferARB( GL_ELEMENT_ARRAY_BUFFER_ARB, 0 );
+
+	glGenBuffersARB( 1, &stream_vbo );
+	glBindBufferARB( GL_ARRAY_BUFFER_ARB, stream_vbo );
+	glBufferDataARB( GL_ARRAY_BUFFER_ARB, STREAM_SIZE, NULL, GL_STREAM_DRAW_ARB );
+	glBindBufferARB( GL_ARRAY_BUFFER_ARB, 0 );
+
+	stream_offset = 0;
 }
 
 void renderer_shutdown( void )
 {
-	// Nothing to do here either.
+	mgui_opengl_atlas_shutdown();
+
+	if ( stream_vbo != 0 )
+	{
+		glDeleteBuffersARB( 1, &stream_vbo );
+		stream_vbo = 0;
+	}
+
+	if ( index_vbo != 0 )
+	{
+		glDeleteBuffersARB( 1, &index_vbo );
+		index_vbo = 0;
+	}
 }
 
 void renderer_begin( void )
@@ -122,11 +175,20 @@ void renderer_begin( void )
 	glEnableClientState( GL_COLOR_ARRAY );
 	glEnableClientState( GL_TEXTURE_COORD_ARRAY );
 
-	vertex = &vertex_buffer[0];
-	index = &index_buffer[0];
+	// Texturing is always on, untextured primitives are drawn using a white texel.
+	glEnable( GL_TEXTURE_2D );
 
+	draw_texture = 0;
+	draw_page = NULL;
+
+	if ( stream_vbo != 0 )
+	{
+		glBindBufferARB( GL_ARRAY_BUFFER_ARB, stream_vbo );
+		glBindBufferARB( GL_ELEMENT_ARRAY_BUFFER_ARB, index_vbo );
+	}
+
+	vertex = &vertex_buffer[0];
 	num_vertices = 0;
-	num_indices = 0;
 }
 
 void renderer_end( void )
@@ -137,11 +199,16 @@ void renderer_end( void )
 	glDisableClientState( GL_COLOR_ARRAY );
 	glDisableClientState( GL_TEXTURE_COORD_ARRAY );
 
-	vertex = &vertex_buffer[0];
-	index = &index_buffer[0];
+	glDisable( GL_TEXTURE_2D );
 
+	if ( stream_vbo != 0 )
+	{
+		glBindBufferARB( GL_ARRAY_BUFFER_ARB, 0 );
+		glBindBufferARB( GL_ELEMENT_ARRAY_BUFFER_ARB, 0 );
+	}
+
+	vertex = &vertex_buffer[0];
 	num_vertices = 0;
-	num_indices = 0;
 
 	// Do platform specific processing (swap buffers).
 	mgui_opengl_swap_buffers();
@@ -237,54 +304,39 @@ void renderer_end_clip( void )
 
 void renderer_draw_rect( int32 x, int32 y, uint32 w, uint32 h )
 {
-	GLushort idx1, idx2;
+	AtlasPage* page;
 
-	if ( draw_texture != 0 )
+	// Any atlas page will do, only render targets lack a white texel.
+	if ( draw_page == NULL )
 	{
-		renderer_flush();
-
-		glDisable( GL_TEXTURE_2D );
-		draw_texture = 0;
+		page = mgui_opengl_atlas_get_page();
+		renderer_set_texture( page->texture, page );
 	}
 
-	renderer_check_buffer_for_space( 6 );
+	renderer_check_buffer_for_space( 4 );
 
-	*index++ = (GLushort)num_vertices;
 	renderer_add_vertex( x, y );
-
-	idx1 = (GLushort)num_vertices; *index++ = idx1;
 	renderer_add_vertex( x+w, y );
-
-	idx2 = (GLushort)num_vertices; *index++ = idx2;
 	renderer_add_vertex( x, y+h );
-
-	*index++ = idx1;
-
-	*index++ = (GLushort)num_vertices;
 	renderer_add_vertex( x+w, y+h );
-	
-	*index++ = idx2;
 }
 
 void renderer_draw_triangle( int32 x1, int32 y1, int32 x2, int32 y2, int32 x3, int32 y3 )
 {
-	if ( draw_texture != 0 )
-	{
-		renderer_flush();
+	AtlasPage* page;
 
-		glDisable( GL_TEXTURE_2D );
-		draw_texture = 0;
+	if ( draw_page == NULL )
+	{
+		page = mgui_opengl_atlas_get_page();
+		renderer_set_texture( page->texture, page );
 	}
 
-	renderer_check_buffer_for_space( 3 );
+	renderer_check_buffer_for_space( 4 );
 
-	*index++ = (GLushort)num_vertices;
+	// Triangles are drawn as degenerate quads so they can share the static index buffer.
 	renderer_add_vertex( x1, y1 );
-
-	*index++ = (GLushort)num_vertices;
 	renderer_add_vertex( x2, y2 );
-
-	*index++ = (GLushort)num_vertices;
+	renderer_add_vertex( x3, y3 );
 	renderer_add_vertex( x3, y3 );
 }
 
@@ -296,7 +348,8 @@ void renderer_draw_pixel( int32 x, int32 y )
 MGuiRendTexture* renderer_load_texture( const char_t* path, uint32* width, uint32* height )
 {
 	Texture* texture;
-	GLuint tex;
+	void* pixels;
+	bool ret;
 
 	if ( path == NULL ||
 		 width == NULL ||
@@ -306,17 +359,31 @@ MGuiRendTexture* renderer_load_texture( const char_t* path, uint32* width, uint3
 	texture = mem_alloc_clean( sizeof(*texture) );
 	
 	// Request bitmap loading.
-	tex = mgui_opengl_load_bitmap_texture( path, width, height );
-	if ( tex == 0 )
+	pixels = mgui_opengl_load_bitmap( path, width, height );
+	if ( pixels == NULL )
 	{
 		// Something broke, clean up and exit.
 		mem_free( texture );
 		return NULL;
 	}
 
+	// Copy the bitmap into the texture atlas.
+	ret = mgui_opengl_atlas_add( &texture->region, *width, *height, GL_RGBA, GL_UNSIGNED_BYTE, pixels );
+
+	mem_free( pixels );
+
+	// Adding to the atlas changed the texture binding.
+	draw_texture = 0;
+	draw_page = NULL;
+
+	if ( !ret )
+	{
+		mem_free( texture );
+		return NULL;
+	}
+
 	texture->data.width = *width;
 	texture->data.height = *height;
-	texture->texture = tex;
 
 	return (MGuiRendTexture*)texture;
 }
@@ -327,44 +394,41 @@ void renderer_destroy_texture( MGuiRendTexture* tex )
 
 	if ( texture == NULL ) return;
 
-	glDeleteTextures( 1, &texture->texture );
+	if ( texture->region.page == draw_page )
+	{
+		// The page may be destroyed along with the texture.
+		renderer_flush();
+		draw_texture = 0;
+		draw_page = NULL;
+	}
+
+	mgui_opengl_atlas_remove( &texture->region );
 	mem_free( texture );
 }
 
 void renderer_draw_textured_rect( const MGuiRendTexture* tex, int32 x, int32 y, uint32 w, uint32 h, const float uv[] )
 {
 	Texture* texture = (Texture*)tex;
-	GLushort idx1, idx2;
+	const AtlasRegion* region;
+	float u1, v1, u2, v2;
 
 	if ( texture == NULL ) return;
 
-	if ( draw_texture == 0 || draw_texture != texture->texture )
-	{
-		renderer_flush();
-
-		draw_texture = texture->texture;
-
-		glBindTexture( GL_TEXTURE_2D, texture->texture );
-		glEnable( GL_TEXTURE_2D );
-	}
-
-	renderer_check_buffer_for_space( 6 );
+	region = &texture->region;
+	renderer_set_texture( region->page->texture, region->page );
 
-	*index++ = (GLushort)num_vertices;
-	renderer_add_vertex_tex( x, y, uv[0], 1 - uv[1] );
+	// Map the texture coordinates to the area of the texture on the atlas page.
+	u1 = region->u + uv[0] * region->u_scale;
+	u2 = region->u + uv[2] * region->u_scale;
+	v1 = region->v + ( 1 - uv[1] ) * region->v_scale;
+	v2 = region->v + ( 1 - uv[3] ) * region->v_scale;
 
-	idx1 = (GLushort)num_vertices; *index++ = idx1;
-	renderer_add_vertex_tex( x+w, y, uv[2], 1 - uv[1] );
+	renderer_check_buffer_for_space( 4 );
 
-	idx2 = (GLushort)num_vertices; *index++ = idx2;
-	renderer_add_vertex_tex( x, y+h, uv[0], 1 - uv[3] );
-
-	*index++ = idx1;
-
-	*index++ = (GLushort)num_vertices;
-	renderer_add_vertex_tex( x+w, y+h, uv[2], 1 - uv[3] );
-
-	*index++ = idx2;
+	renderer_add_vertex_tex( x, y, u1, v1 );
+	renderer_add_vertex_tex( x+w, y, u2, v1 );
+	renderer_add_vertex_tex( x, y+h, u1, v2 );
+	renderer_add_vertex_tex( x+w, y+h, u2, v2 );
 }
 
 MGuiRendFont* renderer_load_font( const char_t* name, uint8 size, uint8 flags, uint8 charset, uint32 firstc, uint32 lastc )
@@ -399,18 +463,24 @@ MGuiRendFont* renderer_load_font( const char_t* name, uint8 size, uint8 flags, u
 	font->height = info.height;
 	font->spacing = info.spacing;
 
-	// Copy the font glyphs into an OpenGL texture.
-	glGenTextures( 1, &font->texture );
-	glBindTexture( GL_TEXTURE_2D, font->texture );
+	// Copy the font glyphs into the texture atlas.
+	ret = mgui_opengl_atlas_add( &font->region, font->width, font->height, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4_REV, font->texture_bits );
 
-	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
-	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+	// Adding to the atlas changed the texture binding.
+	draw_texture = 0;
+	draw_page = NULL;
 
-	glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA4, font->width, font->height, 0, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4_REV, font->texture_bits );
-	
 	// We no longer need the raw glyphs.
 	SAFE_DELETE( font->texture_bits );
 
+	if ( !ret )
+	{
+		mem_free( font->tex_coords[0] );
+		mem_free( font->tex_coords );
+		mem_free( font );
+		return NULL;
+	}
+
 	return (MGuiRendFont*)font;
 }
 
@@ -426,7 +496,14 @@ void renderer_destroy_font( MGuiRendFont* fnt )
 		mem_free( font->tex_coords );
 	}
 
-	glDeleteTextures( 1, &font->texture );
+	if ( font->region.page == draw_page )
+	{
+		renderer_flush();
+		draw_texture = 0;
+		draw_page = NULL;
+	}
+
+	mgui_opengl_atlas_remove( &font->region );
 
 	mem_free( font );
 }
@@ -445,15 +522,7 @@ void renderer_draw_text( const MGuiRendFont* fnt, const char_t* text, int32 x, i
 
 	line_status = LINE_IDLE;
 
-	if ( draw_texture == 0 || draw_texture != font->texture )
-	{
-		renderer_flush();
-
-		draw_texture = font->texture;
-
-		glBindTexture( GL_TEXTURE_2D, font->texture );
-		glEnable( GL_TEXTURE_2D );
-	}
+	renderer_set_texture( font->region.page->texture, font->region.page );
 
 	if ( tags && ntags > 0 ) tag = &tags[ntag];
 
@@ -475,7 +544,7 @@ void renderer_draw_text( const MGuiRendFont* fnt, const char_t* text, int32 x, i
 			else tag = NULL;
 		}
 
-		if ( c < font->data.first_char || c > font->data.last_char )
+		if ( c < font->data.first_char || c >= font->data.last_char )
 		{
 			continue;
 		}
@@ -485,8 +554,6 @@ void renderer_draw_text( const MGuiRendFont* fnt, const char_t* text, int32 x, i
 		}
 	}
 
-	renderer_flush();
-
 	// Finish the underline in case the end tag was missing
 	if ( line_status == LINE_DRAWING )
 	{
@@ -503,9 +570,7 @@ void renderer_draw_text( const MGuiRendFont* fnt, const char_t* text, int32 x, i
 
 void renderer_measure_text( const MGuiRendFont* fnt, const char_t* text, uint32* width, uint32* height )
 {
-	float x, y, xout;
-	float tmp1, tmp2;
-	uint32 c;
+	uint32 x, c;
 	register const char_t* s;
 	const Font* font = (const Font*)fnt;
 
@@ -516,31 +581,42 @@ void renderer_measure_text( const MGuiRendFont* fnt, const char_t* text, uint32*
 		return;
 	}
 
-	x = xout = 0;
-	y = (float)font->data.size;
+	x = 0;
 
 	for ( s = text; *s; s++ )
 	{
 		c = *(uchar_t*)s;
 
-		if ( c < font->data.first_char || c > font->data.last_char )
+		if ( c < font->data.first_char || c >= font->data.last_char )
 		{
 			continue;
 		}
 		else
 		{
-			c -= font->data.first_char;
-			tmp1 = font->tex_coords[c][0];
-			tmp2 = font->tex_coords[c][2];
-
-			x += ( tmp2 - tmp1 ) * font->width - 2 * font->spacing;
+			x += renderer_get_char_advance( font, c - font->data.first_char );
 		}
 	}	
 
-	xout = math_max( xout, x );
+	*width = x;
+	*height = font->data.size;
+}
+
+void renderer_measure_glyphs( const MGuiRendFont* fnt, uint32 firstc, uint32 lastc, uint16 advances[] )
+{
+	uint32 c;
+	const Font* font = (const Font*)fnt;
 
-	*width = (uint32)xout;
-	*height = (uint32)y;
+	for ( c = firstc; c <= lastc; c++ )
+	{
+		// Characters outside the font are skipped when rendering.
+		if ( font == NULL || c < font->data.first_char || c >= font->data.last_char )
+		{
+			advances[c - firstc] = 0;
+			continue;
+		}
+
+		advances[c - firstc] = (uint16)renderer_get_char_advance( font, c - font->data.first_char );
+	}
 }
 
 
@@ -573,6 +649,9 @@ MGuiRendTarget* renderer_create_render_target( uint32 width, uint32 height )
 	// Create the texture we're going to render to
 	glGenTextures( 1, &target->texture );
 	glBindTexture( GL_TEXTURE_2D, target->texture );
+
+	draw_texture = 0;
+	draw_page = NULL;
 	glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_BGRA, GL_UNSIGNED_BYTE, NULL );
 
 	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
@@ -613,41 +692,23 @@ void renderer_destroy_render_target( MGuiRendTarget* target )
 void renderer_draw_render_target( const MGuiRendTarget* target, int32 x, int32 y, uint32 w, uint32 h )
 {
 	RenderTarget* buffer = (RenderTarget*)target;
-	GLushort idx1, idx2;
 	float u, v;
 	
 	if ( buffer == NULL ) return;
 	if ( buffer->texture == 0 ) return;
 
-	if ( draw_texture == 0 || draw_texture != buffer->texture )
-	{
-		renderer_flush();
-		draw_texture = buffer->texture;
+	// Render targets can't be packed into the atlas, they have to be drawn using their own texture.
+	renderer_set_texture( buffer->texture, NULL );
 
-		glBindTexture( GL_TEXTURE_2D, buffer->texture );
-		glEnable( GL_TEXTURE_2D );
-	}
-
-	renderer_check_buffer_for_space( 6 );
+	renderer_check_buffer_for_space( 4 );
 
 	u = (float)w / buffer->data.width;
 	v = (float)h / buffer->data.height;
 
-	*index++ = (GLushort)num_vertices;
 	renderer_add_vertex_tex( x, y, 0, 1 );
-
-	idx1 = (GLushort)num_vertices; *index++ = idx1;
 	renderer_add_vertex_tex( x+w, y, u, 1 );
-
-	idx2 = (GLushort)num_vertices; *index++ = idx2;
 	renderer_add_vertex_tex( x, y+h, 0, 1 - v );
-
-	*index++ = idx1;
-
-	*index++ = (GLushort)num_vertices;
 	renderer_add_vertex_tex( x+w, y+h, u, 1 - v );
-
-	*index++ = idx2;
 }
 
 void renderer_enable_render_target( const MGuiRendTarget* target, int32 x, int32 y )
@@ -657,6 +718,9 @@ void renderer_enable_render_target( const MGuiRendTarget* target, int32 x, int32
 	if ( target == NULL ) return;
 	if ( !MYLLY_EXT_framebuffer_object ) return;
 
+	// Draw everything batched so far into the current framebuffer.
+	renderer_flush();
+
 	// Store the old framebuffer.
 	glGetIntegerv( GL_FRAMEBUFFER_BINDING_EXT, (GLint*)&buffer->old_buffer );
 
@@ -690,6 +754,8 @@ void renderer_disable_render_target( const MGuiRendTarget* target )
 	if ( target == NULL ) return;
 	if ( !MYLLY_EXT_framebuffer_object ) return;
 
+	renderer_flush();
+
 	// Restore the old framebuffer.
 	glBindFramebufferEXT( GL_FRAMEBUFFER_EXT, buffer->old_buffer );
 
@@ -740,19 +806,68 @@ void renderer_world_pos_to_screen( const vector3_t* src, vector3_t* dst )
 
 static void renderer_flush( void )
 {
+	const Vertex* base;
+	uint32 size;
+	void* data;
+
 	if ( num_vertices == 0 ) return;
 
-	glVertexPointer( 3, GL_FLOAT, sizeof(Vertex), &vertex_buffer[0].x );
-	glColorPointer( 4, GL_UNSIGNED_BYTE, sizeof(Vertex), &vertex_buffer[0].r );
-	glTexCoordPointer( 2, GL_FLOAT, sizeof(Vertex), &vertex_buffer[0].u );
+	size = num_vertices * sizeof(Vertex);
 
-	glDrawElements( GL_TRIANGLES, (GLsizei)num_indices, GL_UNSIGNED_SHORT, &index_buffer[0] );
+	if ( stream_vbo == 0 )
+	{
+		// No VBO support, draw straight from client memory.
+		base = &vertex_buffer[0];
 
-	vertex = &vertex_buffer[0];
-	index = &index_buffer[0];
+		glVertexPointer( 3, GL_FLOAT, sizeof(Vertex), &base->x );
+		glColorPointer( 4, GL_UNSIGNED_BYTE, sizeof(Vertex), &base->r );
+		glTexCoordPointer( 2, GL_FLOAT, sizeof(Vertex), &base->u );
+
+		glDrawElements( GL_TRIANGLES, (GLsizei)( num_vertices / 4 * 6 ), GL_UNSIGNED_SHORT, &index_buffer[0] );
+	}
+	else
+	{
+		// The streaming buffer is used as a ring: batches are appended after each other and the
+		// buffer is orphaned once it's full, so the driver never has to wait for the GPU.
+		if ( stream_offset + size > STREAM_SIZE )
+		{
+			glBufferDataARB( GL_ARRAY_BUFFER_ARB, STREAM_SIZE, NULL, GL_STREAM_DRAW_ARB );
+			stream_offset = 0;
+		}
+
+		data = NULL;
 
+		if ( MYLLY_ARB_map_buffer_range )
+		{
+			// The range has not been written to since the buffer was orphaned, so there's no need to synchronize.
+			data = glMapBufferRangeARB( GL_ARRAY_BUFFER_ARB, stream_offset, size,
+										GL_MAP_WRITE_BIT|GL_MAP_INVALIDATE_RANGE_BIT|GL_MAP_UNSYNCHRONIZED_BIT );
+		}
+
+		if ( data != NULL )
+		{
+			memcpy( data, vertex_buffer, size );
+			glUnmapBufferARB( GL_ARRAY_BUFFER_ARB );
+		}
+		else
+		{
+			glBufferSubDataARB( GL_ARRAY_BUFFER_ARB, stream_offset, size, vertex_buffer );
+		}
+
+		// Vertex pointers are offsets into the bound buffer object.
+		base = (const Vertex*)(size_t)stream_offset;
+
+		glVertexPointer( 3, GL_FLOAT, sizeof(Vertex), &base->x );
+		glColorPointer( 4, GL_UNSIGNED_BYTE, sizeof(Vertex), &base->r );
+		glTexCoordPointer( 2, GL_FLOAT, sizeof(Vertex), &base->u );
+
+		glDrawElements( GL_TRIANGLES, (GLsizei)( num_vertices / 4 * 6 ), GL_UNSIGNED_SHORT, NULL );
+
+		stream_offset += size;
+	}
+
+	vertex = &vertex_buffer[0];
 	num_vertices = 0;
-	num_indices = 0;
 }
 
 MYLLY_FORCE_INLINE static void renderer_add_vertex( int32 x, int32 y )
@@ -779,6 +894,8 @@ MYLLY_FORCE_INLINE static void renderer_add_vertex_2d( int32 x, int32 y, float z
 	vertex->x = (float)x;
 	vertex->y = (float)y;
 	vertex->z = z;
+	vertex->u = white_u;
+	vertex->v = white_v;
 	*(uint32*)&vertex->r = *(uint32*)&colour[0];
 
 	num_vertices++;
@@ -819,13 +936,29 @@ MYLLY_FORCE_INLINE static void renderer_add_vertex_tex_2d( int32 x, int32 y, flo
 
 MYLLY_FORCE_INLINE static void renderer_check_buffer_for_space( uint32 vertices )
 {
-	if ( num_indices + vertices >= MAX_VERT-1 )
+	if ( num_vertices + vertices > MAX_VERTICES )
 	{
-		// Vertex/index buffer is almost full, flush the buffers.
+		// The batch is full, flush the buffers.
 		renderer_flush();
 	}
+}
+
+MYLLY_FORCE_INLINE static void renderer_set_texture( GLuint texture, AtlasPage* page )
+{
+	if ( texture == draw_texture ) return;
+
+	renderer_flush();
+
+	draw_texture = texture;
+	draw_page = page;
 
-	num_indices += vertices;
+	if ( page != NULL )
+	{
+		white_u = page->white_u;
+		white_v = page->white_v;
+	}
+
+	glBindTexture( GL_TEXTURE_2D, texture );
 }
 
 MYLLY_FORCE_INLINE static uint32 renderer_draw_char( const Font* font, uint32 c, int32 x, int32 y, uint32 flags )
@@ -834,7 +967,6 @@ MYLLY_FORCE_INLINE static uint32 renderer_draw_char( const Font* font, uint32 c,
 	uint32 w, h, spacing;
 	colour_t col;
 	rectangle_t r;
-	GLushort idx1, idx2;
 	static colour_t shadow_colour = { 0 };
 	static int32 shadow_offset = 1;
 
@@ -847,12 +979,18 @@ MYLLY_FORCE_INLINE static uint32 renderer_draw_char( const Font* font, uint32 c,
 	h = (uint32)( ( ty1 - ty2 ) * font->height );
 	spacing = (uint32)font->spacing * 2;
 
+	// Map the glyph to the area of the font on the atlas page.
+	tx1 = font->region.u + tx1 * font->region.u_scale;
+	tx2 = font->region.u + tx2 * font->region.u_scale;
+	ty1 = font->region.v + ty1 * font->region.v_scale;
+	ty2 = font->region.v + ty2 * font->region.v_scale;
+
 	r.x = (int16)x, r.y = (int16)y, r.w = (uint16)w, r.h = (uint16)h;
 
 	if ( is_clipping && (
 		 x < (int32)clip_rect.x || (int32)(x+w) > (int32)clip_rect.x+clip_rect.w+spacing+1 ) )
 	{
-		return ( w - spacing );
+		return renderer_get_char_advance( font, c );
 	}
 
 	if ( flags & TFLAG_SHADOW )
@@ -862,46 +1000,34 @@ MYLLY_FORCE_INLINE static uint32 renderer_draw_char( const Font* font, uint32 c,
 		col.hex = draw_colour.hex;
 		renderer_set_draw_colour( &shadow_colour );
 
-		renderer_check_buffer_for_space( 6 );
+		renderer_check_buffer_for_space( 4 );
 
-		*index++ = (GLushort)num_vertices;
 		renderer_add_vertex_tex( x+shadow_offset, y+shadow_offset, tx1, ty1 );
-
-		idx1 = (GLushort)num_vertices; *index++ = idx1;
 		renderer_add_vertex_tex( x+w+shadow_offset, y+shadow_offset, tx2, ty1 );
-
-		idx2 = (GLushort)num_vertices; *index++ = idx2;
 		renderer_add_vertex_tex( x+shadow_offset, y+h+shadow_offset, tx1, ty2 );
-
-		*index++ = idx1;
-
-		*index++ = (GLushort)num_vertices;
 		renderer_add_vertex_tex( x+w+shadow_offset, y+h+shadow_offset, tx2, ty2 );
 
-		*index++ = idx2;
-
 		renderer_set_draw_colour( &col );
 	}
 
-	renderer_check_buffer_for_space( 6 );
+	renderer_check_buffer_for_space( 4 );
 
-	*index++ = (GLushort)num_vertices;
 	renderer_add_vertex_tex( x, y, tx1, ty1 );
-
-	idx1 = (GLushort)num_vertices; *index++ = idx1;
 	renderer_add_vertex_tex( x+w, y, tx2, ty1 );
-
-	idx2 = (GLushort)num_vertices; *index++ = idx2;
 	renderer_add_vertex_tex( x, y+h, tx1, ty2 );
+	renderer_add_vertex_tex( x+w, y+h, tx2, ty2 );
 
-	*index++ = idx1;
+	return renderer_get_char_advance( font, c );
+}
 
-	*index++ = (GLushort)num_vertices;
-	renderer_add_vertex_tex( x+w, y+h, tx2, ty2 );
+MYLLY_FORCE_INLINE static uint32 renderer_get_char_advance( const Font* font, uint32 c )
+{
+	float advance;
 
-	*index++ = idx2;
+	// Round the advance once so that drawing and measuring step the pen by the same amount.
+	advance = ( font->tex_coords[c][2] - font->tex_coords[c][0] ) * font->width - 2 * font->spacing;
 
-	return ( w - 2 * font->spacing );
+	return advance > 0 ? (uint32)( advance + 0.5f ) : 0;
 }
 
 static void renderer_process_tag( const MGuiFormatTag* tag )
@@ -957,15 +1083,9 @@ static void renderer_process_underline( const Font* font, int32 x, int32 y, int3
 	case LINE_DRAW:
 		col = draw_colour;
 
-		renderer_flush();
+		// The line uses the white block of the font's atlas page, so it goes into the same batch as the text.
 		renderer_set_draw_colour( line_colour );
-
 		renderer_draw_rect( *x2, *y2, x - *x2, 1 );
-		renderer_flush();
-
-		draw_texture = font->texture;
-		glEnable( GL_TEXTURE_2D );
-
 		renderer_set_draw_colour( &col );
 
 		if ( line_continue )
@@ -15,6 +15,7 @@
 
 #include "MGUI/Renderer/Renderer.h"
 #include "Extensions.h" // This will automatically include the OpenGL headers
+#include "Atlas.h"
 
 // Used for drawing an underline for text (format tags)
 typedef enum {
@@ -59,6 +60,7 @@ void				renderer_draw_text					( const MGuiRendFont* font, const char_t* text, i
 														  uint32 flags, const MGuiFormatTag tags[], uint32 ntags );
 
 void				renderer_measure_text				( const MGuiRendFont* font, const char_t* text, uint32* w, uint32* h );
+void				renderer_measure_glyphs				( const MGuiRendFont* font, uint32 firstc, uint32 lastc, uint16 advances[] );
 
 MGuiRendTarget*		renderer_create_render_target		( uint32 width, uint32 height );
 void				renderer_destroy_render_target		( MGuiRendTarget* target );
@@ -21,10 +21,19 @@ enum RENDPROPS {
 	REND_SUPPORTS_TEXTTAGS	= 1 << 0,	// Renderer supports text format tags
 	REND_SUPPORTS_TEXTURES	= 1 << 1,	// Renderer supports textures
 	REND_SUPPORTS_TARGETS	= 1 << 2,	// Renderer supports render targets (cache)
-	REND_RESET_ON_RESIZE	= 1 << 3,	// Renderer must be reset when resizing
+	REND_RESET_ON_RESIZE	= 1 << 3,	// Renderer must be reset when resizing (all resources are reloaded unless REND_RESET_* flags are set)
+	REND_SUPPORTS_DAMAGE	= 1 << 4,	// Renderer can redraw only the damaged parts of the window
+	REND_RESET_TARGETS		= 1 << 5,	// Render targets are lost when resizing
+	REND_RESET_TEXTURES		= 1 << 6,	// Textures are lost when resizing
+	REND_RESET_FONTS		= 1 << 7,	// Fonts are lost when resizing
+	REND_THREADED_FONTS		= 1 << 8,	// load_font can be called from a background thread
 	REND_FORCE_DWORD		= 0x7fffffff
 };
 
+// Maximum number of separate rectangles in a damage region. When the region runs
+// out of rectangles, new areas are merged into the closest existing one.
+#define MAX_DAMAGE_RECTS 8
+
 typedef enum {
 	DRAWING_INVALID,
 	DRAWING_2D,			// Draw 2D entities on top of everything else
@@ -38,6 +47,7 @@ enum {
 	TFLAG_SHADOW		= 1 << 1,	// Text has a shadow
 	TFLAG_BOLD			= 1 << 2,	// Font used by the text is bold
 	TFLAG_ITALIC		= 1 << 3,	// Font used by the text is cursive
+	TFLAG_DEFERRED		= 1 << 4,	// Text is measured later (used internally by layout transactions)
 };
 
 enum {
@@ -85,6 +95,12 @@ struct MGuiRenderer
 	void			( *end )					( void );
 	void			( *resize )					( uint32 w, uint32 h );
 
+	// Called right before begin for every scene that draws to the screen, if the renderer has
+	// REND_SUPPORTS_DAMAGE set. Only the given areas should be cleared and drawn to during the next scene.
+	// If count is 0 the whole window is redrawn. Scenes which only refresh cached render targets
+	// are not preceded by this call, and must leave the screen untouched.
+	void			( *set_damage_rects )		( const rectangle_t rects[], uint32 count );
+
 	// --------------------------------------------------
 	// Draw modes
 	// --------------------------------------------------
@@ -111,6 +127,13 @@ struct MGuiRenderer
 	void			( *destroy_texture )		( MGuiRendTexture* texture );
 	void			( *draw_textured_rect )		( const MGuiRendTexture* texture, int32 x, int32 y, uint32 w, uint32 h, const float uv[] );
 
+	// Optional. load_image decodes an image file into 32bit ARGB pixels allocated with mem_alloc,
+	// and create_texture creates a texture from such pixels. If both are available, MGUI can keep
+	// the decoded pixels in memory and re-create the textures without reading the files again.
+	// When asynchronous loading is enabled, load_image is called from a background thread.
+	uint32*			( *load_image )				( const char_t* path, uint32* width, uint32* height );
+	MGuiRendTexture* ( *create_texture )		( const uint32* pixels, uint32 width, uint32 height );
+
 	// --------------------------------------------------
 	// Text rendering and fonts
 	// --------------------------------------------------
@@ -124,6 +147,10 @@ struct MGuiRenderer
 
 	void			( *measure_text )			( const MGuiRendFont* font, const char_t* text, uint32* w, uint32* h );
 
+	// Optional. Fills advances[] with the width of each character in the range [firstc, lastc].
+	// If this is not available, the characters are measured one at a time using measure_text.
+	void			( *measure_glyphs )			( const MGuiRendFont* font, uint32 firstc, uint32 lastc, uint16 advances[] );
+
 	// --------------------------------------------------
 	// Cached rendering
 	// --------------------------------------------------
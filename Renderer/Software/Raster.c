@@ -0,0 +1,261 @@
+/**********************************************************************
+ *
+ * PROJECT:		Mylly GUI - Software Renderer
+ * FILE:		Raster.c
+ * LICENCE:		See Licence.txt
+ * PURPOSE:		Pixel span routines for the software renderer.
+ *
+ *				(c) Tuomo Jauhiainen 2013
+ *
+ **********************************************************************/
+
+#include "Raster.h"
+
+#ifdef RASTER_SSE2
+#include <emmintrin.h>
+#endif
+
+// --------------------------------------------------
+
+static MYLLY_INLINE uint32	raster_mul8				( uint32 x, uint32 y );
+static MYLLY_INLINE uint32	raster_modulate			( uint32 texel, uint32 colour );
+static MYLLY_INLINE uint32	raster_blend_pixel		( uint32 dst, uint32 src, uint32 a );
+static MYLLY_INLINE uint32	raster_blend_premul		( uint32 dst, uint32 src );
+
+// --------------------------------------------------
+
+void raster_fill( uint32* dst, uint32 pitch, uint32 w, uint32 h, uint32 colour )
+{
+	uint32 x, y;
+#ifdef RASTER_SSE2
+	__m128i c = _mm_set1_epi32( (int)colour );
+#endif
+
+	for ( y = 0; y < h; y++, dst += pitch )
+	{
+		x = 0;
+
+#ifdef RASTER_SSE2
+		for ( ; x + 4 <= w; x += 4 )
+			_mm_storeu_si128( (__m128i*)&dst[x], c );
+#endif
+
+		for ( ; x < w; x++ )
+			dst[x] = colour;
+	}
+}
+
+void raster_blend( uint32* dst, uint32 pitch, uint32 w, uint32 h, uint32 colour )
+{
+	uint32 y;
+
+	switch ( colour >> 24 )
+	{
+	case 0:
+		// Fully transparent, nothing to do.
+		return;
+
+	case 0xFF:
+		raster_fill( dst, pitch, w, h, colour );
+		return;
+
+	default:
+		for ( y = 0; y < h; y++, dst += pitch )
+			raster_blend_span( dst, w, colour );
+	}
+}
+
+void raster_blend_span( uint32* dst, uint32 count, uint32 colour )
+{
+	uint32 a;
+#ifdef RASTER_SSE2
+	__m128i zero, src, inv, d, lo, hi;
+#endif
+
+	// Scale the alpha to [0, 256] so the blending can be done with shifts.
+	a = colour >> 24;
+	a += a >> 7;
+
+#ifdef RASTER_SSE2
+	zero = _mm_setzero_si128();
+
+	// The source term ( src * a ) is the same for every pixel, so calculate it only once.
+	src = _mm_unpacklo_epi8( _mm_set1_epi32( (int)( colour | 0xFF000000 ) ), zero );
+	src = _mm_mullo_epi16( src, _mm_set1_epi16( (short)a ) );
+	inv = _mm_set1_epi16( (short)( 256 - a ) );
+
+	for ( ; count >= 4; count -= 4, dst += 4 )
+	{
+		d = _mm_loadu_si128( (__m128i*)dst );
+
+		lo = _mm_unpacklo_epi8( d, zero );
+		hi = _mm_unpackhi_epi8( d, zero );
+
+		lo = _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( lo, inv ), src ), 8 );
+		hi = _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( hi, inv ), src ), 8 );
+
+		_mm_storeu_si128( (__m128i*)dst, _mm_packus_epi16( lo, hi ) );
+	}
+#endif
+
+	for ( ; count > 0; count--, dst++ )
+		*dst = raster_blend_pixel( *dst, colour, a );
+}
+
+void raster_blit_premul( uint32* dst, uint32 pitch, const uint32* src, uint32 src_pitch, uint32 w, uint32 h, uint32 alpha )
+{
+	uint32 x, y;
+#ifdef RASTER_SSE2
+	__m128i zero, c256, s, d, lo, hi, alo, ahi;
+
+	zero = _mm_setzero_si128();
+	c256 = _mm_set1_epi16( 256 );
+#endif
+
+	for ( y = 0; y < h; y++, dst += pitch, src += src_pitch )
+	{
+		x = 0;
+
+		if ( alpha != 0xFF )
+		{
+			// The whole surface is faded, scale every channel of the (premultiplied) source.
+			for ( ; x < w; x++ )
+				dst[x] = raster_blend_premul( dst[x], raster_modulate( src[x], alpha * 0x01010101 ) );
+
+			continue;
+		}
+
+#ifdef RASTER_SSE2
+		for ( ; x + 4 <= w; x += 4 )
+		{
+			s = _mm_loadu_si128( (const __m128i*)&src[x] );
+			d = _mm_loadu_si128( (__m128i*)&dst[x] );
+
+			// Broadcast the alpha of each source pixel to all of its channels.
+			alo = _mm_unpacklo_epi8( s, zero );
+			ahi = _mm_unpackhi_epi8( s, zero );
+			alo = _mm_shufflehi_epi16( _mm_shufflelo_epi16( alo, 0xFF ), 0xFF );
+			ahi = _mm_shufflehi_epi16( _mm_shufflelo_epi16( ahi, 0xFF ), 0xFF );
+
+			alo = _mm_sub_epi16( c256, _mm_add_epi16( alo, _mm_srli_epi16( alo, 7 ) ) );
+			ahi = _mm_sub_epi16( c256, _mm_add_epi16( ahi, _mm_srli_epi16( ahi, 7 ) ) );
+
+			lo = _mm_srli_epi16( _mm_mullo_epi16( _mm_unpacklo_epi8( d, zero ), alo ), 8 );
+			hi = _mm_srli_epi16( _mm_mullo_epi16( _mm_unpackhi_epi8( d, zero ), ahi ), 8 );
+
+			_mm_storeu_si128( (__m128i*)&dst[x], _mm_adds_epu8( _mm_packus_epi16( lo, hi ), s ) );
+		}
+#endif
+
+		for ( ; x < w; x++ )
+			dst[x] = raster_blend_premul( dst[x], src[x] );
+	}
+}
+
+void raster_blit_texture( uint32* dst, uint32 pitch, uint32 w, uint32 h, const uint32* src, uint32 src_w, uint32 src_h,
+						  uint32 u, uint32 v, uint32 du, uint32 dv, uint32 colour )
+{
+	const uint32* row;
+	uint32 x, y, tu, tx, ty, texel, a;
+	bool modulate;
+
+	// Texels are only modulated if the draw colour is something else than opaque white.
+	modulate = ( colour != 0xFFFFFFFF );
+
+	for ( y = 0; y < h; y++, dst += pitch, v += dv )
+	{
+		ty = math_min( v >> 16, src_h - 1 );
+		row = &src[ty * src_w];
+
+		for ( x = 0, tu = u; x < w; x++, tu += du )
+		{
+			tx = math_min( tu >> 16, src_w - 1 );
+			texel = row[tx];
+
+			if ( modulate )
+				texel = raster_modulate( texel, colour );
+
+			a = texel >> 24;
+
+			if ( a == 0xFF )
+			{
+				dst[x] = texel;
+			}
+			else if ( a != 0 )
+			{
+				dst[x] = raster_blend_pixel( dst[x], texel, a + ( a >> 7 ) );
+			}
+		}
+	}
+}
+
+void raster_blit_glyph( uint32* dst, uint32 pitch, const uint16* src, uint32 src_pitch, uint32 w, uint32 h, uint32 colour )
+{
+	uint32 x, y, p, a, ca, shade, col;
+
+	ca = colour >> 24;
+
+	for ( y = 0; y < h; y++, dst += pitch, src += src_pitch )
+	{
+		for ( x = 0; x < w; x++ )
+		{
+			// Glyphs are stored as A4R4G4B4, the colour channels are used as a shade (for outlined fonts).
+			p = src[x];
+
+			if ( ( p >> 12 ) == 0 ) continue;
+
+			a = raster_mul8( ( p >> 12 ) * 17, ca );
+			shade = ( ( p >> 8 ) & 0xF ) * 17;
+
+			col = shade == 0xFF ? colour : raster_modulate( colour, 0xFF000000 | ( shade << 16 ) | ( shade << 8 ) | shade );
+
+			dst[x] = raster_blend_pixel( dst[x], col, a + ( a >> 7 ) );
+		}
+	}
+}
+
+static MYLLY_INLINE uint32 raster_mul8( uint32 x, uint32 y )
+{
+	// Multiplies two values within [0, 255], close enough to x * y / 255.
+	return ( x * y + 0xFF ) >> 8;
+}
+
+static MYLLY_INLINE uint32 raster_modulate( uint32 texel, uint32 colour )
+{
+	return ( raster_mul8( texel >> 24, colour >> 24 ) << 24 ) |
+		   ( raster_mul8( ( texel >> 16 ) & 0xFF, ( colour >> 16 ) & 0xFF ) << 16 ) |
+		   ( raster_mul8( ( texel >> 8 ) & 0xFF, ( colour >> 8 ) & 0xFF ) << 8 ) |
+		   ( raster_mul8( texel & 0xFF, colour & 0xFF ) );
+}
+
+static MYLLY_INLINE uint32 raster_blend_pixel( uint32 dst, uint32 src, uint32 a )
+{
+	uint32 rb, ag, ia;
+
+	// a is within [0, 256]. The source alpha channel is treated as opaque, so the
+	// destination alpha becomes a + da * ( 1 - a ), as it should with premultiplied colours.
+	ia = 256 - a;
+	src |= 0xFF000000;
+
+	rb = ( ( src & 0x00FF00FF ) * a + ( dst & 0x00FF00FF ) * ia ) >> 8;
+	ag = ( ( src >> 8 ) & 0x00FF00FF ) * a + ( ( dst >> 8 ) & 0x00FF00FF ) * ia;
+
+	return ( rb & 0x00FF00FF ) | ( ag & 0xFF00FF00 );
+}
+
+static MYLLY_INLINE uint32 raster_blend_premul( uint32 dst, uint32 src )
+{
+	uint32 rb, ag, a;
+
+	a = src >> 24;
+
+	if ( a == 0xFF ) return src;
+	if ( a == 0 ) return dst;
+
+	a = 256 - ( a + ( a >> 7 ) );
+
+	rb = ( ( dst & 0x00FF00FF ) * a >> 8 ) & 0x00FF00FF;
+	ag = ( ( ( dst >> 8 ) & 0x00FF00FF ) * a ) & 0xFF00FF00;
+
+	return src + ( rb | ag );
+}
@@ -0,0 +1,35 @@
+/**********************************************************************
+ *
+ * PROJECT:		Mylly GUI - Software Renderer
+ * FILE:		Raster.h
+ * LICENCE:		See Licence.txt
+ * PURPOSE:		Pixel span routines for the software renderer.
+ *
+ *				(c) Tuomo Jauhiainen 2013
+ *
+ **********************************************************************/
+
+#pragma once
+#ifndef __MYLLY_GUI_SOFTWARE_RASTER_H
+#define __MYLLY_GUI_SOFTWARE_RASTER_H
+
+#include "MGUI/Renderer/Renderer.h"
+
+// All the routines below work on 32bit 0xAARRGGBB pixels. The pitch of a
+// surface is given in pixels. Blending assumes the destination surface to
+// contain premultiplied colours, so that the contents of a render target
+// can later be blended on top of another surface as they are.
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define RASTER_SSE2
+#endif
+
+void	raster_fill				( uint32* dst, uint32 pitch, uint32 w, uint32 h, uint32 colour );
+void	raster_blend			( uint32* dst, uint32 pitch, uint32 w, uint32 h, uint32 colour );
+void	raster_blend_span		( uint32* dst, uint32 count, uint32 colour );
+void	raster_blit_premul		( uint32* dst, uint32 pitch, const uint32* src, uint32 src_pitch, uint32 w, uint32 h, uint32 alpha );
+void	raster_blit_texture		( uint32* dst, uint32 pitch, uint32 w, uint32 h, const uint32* src, uint32 src_w, uint32 src_h,
+								  uint32 u, uint32 v, uint32 du, uint32 dv, uint32 colour );
+void	raster_blit_glyph		( uint32* dst, uint32 pitch, const uint16* src, uint32 src_pitch, uint32 w, uint32 h, uint32 colour );
+
+#endif /* __MYLLY_GUI_SOFTWARE_RASTER_H */
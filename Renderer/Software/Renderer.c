@@ -0,0 +1,955 @@
+/**********************************************************************
+ *
+ * PROJECT:		Mylly GUI - Software Renderer
+ * FILE:		Renderer.c
+ * LICENCE:		See Licence.txt
+ * PURPOSE:		A software renderer for Mylly GUI.
+ *
+ *				(c) Tuomo Jauhiainen 2013
+ *
+ **********************************************************************/
+
+#include "Renderer.h"
+#include "Raster.h"
+#include "../Shared/Windows/FontLoader.h"
+#include "Platform/Alloc.h"
+#include <stdio.h>
+#include <string.h>
+
+// --------------------------------------------------
+
+typedef struct {
+	MGuiRendFont	data;
+	float**			tex_coords;		// Glyph coordinates within the glyph bitmap
+	uint16*			texture_bits;	// Glyph bitmap (A4R4G4B4)
+	uint32			width;			// Width of the glyph bitmap
+	uint32			height;			// Height of the glyph bitmap
+	uint8			spacing;		// Glyph spacing
+} Font;
+
+typedef struct {
+	MGuiRendTexture	data;
+	uint32*			pixels;			// Texture pixels (0xAARRGGBB)
+} Texture;
+
+typedef struct {
+	MGuiRendTarget	data;
+	Surface			surface;		// Target surface, contains premultiplied colours
+	Surface*		old_surface;	// The surface that was active before this target was enabled
+	int32			x_offset;		// Drawing offset before this target was enabled
+	int32			y_offset;
+} RenderTarget;
+
+// A rectangular area of a surface, x2 and y2 are exclusive
+typedef struct {
+	int32	x1, y1;
+	int32	x2, y2;
+} Area;
+
+// --------------------------------------------------
+
+static Surface*		surface			= NULL;			// Current drawing surface
+static int32		x_offset		= 0;			// Drawing offset (when rendering to a target)
+static int32		y_offset		= 0;
+static uint32		colour			= 0;			// Current draw colour (0xAARRGGBB)
+static colour_t		draw_colour		= { 0 };
+static DRAW_MODE	draw_mode		= DRAWING_INVALID;
+static LINE_STATUS	line_status		= LINE_IDLE;
+static bool			line_continue	= false;
+static bool			is_clipping		= false;
+static Area			clip_rect		= { 0 };		// Clip rectangle in screen coordinates
+static Area			clip_areas[MAX_DAMAGE_RECTS];	// Areas of the current surface that can be drawn to
+static uint32		num_clip_areas	= 0;
+static bool			clip_dirty		= true;			// Clip areas have to be recalculated
+static Area			damage[MAX_DAMAGE_RECTS];		// Parts of the screen that are redrawn this frame
+static uint32		num_damage		= 0;
+static bool			screen_scene	= false;		// The current scene draws to the screen (not only to caches)
+extern Surface		screen;
+
+// --------------------------------------------------
+
+static void						renderer_clear_screen			( void );
+static void						renderer_update_clip			( void );
+static void						renderer_draw_span				( int32 x1, int32 x2, int32 y );
+static uint32					renderer_draw_char				( const Font* font, uint32 c, int32 x, int32 y, uint32 flags );
+static void						renderer_draw_glyph				( const Font* font, uint32 gx, uint32 gy, uint32 w, uint32 h, int32 x, int32 y, uint32 col );
+static void						renderer_process_tag			( const MGuiFormatTag* tag );
+static void						renderer_process_underline		( const Font* font, int32 x, int32 y, int32* x2, int32* y2, colour_t* line_colour );
+static void						renderer_create_font_texture	( void* data, uint32 width, uint32 height, void** texture, uint32* texture_pitch );
+static uint32*					renderer_load_bitmap			( const char_t* path, uint32* width, uint32* height );
+static MYLLY_INLINE bool		renderer_intersect				( Area* dst, const Area* a, const Area* b );
+static MYLLY_INLINE uint32*		renderer_get_pixel				( const Surface* s, int32 x, int32 y );
+static MYLLY_INLINE uint32		renderer_read_le				( const uint8* data, uint32 bytes );
+
+// --------------------------------------------------
+
+void renderer_begin( void )
+{
+	surface = &screen;
+	x_offset = 0;
+	y_offset = 0;
+	is_clipping = false;
+	clip_dirty = true;
+
+	// Clear the parts of the screen that are going to be redrawn, even if nothing is drawn to them.
+	// Caches are refreshed within a scene of their own, and that must not wipe the contents of the screen.
+	if ( screen_scene )
+		renderer_clear_screen();
+}
+
+void renderer_end( void )
+{
+	num_damage = 0;
+	screen_scene = false;
+	clip_dirty = true;
+}
+
+void renderer_resize( uint32 width, uint32 height )
+{
+	if ( width == screen.width && height == screen.height )
+		return;
+
+	SAFE_DELETE( screen.pixels );
+
+	screen.width = width;
+	screen.height = height;
+	screen.pitch = width;
+
+	if ( width > 0 && height > 0 )
+		screen.pixels = mem_alloc_clean( width * height * sizeof(uint32) );
+
+	clip_dirty = true;
+}
+
+void renderer_set_damage_rects( const rectangle_t rects[], uint32 count )
+{
+	Area* a;
+	uint32 i, j;
+
+	num_damage = math_min( count, MAX_DAMAGE_RECTS );
+
+	for ( i = 0; i < num_damage; i++ )
+	{
+		damage[i].x1 = rects[i].x;
+		damage[i].y1 = rects[i].y;
+		damage[i].x2 = rects[i].x + rects[i].w;
+		damage[i].y2 = rects[i].y + rects[i].h;
+	}
+
+	// The areas must not overlap, otherwise translucent primitives would be blended twice.
+	for ( i = 0; i < num_damage; i++ )
+	{
+		for ( j = i + 1; j < num_damage; j++ )
+		{
+			a = &damage[j];
+
+			if ( a->x1 >= damage[i].x2 || a->x2 <= damage[i].x1 ||
+				 a->y1 >= damage[i].y2 || a->y2 <= damage[i].y1 )
+				 continue;
+
+			damage[i].x1 = math_min( damage[i].x1, a->x1 );
+			damage[i].y1 = math_min( damage[i].y1, a->y1 );
+			damage[i].x2 = math_max( damage[i].x2, a->x2 );
+			damage[i].y2 = math_max( damage[i].y2, a->y2 );
+
+			// Remove the merged area and start over, the grown area may overlap the earlier ones.
+			damage[j] = damage[--num_damage];
+			i = (uint32)-1;
+			break;
+		}
+	}
+
+	// Only scenes that draw to the screen get damage rectangles.
+	screen_scene = true;
+	clip_dirty = true;
+}
+
+DRAW_MODE renderer_set_draw_mode( DRAW_MODE mode )
+{
+	DRAW_MODE old = draw_mode;
+
+	// Only 2D drawing is supported.
+	draw_mode = mode;
+	return old;
+}
+
+void renderer_set_draw_colour( const colour_t* col )
+{
+	colour = ( col->a << 24 ) | ( col->r << 16 ) | ( col->g << 8 ) | col->b;
+	draw_colour = *col;
+}
+
+void renderer_set_draw_depth( float z_depth )
+{
+	// Only 2D drawing is supported.
+	UNREFERENCED_PARAM( z_depth );
+}
+
+void renderer_set_draw_transform( const matrix4_t* mat )
+{
+	// Only 2D drawing is supported.
+	UNREFERENCED_PARAM( mat );
+}
+
+void renderer_reset_draw_transform( void )
+{
+	// Only 2D drawing is supported.
+	return;
+}
+
+void renderer_start_clip( int32 x, int32 y, uint32 w, uint32 h )
+{
+	clip_rect.x1 = x;
+	clip_rect.y1 = y;
+	clip_rect.x2 = x + (int32)w;
+	clip_rect.y2 = y + (int32)h;
+
+	is_clipping = true;
+	clip_dirty = true;
+}
+
+void renderer_end_clip( void )
+{
+	is_clipping = false;
+	clip_dirty = true;
+}
+
+void renderer_draw_rect( int32 x, int32 y, uint32 w, uint32 h )
+{
+	Area r, a;
+	uint32 i;
+
+	if ( clip_dirty ) renderer_update_clip();
+
+	r.x1 = x - x_offset;
+	r.y1 = y - y_offset;
+	r.x2 = r.x1 + (int32)w;
+	r.y2 = r.y1 + (int32)h;
+
+	for ( i = 0; i < num_clip_areas; i++ )
+	{
+		if ( !renderer_intersect( &a, &r, &clip_areas[i] ) )
+			continue;
+
+		raster_blend( renderer_get_pixel( surface, a.x1, a.y1 ), surface->pitch, a.x2 - a.x1, a.y2 - a.y1, colour );
+	}
+}
+
+void renderer_draw_triangle( int32 x1, int32 y1, int32 x2, int32 y2, int32 x3, int32 y3 )
+{
+	int32 tmp, y;
+	float fy, xa, xb;
+
+	if ( clip_dirty ) renderer_update_clip();
+
+	// Sort the vertices from top to bottom.
+	if ( y1 > y2 ) { tmp = x1; x1 = x2; x2 = tmp; tmp = y1; y1 = y2; y2 = tmp; }
+	if ( y2 > y3 ) { tmp = x2; x2 = x3; x3 = tmp; tmp = y2; y2 = y3; y3 = tmp; }
+	if ( y1 > y2 ) { tmp = x1; x1 = x2; x2 = tmp; tmp = y1; y1 = y2; y2 = tmp; }
+
+	if ( y1 == y3 ) return;
+
+	// Fill the triangle one scanline at a time, sampling at the centre of each pixel row.
+	for ( y = y1; y < y3; y++ )
+	{
+		fy = y + 0.5f;
+
+		xa = x1 + (float)( x3 - x1 ) * ( fy - y1 ) / ( y3 - y1 );
+
+		if ( fy < y2 )
+			xb = x1 + (float)( x2 - x1 ) * ( fy - y1 ) / ( y2 - y1 );
+		else
+			xb = x2 + (float)( x3 - x2 ) * ( fy - y2 ) / ( y3 - y2 );
+
+		renderer_draw_span( (int32)( math_min( xa, xb ) + 0.5f ), (int32)( math_max( xa, xb ) + 0.5f ), y );
+	}
+}
+
+void renderer_draw_pixel( int32 x, int32 y )
+{
+	renderer_draw_rect( x, y, 1, 1 );
+}
+
+MGuiRendTexture* renderer_load_texture( const char_t* path, uint32* width, uint32* height )
+{
+	Texture* texture;
+	uint32* pixels;
+
+	pixels = renderer_load_bitmap( path, width, height );
+	if ( pixels == NULL ) return NULL;
+
+	texture = mem_alloc( sizeof(*texture) );
+
+	texture->data.width = *width;
+	texture->data.height = *height;
+	texture->pixels = pixels;
+
+	return (MGuiRendTexture*)texture;
+}
+
+void renderer_destroy_texture( MGuiRendTexture* tex )
+{
+	Texture* texture = (Texture*)tex;
+
+	if ( texture == NULL ) return;
+
+	mem_free( texture->pixels );
+	mem_free( texture );
+}
+
+uint32* renderer_load_image( const char_t* path, uint32* width, uint32* height )
+{
+	// The pixels are in the same format the textures use internally.
+	return renderer_load_bitmap( path, width, height );
+}
+
+MGuiRendTexture* renderer_create_texture( const uint32* pixels, uint32 width, uint32 height )
+{
+	Texture* texture;
+
+	if ( pixels == NULL ) return NULL;
+
+	texture = mem_alloc( sizeof(*texture) );
+
+	texture->data.width = width;
+	texture->data.height = height;
+	texture->pixels = mem_alloc( width * height * sizeof(uint32) );
+
+	memcpy( texture->pixels, pixels, width * height * sizeof(uint32) );
+
+	return (MGuiRendTexture*)texture;
+}
+
+void renderer_draw_textured_rect( const MGuiRendTexture* tex, int32 x, int32 y, uint32 w, uint32 h, const float uv[] )
+{
+	const Texture* texture = (const Texture*)tex;
+	Area r, a;
+	uint32 i, u, v, du, dv;
+
+	if ( texture == NULL || w == 0 || h == 0 ) return;
+	if ( clip_dirty ) renderer_update_clip();
+
+	r.x1 = x - x_offset;
+	r.y1 = y - y_offset;
+	r.x2 = r.x1 + (int32)w;
+	r.y2 = r.y1 + (int32)h;
+
+	// Texture coordinates as 16.16 fixed point texels, sampled at the centre of each pixel.
+	du = (uint32)( ( uv[2] - uv[0] ) * texture->data.width * 65536.0f / w );
+	dv = (uint32)( ( uv[3] - uv[1] ) * texture->data.height * 65536.0f / h );
+	u = (uint32)( uv[0] * texture->data.width * 65536.0f ) + du / 2;
+	v = (uint32)( uv[1] * texture->data.height * 65536.0f ) + dv / 2;
+
+	for ( i = 0; i < num_clip_areas; i++ )
+	{
+		if ( !renderer_intersect( &a, &r, &clip_areas[i] ) )
+			continue;
+
+		raster_blit_texture( renderer_get_pixel( surface, a.x1, a.y1 ), surface->pitch, a.x2 - a.x1, a.y2 - a.y1,
+							 texture->pixels, texture->data.width, texture->data.height,
+							 u + ( a.x1 - r.x1 ) * du, v + ( a.y1 - r.y1 ) * dv, du, dv, colour );
+	}
+}
+
+MGuiRendFont* renderer_load_font( const char_t* name, uint8 size, uint8 flags, uint8 charset, uint32 firstc, uint32 lastc )
+{
+	Font* font;
+	MGuiFontInfo info;
+
+	if ( name == NULL ||
+		 *name == '\0' )
+		 return NULL;
+
+	font = mem_alloc_clean( sizeof(*font) );
+
+	// The range of characters is [firstc, lastc), defaulting to the printable Latin-1 characters.
+	firstc = firstc > 0x20 ? firstc : 0x20;
+	lastc = lastc > firstc ? lastc : 0xFF;
+
+	lastc++;
+
+	font->data.size = size;
+	font->data.flags = flags;
+	font->data.charset = charset;
+	font->data.first_char = firstc;
+	font->data.last_char = lastc;
+
+	// The glyphs are rendered by the shared font loader, and kept as they are for blitting.
+	if ( !mgui_load_font( name, size, flags, charset, firstc, lastc, &info, renderer_create_font_texture, (void*)font ) )
+	{
+		SAFE_DELETE( font->texture_bits );
+		mem_free( font );
+
+		return NULL;
+	}
+
+	font->tex_coords = info.tex_coords;
+	font->width = info.width;
+	font->height = info.height;
+	font->spacing = info.spacing;
+
+	return (MGuiRendFont*)font;
+}
+
+void renderer_destroy_font( MGuiRendFont* fnt )
+{
+	Font* font = (Font*)fnt;
+
+	if ( font == NULL ) return;
+
+	if ( font->tex_coords != NULL )
+	{
+		mem_free( font->tex_coords[0] );
+		mem_free( font->tex_coords );
+	}
+
+	SAFE_DELETE( font->texture_bits );
+	mem_free( font );
+}
+
+void renderer_draw_text( const MGuiRendFont* fnt, const char_t* text, int32 x, int32 y,
+						 uint32 flags, const MGuiFormatTag tags[], uint32 ntags )
+{
+	int32 dx, dy, line_x, line_y;
+	uint32 c, ntag = 0, idx = 0;
+	colour_t line_colour, default_colour;
+	register const char_t* s;
+	const MGuiFormatTag* tag = NULL;
+	const Font* font = (const Font*)fnt;
+
+	if ( font == NULL || text == NULL ) return;
+	if ( clip_dirty ) renderer_update_clip();
+
+	line_status = LINE_IDLE;
+
+	if ( tags && ntags > 0 ) tag = &tags[ntag];
+
+	dx = x; line_x = dx;
+	dy = y; line_y = dy;
+	default_colour.hex = draw_colour.hex;
+
+	for ( s = text; *s; ++s, ++idx )
+	{
+		c = *(uchar_t*)s;
+
+		// Process possible format tags for this index
+		if ( tag && tag->index == idx )
+		{
+			renderer_process_tag( tag );
+			renderer_process_underline( font, dx, dy, &line_x, &line_y, &line_colour );
+
+			if ( ++ntag < ntags ) tag = &tags[ntag];
+			else tag = NULL;
+		}
+
+		if ( c < font->data.first_char || c >= font->data.last_char )
+			continue;
+
+		dx += renderer_draw_char( font, c - font->data.first_char, dx, dy, flags );
+	}
+
+	// Finish the underline in case the end tag was missing
+	if ( line_status == LINE_DRAWING )
+	{
+		line_status = LINE_DRAW;
+		renderer_process_underline( font, dx, dy, &line_x, &line_y, &line_colour );
+	}
+
+	// Reset back to default colour if the end tag was missing.
+	if ( draw_colour.hex != default_colour.hex )
+	{
+		renderer_set_draw_colour( &default_colour );
+	}
+}
+
+void renderer_measure_text( const MGuiRendFont* fnt, const char_t* text, uint32* width, uint32* height )
+{
+	float x;
+	uint32 c;
+	register const char_t* s;
+	const Font* font = (const Font*)fnt;
+
+	if ( font == NULL || text == NULL )
+	{
+		*width = 1;
+		*height = 1;
+		return;
+	}
+
+	x = 0;
+
+	for ( s = text; *s; s++ )
+	{
+		c = *(uchar_t*)s;
+
+		if ( c < font->data.first_char || c >= font->data.last_char )
+			continue;
+
+		c -= font->data.first_char;
+		x += ( font->tex_coords[c][2] - font->tex_coords[c][0] ) * font->width - 2 * font->spacing;
+	}
+
+	*width = (uint32)x;
+	*height = font->data.size;
+}
+
+void renderer_measure_glyphs( const MGuiRendFont* fnt, uint32 firstc, uint32 lastc, uint16 advances[] )
+{
+	uint32 c, idx;
+	const Font* font = (const Font*)fnt;
+
+	for ( c = firstc; c <= lastc; c++ )
+	{
+		// Characters outside the font are skipped when rendering.
+		if ( font == NULL || c < font->data.first_char || c >= font->data.last_char )
+		{
+			advances[c - firstc] = 0;
+			continue;
+		}
+
+		idx = c - font->data.first_char;
+		advances[c - firstc] = (uint16)( ( font->tex_coords[idx][2] - font->tex_coords[idx][0] ) * font->width - 2 * font->spacing );
+	}
+}
+
+MGuiRendTarget* renderer_create_render_target( uint32 width, uint32 height )
+{
+	RenderTarget* target;
+
+	if ( width == 0 || height == 0 ) return NULL;
+
+	// Render targets are plain surfaces in memory, so there's no need to round the size up.
+	target = mem_alloc_clean( sizeof(*target) );
+
+	target->data.width = width;
+	target->data.height = height;
+
+	target->surface.pixels = mem_alloc_clean( width * height * sizeof(uint32) );
+	target->surface.width = width;
+	target->surface.height = height;
+	target->surface.pitch = width;
+
+	return (MGuiRendTarget*)target;
+}
+
+void renderer_destroy_render_target( MGuiRendTarget* target )
+{
+	RenderTarget* buffer = (RenderTarget*)target;
+
+	if ( target == NULL ) return;
+
+	mem_free( buffer->surface.pixels );
+	mem_free( buffer );
+}
+
+void renderer_draw_render_target( const MGuiRendTarget* target, int32 x, int32 y, uint32 w, uint32 h )
+{
+	const RenderTarget* buffer = (const RenderTarget*)target;
+	Area r, a;
+	uint32 i;
+
+	if ( buffer == NULL ) return;
+	if ( clip_dirty ) renderer_update_clip();
+
+	r.x1 = x - x_offset;
+	r.y1 = y - y_offset;
+	r.x2 = r.x1 + (int32)math_min( w, buffer->data.width );
+	r.y2 = r.y1 + (int32)math_min( h, buffer->data.height );
+
+	for ( i = 0; i < num_clip_areas; i++ )
+	{
+		if ( !renderer_intersect( &a, &r, &clip_areas[i] ) )
+			continue;
+
+		raster_blit_premul( renderer_get_pixel( surface, a.x1, a.y1 ), surface->pitch,
+							renderer_get_pixel( &buffer->surface, a.x1 - r.x1, a.y1 - r.y1 ), buffer->surface.pitch,
+							a.x2 - a.x1, a.y2 - a.y1, colour >> 24 );
+	}
+}
+
+void renderer_enable_render_target( const MGuiRendTarget* target, int32 x, int32 y )
+{
+	RenderTarget* buffer = (RenderTarget*)target;
+
+	if ( target == NULL ) return;
+
+	// Store the old surface.
+	buffer->old_surface = surface;
+	buffer->x_offset = x_offset;
+	buffer->y_offset = y_offset;
+
+	surface = &buffer->surface;
+	x_offset = x;
+	y_offset = y;
+
+	memset( surface->pixels, 0, surface->pitch * surface->height * sizeof(uint32) );
+
+	clip_dirty = true;
+}
+
+void renderer_disable_render_target( const MGuiRendTarget* target )
+{
+	RenderTarget* buffer = (RenderTarget*)target;
+
+	if ( target == NULL ) return;
+
+	// Restore the old surface.
+	surface = buffer->old_surface ? buffer->old_surface : &screen;
+	x_offset = buffer->x_offset;
+	y_offset = buffer->y_offset;
+
+	buffer->old_surface = NULL;
+
+	clip_dirty = true;
+}
+
+void renderer_screen_pos_to_world( const vector3_t* src, vector3_t* dst )
+{
+	// 3D drawing is not supported.
+	UNREFERENCED_PARAM( src );
+
+	if ( dst != NULL )
+	{
+		dst->x = dst->y = dst->z = 0;
+		return;
+	}
+}
+
+void renderer_world_pos_to_screen( const vector3_t* src, vector3_t* dst )
+{
+	// 3D drawing is not supported.
+	UNREFERENCED_PARAM( src );
+
+	if ( dst != NULL )
+	{
+		dst->x = dst->y = dst->z = 0;
+		return;
+	}
+}
+
+static void renderer_clear_screen( void )
+{
+	Area bounds, r;
+	uint32 i;
+
+	if ( screen.pixels == NULL ) return;
+
+	if ( num_damage == 0 )
+	{
+		raster_fill( screen.pixels, screen.pitch, screen.width, screen.height, 0xFF000000 );
+		return;
+	}
+
+	bounds.x1 = 0;
+	bounds.y1 = 0;
+	bounds.x2 = (int32)screen.width;
+	bounds.y2 = (int32)screen.height;
+
+	for ( i = 0; i < num_damage; i++ )
+	{
+		if ( !renderer_intersect( &r, &bounds, &damage[i] ) ) continue;
+		raster_fill( renderer_get_pixel( &screen, r.x1, r.y1 ), screen.pitch, r.x2 - r.x1, r.y2 - r.y1, 0xFF000000 );
+	}
+}
+
+static void renderer_update_clip( void )
+{
+	Area bounds, r;
+	uint32 i;
+
+	clip_dirty = false;
+	num_clip_areas = 0;
+
+	if ( surface == NULL || surface->pixels == NULL ) return;
+
+	bounds.x1 = 0;
+	bounds.y1 = 0;
+	bounds.x2 = (int32)surface->width;
+	bounds.y2 = (int32)surface->height;
+
+	if ( is_clipping )
+	{
+		// The clip rectangle is given in screen coordinates.
+		r.x1 = clip_rect.x1 - x_offset;
+		r.y1 = clip_rect.y1 - y_offset;
+		r.x2 = clip_rect.x2 - x_offset;
+		r.y2 = clip_rect.y2 - y_offset;
+
+		if ( !renderer_intersect( &bounds, &bounds, &r ) ) return;
+	}
+
+	// Render targets are not affected by the damaged areas of the screen.
+	if ( surface != &screen || num_damage == 0 )
+	{
+		clip_areas[num_clip_areas++] = bounds;
+		return;
+	}
+
+	for ( i = 0; i < num_damage; i++ )
+	{
+		if ( renderer_intersect( &clip_areas[num_clip_areas], &bounds, &damage[i] ) )
+			num_clip_areas++;
+	}
+}
+
+static void renderer_draw_span( int32 x1, int32 x2, int32 y )
+{
+	Area* a;
+	int32 left, right;
+	uint32 i;
+
+	y -= y_offset;
+	x1 -= x_offset;
+	x2 -= x_offset;
+
+	for ( i = 0; i < num_clip_areas; i++ )
+	{
+		a = &clip_areas[i];
+
+		if ( y < a->y1 || y >= a->y2 ) continue;
+
+		left = math_max( x1, a->x1 );
+		right = math_min( x2, a->x2 );
+
+		if ( left >= right ) continue;
+
+		raster_blend( renderer_get_pixel( surface, left, y ), surface->pitch, right - left, 1, colour );
+	}
+}
+
+static uint32 renderer_draw_char( const Font* font, uint32 c, int32 x, int32 y, uint32 flags )
+{
+	uint32 gx, gy, w, h, shadow;
+
+	// Glyph position and size within the glyph bitmap.
+	gx = (uint32)( font->tex_coords[c][0] * font->width + 0.5f );
+	gy = (uint32)( font->tex_coords[c][1] * font->height + 0.5f );
+	w = (uint32)( ( font->tex_coords[c][2] - font->tex_coords[c][0] ) * font->width );
+	h = (uint32)( ( font->tex_coords[c][3] - font->tex_coords[c][1] ) * font->height );
+
+	w = math_min( w, font->width - gx );
+	h = math_min( h, font->height - gy );
+
+	if ( flags & TFLAG_SHADOW )
+	{
+		// Black shadow with the alpha of the text.
+		shadow = colour & 0xFF000000;
+		renderer_draw_glyph( font, gx, gy, w, h, x + 1, y + 1, shadow );
+	}
+
+	renderer_draw_glyph( font, gx, gy, w, h, x, y, colour );
+
+	return ( w - 2 * font->spacing );
+}
+
+static void renderer_draw_glyph( const Font* font, uint32 gx, uint32 gy, uint32 w, uint32 h, int32 x, int32 y, uint32 col )
+{
+	Area r, a;
+	uint32 i;
+
+	r.x1 = x - x_offset;
+	r.y1 = y - y_offset;
+	r.x2 = r.x1 + (int32)w;
+	r.y2 = r.y1 + (int32)h;
+
+	for ( i = 0; i < num_clip_areas; i++ )
+	{
+		if ( !renderer_intersect( &a, &r, &clip_areas[i] ) )
+			continue;
+
+		raster_blit_glyph( renderer_get_pixel( surface, a.x1, a.y1 ), surface->pitch,
+						   &font->texture_bits[( gy + a.y1 - r.y1 ) * font->width + gx + a.x1 - r.x1], font->width,
+						   a.x2 - a.x1, a.y2 - a.y1, col );
+	}
+}
+
+static void renderer_process_tag( const MGuiFormatTag* tag )
+{
+	if ( tag->flags & TAG_COLOUR ||
+		 tag->flags & TAG_COLOUR_END )
+	{
+		renderer_set_draw_colour( &tag->colour );
+
+		if ( line_status == LINE_DRAWING )
+		{
+			line_status = LINE_DRAW;
+			line_continue = true;
+		}
+	}
+
+	if ( tag->flags & TAG_UNDERLINE )
+	{
+		line_status = LINE_BEGIN;
+	}
+
+	else if ( tag->flags & TAG_UNDERLINE_END )
+	{
+		switch ( line_status )
+		{
+		case LINE_DRAWING:
+		case LINE_DRAW:
+			line_status = LINE_DRAW;
+			line_continue = false;
+			break;
+
+		default:
+			line_status = LINE_IDLE;
+			break;
+		}
+	}
+}
+
+static void renderer_process_underline( const Font* font, int32 x, int32 y, int32* x2, int32* y2, colour_t* line_colour )
+{
+	colour_t col;
+
+	switch ( line_status )
+	{
+	case LINE_BEGIN:
+		*x2 = x;
+		*y2 = y + font->data.size + 2;
+
+		*line_colour = draw_colour;
+		line_status = LINE_DRAWING;
+		break;
+
+	case LINE_DRAW:
+		col = draw_colour;
+
+		renderer_set_draw_colour( line_colour );
+		renderer_draw_rect( *x2, *y2, x - *x2, 1 );
+		renderer_set_draw_colour( &col );
+
+		if ( line_continue )
+		{
+			line_status = LINE_DRAWING;
+			line_continue = false;
+
+			*x2 = x;
+			*y2 = y + font->data.size;
+		}
+		else
+		{
+			line_status = LINE_IDLE;
+		}
+
+		*line_colour = draw_colour;
+		break;
+
+	default:
+		break;
+	}
+}
+
+static void renderer_create_font_texture( void* data, uint32 width, uint32 height, void** texture, uint32* texture_pitch )
+{
+	Font* font = (Font*)data;
+
+	// The font loader prints the glyphs into this memory, and they're blitted from there as they are.
+	*texture = mem_alloc( width * height * sizeof(uint16) );
+	*texture_pitch = width * sizeof(uint16);
+
+	font->texture_bits = *texture;
+}
+
+static uint32* renderer_load_bitmap( const char_t* path, uint32* width, uint32* height )
+{
+	FILE* file;
+	uint8 header[54];
+	uint8 *row = NULL, *p;
+	uint32 *pixels = NULL, *dst;
+	uint32 offset, bpp, compression, pitch, w, h, x, y, alpha = 0;
+	int32 rows;
+
+	// Only uncompressed 24 and 32bit bitmaps are supported.
+	file = fopen( path, "rb" );
+	if ( file == NULL ) return NULL;
+
+	if ( fread( header, 1, sizeof(header), file ) != sizeof(header) ||
+		 header[0] != 'B' || header[1] != 'M' )
+		 goto cleanup;
+
+	offset = renderer_read_le( &header[10], 4 );
+	w = renderer_read_le( &header[18], 4 );
+	rows = (int32)renderer_read_le( &header[22], 4 );
+	bpp = renderer_read_le( &header[28], 2 );
+	compression = renderer_read_le( &header[30], 4 );
+
+	// Compression 3 (bitfields) is accepted with the standard BGRA masks.
+	if ( (int32)w <= 0 || rows == 0 || ( bpp != 24 && bpp != 32 ) || ( compression != 0 && compression != 3 ) )
+		goto cleanup;
+
+	// A negative height means the rows are stored from top to bottom.
+	h = (uint32)math_abs( rows );
+	pitch = ( w * ( bpp / 8 ) + 3 ) & ~3;
+
+	if ( fseek( file, offset, SEEK_SET ) != 0 )
+		goto cleanup;
+
+	pixels = mem_alloc( w * h * sizeof(uint32) );
+	row = mem_alloc( pitch );
+
+	for ( y = 0; y < h; y++ )
+	{
+		if ( fread( row, 1, pitch, file ) != pitch )
+		{
+			SAFE_DELETE( pixels );
+			goto cleanup;
+		}
+
+		dst = &pixels[( rows > 0 ? h - 1 - y : y ) * w];
+
+		for ( x = 0, p = row; x < w; x++, p += bpp / 8 )
+		{
+			dst[x] = ( p[2] << 16 ) | ( p[1] << 8 ) | p[0];
+
+			if ( bpp == 32 )
+			{
+				dst[x] |= (uint32)p[3] << 24;
+				alpha |= p[3];
+			}
+		}
+	}
+
+	// Bitmaps without an alpha channel (or with an unused one) are opaque.
+	if ( alpha == 0 )
+	{
+		for ( x = 0; x < w * h; x++ )
+			pixels[x] |= 0xFF000000;
+	}
+
+	*width = w;
+	*height = h;
+
+cleanup:
+	if ( row ) mem_free( row );
+	fclose( file );
+
+	return pixels;
+}
+
+static MYLLY_INLINE bool renderer_intersect( Area* dst, const Area* a, const Area* b )
+{
+	dst->x1 = math_max( a->x1, b->x1 );
+	dst->y1 = math_max( a->y1, b->y1 );
+	dst->x2 = math_min( a->x2, b->x2 );
+	dst->y2 = math_min( a->y2, b->y2 );
+
+	return ( dst->x1 < dst->x2 && dst->y1 < dst->y2 );
+}
+
+static MYLLY_INLINE uint32* renderer_get_pixel( const Surface* s, int32 x, int32 y )
+{
+	return &s->pixels[y * s->pitch + x];
+}
+
+static MYLLY_INLINE uint32 renderer_read_le( const uint8* data, uint32 bytes )
+{
+	uint32 ret = 0;
+
+	// Bitmap headers are always little endian.
+	while ( bytes-- > 0 )
+		ret = ( ret << 8 ) | data[bytes];
+
+	return ret;
+}
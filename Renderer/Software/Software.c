@@ -0,0 +1,98 @@
+/**********************************************************************
+ *
+ * PROJECT:		Mylly GUI Renderer (Software)
+ * FILE:		Software.c
+ * LICENCE:		See Licence.txt
+ * PURPOSE:		A software renderer for Mylly GUI. Draws everything into
+ *				a 32bit framebuffer in memory using only the CPU.
+ *
+ *				(c) Tuomo Jauhiainen 2013
+ *
+ **********************************************************************/
+
+#include "Software.h"
+#include "Renderer.h"
+#include "Platform/Alloc.h"
+
+// --------------------------------------------------
+
+static MGuiRenderer	renderer;
+Surface				screen		= { 0 };
+bool				initialized	= false;
+
+// --------------------------------------------------
+
+MGuiRenderer* mgui_software_initialize( uint32 width, uint32 height )
+{
+	renderer.properties = REND_SUPPORTS_TEXTTAGS|REND_SUPPORTS_TEXTURES|REND_SUPPORTS_TARGETS|REND_SUPPORTS_DAMAGE|REND_THREADED_FONTS;
+
+	renderer.begin					= renderer_begin;
+	renderer.end					= renderer_end;
+	renderer.resize					= renderer_resize;
+	renderer.set_damage_rects		= renderer_set_damage_rects;
+	renderer.set_draw_mode			= renderer_set_draw_mode;
+	renderer.set_draw_colour		= renderer_set_draw_colour;
+	renderer.set_draw_depth			= renderer_set_draw_depth;
+	renderer.set_draw_transform		= renderer_set_draw_transform;
+	renderer.reset_draw_transform	= renderer_reset_draw_transform;
+	renderer.start_clip				= renderer_start_clip;
+	renderer.end_clip				= renderer_end_clip;
+	renderer.draw_rect				= renderer_draw_rect;
+	renderer.draw_triangle			= renderer_draw_triangle;
+	renderer.draw_pixel				= renderer_draw_pixel;
+	renderer.load_texture			= renderer_load_texture;
+	renderer.destroy_texture		= renderer_destroy_texture;
+	renderer.draw_textured_rect		= renderer_draw_textured_rect;
+	renderer.load_image				= renderer_load_image;
+	renderer.create_texture			= renderer_create_texture;
+	renderer.load_font				= renderer_load_font;
+	renderer.destroy_font			= renderer_destroy_font;
+	renderer.draw_text				= renderer_draw_text;
+	renderer.measure_text			= renderer_measure_text;
+	renderer.measure_glyphs			= renderer_measure_glyphs;
+	renderer.create_render_target	= renderer_create_render_target;
+	renderer.destroy_render_target	= renderer_destroy_render_target;
+	renderer.draw_render_target		= renderer_draw_render_target;
+	renderer.enable_render_target	= renderer_enable_render_target;
+	renderer.disable_render_target	= renderer_disable_render_target;
+	renderer.screen_pos_to_world	= renderer_screen_pos_to_world;
+	renderer.world_pos_to_screen	= renderer_world_pos_to_screen;
+
+	renderer_resize( width, height );
+
+	initialized = true;
+
+	return &renderer;
+}
+
+void mgui_software_shutdown( void )
+{
+	if ( !initialized ) return;
+
+	SAFE_DELETE( screen.pixels );
+
+	screen.width = 0;
+	screen.height = 0;
+	screen.pitch = 0;
+
+	initialized = false;
+}
+
+void mgui_software_begin_scene( void )
+{
+	// Nothing to do here, everything is processed by the renderer.
+}
+
+void mgui_software_end_scene( void )
+{
+	// Nothing to do here, the application presents the framebuffer.
+}
+
+const uint32* mgui_software_get_framebuffer( uint32* width, uint32* height, uint32* pitch )
+{
+	if ( width != NULL ) *width = screen.width;
+	if ( height != NULL ) *height = screen.height;
+	if ( pitch != NULL ) *pitch = screen.pitch;
+
+	return screen.pixels;
+}
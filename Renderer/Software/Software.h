@@ -0,0 +1,32 @@
+/**********************************************************************
+ *
+ * PROJECT:		Mylly GUI Renderer (Software)
+ * FILE:		Software.h
+ * LICENCE:		See Licence.txt
+ * PURPOSE:		A software renderer for Mylly GUI. Draws everything into
+ *				a 32bit framebuffer in memory using only the CPU.
+ *
+ *				(c) Tuomo Jauhiainen 2013
+ *
+ **********************************************************************/
+
+#pragma once
+#ifndef __MYLLY_GUI_SOFTWARE_H
+#define __MYLLY_GUI_SOFTWARE_H
+
+#include "MGUI/Renderer/Renderer.h"
+
+__BEGIN_DECLS
+
+MYLLY_API MGuiRenderer*	mgui_software_initialize		( uint32 width, uint32 height );
+MYLLY_API void			mgui_software_shutdown			( void );
+MYLLY_API void			mgui_software_begin_scene		( void );
+MYLLY_API void			mgui_software_end_scene			( void );
+
+// Returns the framebuffer the GUI is drawn into. The pixels are 32bit 0xAARRGGBB values (the
+// layout of a 24/32bit TrueColor XImage), pitch is the number of pixels between two rows.
+MYLLY_API const uint32*	mgui_software_get_framebuffer	( uint32* width, uint32* height, uint32* pitch );
+
+__END_DECLS
+
+#endif /* __MYLLY_GUI_SOFTWARE_H */
@@ -0,0 +1,29 @@
+-- Mylly GUI software renderer
+
+project "Lib-MGUI-Renderer-Software"
+	kind "StaticLib"
+	language "C"
+	files { "*.h", "*.c", "premake4.lua" }
+	includedirs { ".", "..", "../..", "../../.." }
+	location ( "../../../../Projects/" .. os.get() .. "/" .. _ACTION )
+
+	vpaths {
+		["Shared"] = { "../Shared/**" },
+		[""] = { "./**" }
+	}
+
+	-- Linux specific stuff
+	configuration "linux"
+		targetextension ".a"
+		files { "../Shared/Linux/*" } -- Font loading methods on Linux
+		buildoptions { "-fms-extensions" } -- Unnamed struct/union fields within structs/unions
+		configuration "Debug" targetname "mguisoftwared"
+		configuration "Release" targetname "mguisoftware"
+
+	-- Windows specific stuff
+	configuration "windows"
+		targetextension ".lib"
+		files { "../Shared/Windows/*" } -- Font loading methods on Windows
+		buildoptions { "/wd4201" } -- C4201: nameless struct/union
+		configuration "Debug" targetname "mguirendsoftwared"
+		configuration "Release" targetname "mguirendsoftware"
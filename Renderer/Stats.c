@@ -0,0 +1,201 @@
+/**********************************************************************
+ *
+ * PROJECT:		Mylly GUI
+ * FILE:		Stats.c
+ * LICENCE:		See Licence.txt
+ * PURPOSE:		Per-frame statistics and phase timing.
+ *
+ *				(c) Tuomo Jauhiainen 2012-13
+ *
+ **********************************************************************/
+
+#include "Stats.h"
+#include <string.h>
+
+#ifdef MGUI_ENABLE_STATS
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// --------------------------------------------------
+
+MGuiFrameStats				frame_stats;						// Statistics of the frame currently being processed
+MGuiFrameStats				last_frame_stats;					// Statistics of the last complete frame
+mgui_frame_stats_callback_t	frame_stats_callback	= NULL;		// User callback, called after every frame
+void*						frame_stats_data		= NULL;		// User data passed to the callback
+
+static MGuiRenderer			hooked;								// The original renderer functions
+static uint64				phase_start[STATS_NUM_PHASES];		// Start time of each phase
+
+// --------------------------------------------------
+
+static uint64	mgui_stats_get_time				( void );
+static void		mgui_stats_start_clip			( int32 x, int32 y, uint32 w, uint32 h );
+static void		mgui_stats_end_clip				( void );
+static void		mgui_stats_draw_rect			( int32 x, int32 y, uint32 w, uint32 h );
+static void		mgui_stats_draw_triangle		( int32 x1, int32 y1, int32 x2, int32 y2, int32 x3, int32 y3 );
+static void		mgui_stats_draw_pixel			( int32 x, int32 y );
+static void		mgui_stats_draw_textured_rect	( const MGuiRendTexture* texture, int32 x, int32 y, uint32 w, uint32 h, const float uv[] );
+static void		mgui_stats_draw_text			( const MGuiRendFont* font, const char_t* text, int32 x, int32 y, uint32 flags, const MGuiFormatTag tags[], uint32 ntags );
+static void		mgui_stats_measure_text			( const MGuiRendFont* font, const char_t* text, uint32* w, uint32* h );
+static void		mgui_stats_draw_render_target	( const MGuiRendTarget* target, int32 x, int32 y, uint32 w, uint32 h );
+static void		mgui_stats_enable_render_target	( const MGuiRendTarget* target, int32 x, int32 y );
+static void		mgui_stats_disable_render_target( const MGuiRendTarget* target );
+
+// --------------------------------------------------
+
+void mgui_stats_hook_renderer( MGuiRenderer* rend )
+{
+	// Route the counted renderer calls through the functions below. The renderer
+	// instance is a copy owned by the library, so the application's renderer is left untouched.
+	hooked = *rend;
+
+	if ( rend->start_clip ) rend->start_clip = mgui_stats_start_clip;
+	if ( rend->end_clip ) rend->end_clip = mgui_stats_end_clip;
+	if ( rend->draw_rect ) rend->draw_rect = mgui_stats_draw_rect;
+	if ( rend->draw_triangle ) rend->draw_triangle = mgui_stats_draw_triangle;
+	if ( rend->draw_pixel ) rend->draw_pixel = mgui_stats_draw_pixel;
+	if ( rend->draw_textured_rect ) rend->draw_textured_rect = mgui_stats_draw_textured_rect;
+	if ( rend->draw_text ) rend->draw_text = mgui_stats_draw_text;
+	if ( rend->measure_text ) rend->measure_text = mgui_stats_measure_text;
+	if ( rend->draw_render_target ) rend->draw_render_target = mgui_stats_draw_render_target;
+	if ( rend->enable_render_target ) rend->enable_render_target = mgui_stats_enable_render_target;
+	if ( rend->disable_render_target ) rend->disable_render_target = mgui_stats_disable_render_target;
+}
+
+void mgui_stats_begin_phase( STATS_PHASE phase )
+{
+	phase_start[phase] = mgui_stats_get_time();
+}
+
+void mgui_stats_end_phase( STATS_PHASE phase )
+{
+	uint32 elapsed;
+
+	elapsed = (uint32)( mgui_stats_get_time() - phase_start[phase] );
+
+	switch ( phase )
+	{
+	case STATS_PHASE_INPUT:
+		frame_stats.time_input += elapsed;
+		break;
+
+	case STATS_PHASE_PROCESS:
+		frame_stats.time_process += elapsed;
+		break;
+
+	case STATS_PHASE_RENDER:
+		frame_stats.time_render += elapsed;
+		break;
+
+	case STATS_PHASE_PRE_PROCESS:
+		frame_stats.time_pre_process += elapsed;
+		break;
+
+	default:
+		break;
+	}
+}
+
+void mgui_stats_end_frame( void )
+{
+	last_frame_stats = frame_stats;
+	memset( &frame_stats, 0, sizeof(frame_stats) );
+
+	if ( frame_stats_callback != NULL )
+		frame_stats_callback( &last_frame_stats, frame_stats_data );
+}
+
+static uint64 mgui_stats_get_time( void )
+{
+	// Returns a timestamp in microseconds.
+#ifdef _WIN32
+	static LARGE_INTEGER frequency = { 0 };
+	LARGE_INTEGER counter;
+
+	if ( frequency.QuadPart == 0 )
+		QueryPerformanceFrequency( &frequency );
+
+	QueryPerformanceCounter( &counter );
+
+	return (uint64)( counter.QuadPart / frequency.QuadPart ) * 1000000 +
+		   (uint64)( counter.QuadPart % frequency.QuadPart ) * 1000000 / frequency.QuadPart;
+#else
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+
+	return (uint64)ts.tv_sec * 1000000 + (uint64)ts.tv_nsec / 1000;
+#endif
+}
+
+static void mgui_stats_start_clip( int32 x, int32 y, uint32 w, uint32 h )
+{
+	frame_stats.clip_changes++;
+	hooked.start_clip( x, y, w, h );
+}
+
+static void mgui_stats_end_clip( void )
+{
+	frame_stats.clip_changes++;
+	hooked.end_clip();
+}
+
+static void mgui_stats_draw_rect( int32 x, int32 y, uint32 w, uint32 h )
+{
+	frame_stats.draw_rect++;
+	hooked.draw_rect( x, y, w, h );
+}
+
+static void mgui_stats_draw_triangle( int32 x1, int32 y1, int32 x2, int32 y2, int32 x3, int32 y3 )
+{
+	frame_stats.draw_triangle++;
+	hooked.draw_triangle( x1, y1, x2, y2, x3, y3 );
+}
+
+static void mgui_stats_draw_pixel( int32 x, int32 y )
+{
+	frame_stats.draw_pixel++;
+	hooked.draw_pixel( x, y );
+}
+
+static void mgui_stats_draw_textured_rect( const MGuiRendTexture* texture, int32 x, int32 y, uint32 w, uint32 h, const float uv[] )
+{
+	frame_stats.draw_textured_rect++;
+	hooked.draw_textured_rect( texture, x, y, w, h, uv );
+}
+
+static void mgui_stats_draw_text( const MGuiRendFont* font, const char_t* text, int32 x, int32 y, uint32 flags, const MGuiFormatTag tags[], uint32 ntags )
+{
+	frame_stats.draw_text++;
+	hooked.draw_text( font, text, x, y, flags, tags, ntags );
+}
+
+static void mgui_stats_measure_text( const MGuiRendFont* font, const char_t* text, uint32* w, uint32* h )
+{
+	frame_stats.measure_text++;
+	hooked.measure_text( font, text, w, h );
+}
+
+static void mgui_stats_draw_render_target( const MGuiRendTarget* target, int32 x, int32 y, uint32 w, uint32 h )
+{
+	frame_stats.draw_render_target++;
+	hooked.draw_render_target( target, x, y, w, h );
+}
+
+static void mgui_stats_enable_render_target( const MGuiRendTarget* target, int32 x, int32 y )
+{
+	frame_stats.target_switches++;
+	hooked.enable_render_target( target, x, y );
+}
+
+static void mgui_stats_disable_render_target( const MGuiRendTarget* target )
+{
+	frame_stats.target_switches++;
+	hooked.disable_render_target( target );
+}
+
+#endif /* MGUI_ENABLE_STATS */
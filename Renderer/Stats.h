@@ -0,0 +1,55 @@
+/**********************************************************************
+ *
+ * PROJECT:		Mylly GUI
+ * FILE:		Stats.h
+ * LICENCE:		See Licence.txt
+ * PURPOSE:		Per-frame statistics and phase timing.
+ *
+ *				(c) Tuomo Jauhiainen 2012-13
+ *
+ **********************************************************************/
+
+#pragma once
+#ifndef __MGUI_STATS_H
+#define __MGUI_STATS_H
+
+#include "MGUI.h"
+#include "Renderer.h"
+
+// Frame statistics are collected only if the library has been built with MGUI_ENABLE_STATS.
+// Otherwise all of the macros below compile to nothing.
+
+typedef enum {
+	STATS_PHASE_INPUT,
+	STATS_PHASE_PROCESS,
+	STATS_PHASE_RENDER,
+	STATS_PHASE_PRE_PROCESS,
+	STATS_NUM_PHASES,
+} STATS_PHASE;
+
+#ifdef MGUI_ENABLE_STATS
+
+extern MGuiFrameStats frame_stats;
+
+void		mgui_stats_hook_renderer	( MGuiRenderer* rend );
+void		mgui_stats_begin_phase		( STATS_PHASE phase );
+void		mgui_stats_end_phase		( STATS_PHASE phase );
+void		mgui_stats_end_frame		( void );
+
+#define MGUI_STATS_INC(x)				( frame_stats.x++ )
+#define MGUI_STATS_HOOK_RENDERER(x)		mgui_stats_hook_renderer( x )
+#define MGUI_STATS_BEGIN(x)				mgui_stats_begin_phase( x )
+#define MGUI_STATS_END(x)				mgui_stats_end_phase( x )
+#define MGUI_STATS_END_FRAME()			mgui_stats_end_frame()
+
+#else
+
+#define MGUI_STATS_INC(x)				((void)0)
+#define MGUI_STATS_HOOK_RENDERER(x)		((void)0)
+#define MGUI_STATS_BEGIN(x)				((void)0)
+#define MGUI_STATS_END(x)				((void)0)
+#define MGUI_STATS_END_FRAME()			((void)0)
+
+#endif /* MGUI_ENABLE_STATS */
+
+#endif /* __MGUI_STATS_H */
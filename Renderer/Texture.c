@@ -11,13 +11,41 @@
 
 #include "Texture.h"
 #include "Renderer.h"
+#include "Loader.h"
+#include "Element.h"
 #include "Stringy/Stringy.h"
 #include "Platform/Alloc.h"
 
+typedef struct MGuiTextureJob {
+	MGuiLoadJob;							// Loader job base
+	MGuiTexture*	texture;				// The texture being loaded, NULL if it was destroyed in the meantime
+	char_t*			filename;				// Copy of the file name for the worker thread
+	uint32*			( *load_image )( const char_t* path, uint32* width, uint32* height );
+	uint32*			pixels;					// Decoded pixels
+	uint32			width;					// Width of the image
+	uint32			height;					// Height of the image
+} MGuiTextureJob;
+
 extern MGuiRenderer* renderer;
 static list_t* textures = NULL;
+static MGuiTexture* texture_table[TEXTURE_HASH_SIZE];	// Textures hashed by their file names
+static MGuiTexture* lru_first = NULL;					// Least recently used unreferenced texture
+static MGuiTexture* lru_last = NULL;					// Most recently used unreferenced texture
+static uint32 texture_memory = 0;						// Memory used by all the textures, in bytes
+static uint32 texture_budget = 0;						// Memory budget, unreferenced textures are kept around until it's exceeded
+static bool cache_pixels = false;						// Keep the decoded pixels of the textures in memory
 
-static MGuiTexture* mgui_texture_find( const char_t* name );
+static MGuiTexture* mgui_texture_find		( const char_t* name );
+static void			mgui_texture_load		( MGuiTexture* texture );
+static bool			mgui_texture_load_async	( MGuiTexture* texture );
+static void			mgui_texture_job_load	( MGuiLoadJob* job );
+static void			mgui_texture_job_finish	( MGuiLoadJob* job );
+static void			mgui_texture_upload		( MGuiTexture* texture, uint32* pixels, uint32 width, uint32 height );
+static void			mgui_texture_unload		( MGuiTexture* texture );
+static void			mgui_texture_free		( MGuiTexture* texture );
+static void			mgui_texture_lru_remove	( MGuiTexture* texture );
+static void			mgui_texture_evict		( void );
+static uint32		mgui_texture_hash		( const char_t* name );
 
 void mgui_texturemgr_initialize( void )
 {
@@ -28,20 +56,24 @@ void mgui_texturemgr_shutdown( void )
 {
 	node_t *node, *tmp;
 
+	// Textures still being referenced are destroyed as well.
 	list_foreach_safe( textures, node, tmp )
 	{
-		mgui_texture_destroy( (MGuiTexture*)node );
+		mgui_texture_free( (MGuiTexture*)node );
 	}
 
 	list_destroy( textures );
 	textures = NULL;
+
+	lru_first = NULL;
+	lru_last = NULL;
+	texture_memory = 0;
 }
 
 void mgui_texturemgr_initialize_all( void )
 {
 	node_t* node;
 	MGuiTexture* texture;
-	uint32 width, height;
 
 	if ( renderer == NULL ) return;
 
@@ -50,12 +82,10 @@ void mgui_texturemgr_initialize_all( void )
 		texture = (MGuiTexture*)node;
 
 		if ( texture->data == NULL )
-		{
-			texture->data = renderer->load_texture( texture->filename, &width, &height );
-			texture->width = (uint16)width;
-			texture->height = (uint16)height;
-		}
+			mgui_texture_load( texture );
 	}
+
+	mgui_texture_evict();
 }
 
 void mgui_texturemgr_invalidate_all( void )
@@ -65,6 +95,10 @@ void mgui_texturemgr_invalidate_all( void )
 
 	if ( renderer == NULL ) return;
 
+	// Textures still being loaded have to arrive before they can be destroyed.
+	mgui_loader_flush();
+
+	// Cached pixels are kept, so the textures can be re-created without reading the files again.
 	list_foreach( textures, node )
 	{
 		texture = (MGuiTexture*)node;
@@ -74,36 +108,73 @@ void mgui_texturemgr_invalidate_all( void )
 			renderer->destroy_texture( texture->data );
 			texture->data = NULL;
 		}
+
+		texture_memory -= texture->size;
+		texture->size = 0;
+	}
+}
+
+void mgui_texturemgr_set_budget( uint32 bytes )
+{
+	texture_budget = bytes;
+	mgui_texture_evict();
+}
+
+void mgui_texturemgr_set_cache( bool enabled )
+{
+	node_t* node;
+	MGuiTexture* texture;
+
+	cache_pixels = enabled;
+
+	if ( enabled || textures == NULL ) return;
+
+	// Release the pixels that have been cached so far.
+	list_foreach( textures, node )
+	{
+		texture = (MGuiTexture*)node;
+
+		if ( texture->pixels != NULL )
+		{
+			texture_memory -= texture->width * texture->height * sizeof(uint32);
+			SAFE_DELETE( texture->pixels );
+		}
 	}
 }
 
 MGuiTexture* mgui_texture_create( const char_t* texture_file )
 {
 	MGuiTexture* texture;
-	uint32 width = 0, height = 0;
+	uint32 bucket;
 
 	if ( texture_file == NULL ) return NULL;
 
 	texture = mgui_texture_find( texture_file );
 	if ( texture )
 	{
-		texture->refcount++;
+		// The texture may be waiting in the eviction queue.
+		if ( texture->refcount++ == 0 )
+			mgui_texture_lru_remove( texture );
+
 		return texture;
 	}
 
 	texture = mem_alloc_clean( sizeof(*texture) );
 	texture->filename = str_dup( texture_file, 0 );
+	texture->hash = mgui_texture_hash( texture_file );
 	texture->refcount = 1;
 
 	if ( renderer != NULL )
-	{
-		texture->data = renderer->load_texture( texture_file, &width, &height );
-		texture->width = (uint16)width;
-		texture->height = (uint16)height;
-	}
+		mgui_texture_load( texture );
+
+	bucket = texture->hash % TEXTURE_HASH_SIZE;
+	texture->hash_next = texture_table[bucket];
+	texture_table[bucket] = texture;
 
 	list_push( textures, &texture->node );
 
+	mgui_texture_evict();
+
 	return texture;
 }
 
@@ -112,25 +183,44 @@ void mgui_texture_destroy( MGuiTexture* texture )
 	if ( texture == NULL ) return;
 	if ( --(texture->refcount) ) return;
 
-	if ( texture->data )
-		renderer->destroy_texture( texture->data );
+	if ( texture_budget == 0 )
+	{
+		mgui_texture_free( texture );
+		return;
+	}
 
-	SAFE_DELETE( texture->filename );
+	// Keep the texture around in case it's needed again, until the memory budget runs out.
+	texture->lru_prev = lru_last;
+	texture->lru_next = NULL;
 
-	list_remove( textures, &texture->node );
-	mem_free( texture );
+	if ( lru_last ) lru_last->lru_next = texture;
+	else lru_first = texture;
+
+	lru_last = texture;
+
+	mgui_texture_evict();
+}
+
+void mgui_texture_wait( MGuiTexture* texture )
+{
+	if ( texture == NULL || texture->job == NULL ) return;
+
+	// Finishes all pending loads, not just this one. Only needed when the size of the texture is required right away.
+	mgui_loader_flush();
 }
 
 static MGuiTexture* mgui_texture_find( const char_t* name )
 {
 	MGuiTexture* texture;
-	node_t* node;
+	uint32 hash;
 
 	if ( name == NULL ) return NULL;
 
-	list_foreach( textures, node )
+	hash = mgui_texture_hash( name );
+
+	for ( texture = texture_table[hash % TEXTURE_HASH_SIZE]; texture != NULL; texture = texture->hash_next )
 	{
-		texture = (MGuiTexture*)node;
+		if ( texture->hash != hash ) continue;
 
 #ifdef _WIN32
 		if ( mstrcaseequal( texture->filename, name ) )
@@ -144,3 +234,212 @@ static MGuiTexture* mgui_texture_find( const char_t* name )
 
 	return NULL;
 }
+
+static void mgui_texture_load( MGuiTexture* texture )
+{
+	uint32 width = 0, height = 0;
+	uint32* pixels;
+
+	// The texture is already being loaded in the background.
+	if ( texture->job != NULL ) return;
+
+	if ( texture->pixels != NULL && renderer->create_texture != NULL )
+	{
+		// The pixels are still in memory, so this is just an upload.
+		texture->data = renderer->create_texture( texture->pixels, texture->width, texture->height );
+	}
+	else if ( mgui_texture_load_async( texture ) )
+	{
+		// The texture is uploaded once the image has been decoded, until then it's not drawn.
+		return;
+	}
+	else if ( cache_pixels && renderer->load_image != NULL && renderer->create_texture != NULL )
+	{
+		pixels = renderer->load_image( texture->filename, &width, &height );
+		if ( pixels == NULL ) return;
+
+		mgui_texture_upload( texture, pixels, width, height );
+		return;
+	}
+	else
+	{
+		texture->data = renderer->load_texture( texture->filename, &width, &height );
+		texture->width = (uint16)width;
+		texture->height = (uint16)height;
+	}
+
+	if ( texture->data != NULL )
+	{
+		texture->size = texture->data->width * texture->data->height * sizeof(uint32);
+		texture_memory += texture->size;
+	}
+}
+
+static bool mgui_texture_load_async( MGuiTexture* texture )
+{
+	MGuiTextureJob* job;
+
+	if ( !mgui_loader_is_enabled() ) return false;
+	if ( renderer->load_image == NULL || renderer->create_texture == NULL ) return false;
+
+	job = mem_alloc_clean( sizeof(*job) );
+	job->load = mgui_texture_job_load;
+	job->finish = mgui_texture_job_finish;
+	job->texture = texture;
+	job->filename = str_dup( texture->filename, 0 );
+	job->load_image = renderer->load_image;
+
+	if ( !mgui_loader_queue( (MGuiLoadJob*)job ) )
+	{
+		mem_free( job->filename );
+		mem_free( job );
+		return false;
+	}
+
+	texture->job = job;
+	return true;
+}
+
+static void mgui_texture_job_load( MGuiLoadJob* job )
+{
+	MGuiTextureJob* tjob = (MGuiTextureJob*)job;
+
+	// Called from the worker thread, the job must not touch anything else.
+	tjob->pixels = tjob->load_image( tjob->filename, &tjob->width, &tjob->height );
+}
+
+static void mgui_texture_job_finish( MGuiLoadJob* job )
+{
+	MGuiTextureJob* tjob = (MGuiTextureJob*)job;
+	MGuiTexture* texture = tjob->texture;
+
+	if ( texture != NULL )
+	{
+		texture->job = NULL;
+
+		if ( tjob->pixels != NULL && renderer != NULL )
+		{
+			mgui_texture_upload( texture, tjob->pixels, tjob->width, tjob->height );
+			tjob->pixels = NULL;
+
+			// Whatever uses the texture has been drawn without it so far.
+			mgui_element_request_redraw_all();
+			mgui_texture_evict();
+		}
+	}
+
+	SAFE_DELETE( tjob->pixels );
+	mem_free( tjob->filename );
+	mem_free( tjob );
+}
+
+static void mgui_texture_upload( MGuiTexture* texture, uint32* pixels, uint32 width, uint32 height )
+{
+	texture->width = (uint16)width;
+	texture->height = (uint16)height;
+	texture->data = renderer->create_texture( pixels, width, height );
+
+	if ( texture->data != NULL )
+	{
+		texture->size = texture->data->width * texture->data->height * sizeof(uint32);
+		texture_memory += texture->size;
+	}
+
+	// Keep the pixels if they're cached, the texture takes the ownership of them.
+	if ( cache_pixels )
+	{
+		texture->pixels = pixels;
+		texture_memory += width * height * sizeof(uint32);
+	}
+	else
+	{
+		mem_free( pixels );
+	}
+}
+
+static void mgui_texture_unload( MGuiTexture* texture )
+{
+	if ( texture->data )
+	{
+		renderer->destroy_texture( texture->data );
+		texture->data = NULL;
+	}
+
+	texture_memory -= texture->size;
+	texture->size = 0;
+
+	if ( texture->pixels )
+	{
+		texture_memory -= texture->width * texture->height * sizeof(uint32);
+		SAFE_DELETE( texture->pixels );
+	}
+}
+
+static void mgui_texture_free( MGuiTexture* texture )
+{
+	MGuiTexture** prev;
+
+	if ( texture->refcount == 0 )
+		mgui_texture_lru_remove( texture );
+
+	// The result of a background load is thrown away when it arrives.
+	if ( texture->job != NULL )
+		texture->job->texture = NULL;
+
+	mgui_texture_unload( texture );
+
+	for ( prev = &texture_table[texture->hash % TEXTURE_HASH_SIZE]; *prev != NULL; prev = &(*prev)->hash_next )
+	{
+		if ( *prev == texture )
+		{
+			*prev = texture->hash_next;
+			break;
+		}
+	}
+
+	SAFE_DELETE( texture->filename );
+
+	list_remove( textures, &texture->node );
+	mem_free( texture );
+}
+
+static void mgui_texture_lru_remove( MGuiTexture* texture )
+{
+	// Textures freed right away (no budget) were never queued.
+	if ( texture->lru_prev == NULL && lru_first != texture ) return;
+
+	if ( texture->lru_prev ) texture->lru_prev->lru_next = texture->lru_next;
+	else lru_first = texture->lru_next;
+
+	if ( texture->lru_next ) texture->lru_next->lru_prev = texture->lru_prev;
+	else lru_last = texture->lru_prev;
+
+	texture->lru_prev = NULL;
+	texture->lru_next = NULL;
+}
+
+static void mgui_texture_evict( void )
+{
+	// Destroy unreferenced textures, the least recently used one first, until we're within the budget.
+	while ( lru_first != NULL && texture_memory > texture_budget )
+		mgui_texture_free( lru_first );
+}
+
+static uint32 mgui_texture_hash( const char_t* name )
+{
+	uint32 hash = 2166136261u, c;
+
+	// FNV-1a. File names are case insensitive on Windows, so the hash has to be as well.
+	for ( ; *name; name++ )
+	{
+		c = (uint32)*name;
+
+#ifdef _WIN32
+		if ( c >= 'A' && c <= 'Z' ) c += 'a' - 'A';
+#endif
+
+		hash = ( hash ^ c ) * 16777619u;
+	}
+
+	return hash;
+}
@@ -17,21 +17,35 @@
 #include "Renderer.h"
 #include "Types/List.h"
 
-typedef struct {
+#define TEXTURE_HASH_SIZE 64		// Number of buckets in the texture hash table
+
+struct MGuiTextureJob;
+
+typedef struct MGuiTexture {
 	node_t			node;		// Linked list node
 	MGuiRendTexture*data;		// Renderer texture data
 	char_t*			filename;	// Texture file name
 	uint16			width;		// Texture width
 	uint16			height;		// Texture height
 	uint32			refcount;	// Reference count
+	uint32			hash;		// Hash of the file name
+	uint32			size;		// Estimated amount of memory the renderer texture uses, in bytes
+	uint32*			pixels;		// Decoded pixels kept in memory (only if pixel caching is enabled)
+	struct MGuiTexture* hash_next;	// Next texture in the same hash table bucket
+	struct MGuiTexture* lru_prev;	// Previous unreferenced texture in the eviction queue
+	struct MGuiTexture* lru_next;	// Next unreferenced texture in the eviction queue
+	struct MGuiTextureJob* job;		// Background load in progress, NULL if the texture is not being loaded
 } MGuiTexture;
 
 void		mgui_texturemgr_initialize		( void );
 void		mgui_texturemgr_shutdown		( void );
 void		mgui_texturemgr_initialize_all	( void );
 void		mgui_texturemgr_invalidate_all	( void );
+void		mgui_texturemgr_set_budget		( uint32 bytes );
+void		mgui_texturemgr_set_cache		( bool enabled );
 
 MGuiTexture*mgui_texture_create				( const char_t* texture_file );
 void		mgui_texture_destroy			( MGuiTexture* texture );
+void		mgui_texture_wait				( MGuiTexture* texture );
 
 #endif /* __MGUI_TEXTURE_H */
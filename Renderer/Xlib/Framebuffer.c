@@ -0,0 +1,295 @@
+/**********************************************************************
+ *
+ * PROJECT:		Mylly GUI Renderer (Xlib)
+ * FILE:		Framebuffer.c
+ * LICENCE:		See Licence.txt
+ * PURPOSE:		Presents a GUI drawn into a framebuffer on the CPU
+ *				(for example by the software renderer) to an X window.
+ *
+ *				(c) Tuomo Jauhiainen 2013
+ *
+ **********************************************************************/
+
+#include "Xlib.h"
+#include "Platform/Window.h"
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <string.h>
+
+// --------------------------------------------------
+
+static MGuiRenderer				renderer;					// The renderer given to MGUI
+static MGuiRenderer				target;						// The renderer drawing into the framebuffer
+static xlib_framebuffer_t		get_framebuffer	= NULL;		// Returns the framebuffer of the target renderer
+static syswindow_t*				fb_window		= NULL;		// The window the framebuffer is presented to
+static GC						fb_gc;
+static Visual*					visual			= NULL;
+static uint32					depth			= 0;
+static XImage*					image			= NULL;		// Image used for presenting the framebuffer
+static XShmSegmentInfo			shminfo;					// Shared memory segment of the image
+static bool						use_shm			= false;	// The image lives in shared memory
+static bool						shm_failed		= false;	// Attaching the shared memory segment failed
+static rectangle_t				damage[MAX_DAMAGE_RECTS];	// Areas to be presented at the end of the frame
+static uint32					num_damage		= 0;
+static bool						screen_scene	= false;	// The current scene draws to the screen (not only to caches)
+static bool						fb_initialized	= false;
+
+// --------------------------------------------------
+
+static void		framebuffer_end				( void );
+static void		framebuffer_resize			( uint32 width, uint32 height );
+static void		framebuffer_set_damage_rects( const rectangle_t rects[], uint32 count );
+static bool		framebuffer_create_image	( uint32 width, uint32 height );
+static void		framebuffer_destroy_image	( void );
+static void		framebuffer_present			( const uint32* pixels, uint32 pitch, int32 x, int32 y, uint32 w, uint32 h );
+static int		framebuffer_shm_error		( Display* display, XErrorEvent* event );
+
+// --------------------------------------------------
+
+MGuiRenderer* mgui_xlib_initialize_framebuffer( void* syswindow, const MGuiRenderer* rend, xlib_framebuffer_t framebuffer )
+{
+	XWindowAttributes attribs;
+	uint32 width, height, pitch;
+
+	if ( syswindow == NULL || rend == NULL || framebuffer == NULL ) return NULL;
+
+	fb_window = syswindow;
+
+	XGetWindowAttributes( fb_window->display, fb_window->window, &attribs );
+
+	// The framebuffer is presented as it is, so the window has to use 0xRRGGBB pixels.
+	if ( attribs.depth < 24 || attribs.visual->red_mask != 0xFF0000 ||
+		 attribs.visual->green_mask != 0xFF00 || attribs.visual->blue_mask != 0xFF )
+		 return NULL;
+
+	visual = attribs.visual;
+	depth = (uint32)attribs.depth;
+
+	fb_gc = XCreateGC( fb_window->display, fb_window->window, 0, NULL );
+
+	// The target renderer does all the drawing, only the presentation is handled here.
+	target = *rend;
+	renderer = *rend;
+	renderer.end				= framebuffer_end;
+	renderer.resize				= framebuffer_resize;
+	renderer.set_damage_rects	= framebuffer_set_damage_rects;
+	renderer.properties			|= REND_SUPPORTS_DAMAGE;
+
+	get_framebuffer = framebuffer;
+
+	framebuffer( &width, &height, &pitch );
+	framebuffer_create_image( width, height );
+
+	fb_initialized = true;
+
+	return &renderer;
+}
+
+void mgui_xlib_shutdown_framebuffer( void )
+{
+	if ( !fb_initialized ) return;
+
+	framebuffer_destroy_image();
+	XFreeGC( fb_window->display, fb_gc );
+
+	fb_window = NULL;
+	get_framebuffer = NULL;
+	fb_initialized = false;
+}
+
+bool mgui_xlib_framebuffer_uses_shm( void )
+{
+	return use_shm;
+}
+
+static void framebuffer_end( void )
+{
+	const uint32* pixels;
+	uint32 width, height, pitch, i;
+	int32 x1, y1, x2, y2;
+
+	target.end();
+
+	// Scenes that only refresh cached render targets don't change the framebuffer, so there's nothing to present.
+	if ( !screen_scene ) return;
+
+	screen_scene = false;
+
+	pixels = get_framebuffer( &width, &height, &pitch );
+	if ( pixels == NULL ) return;
+
+	if ( image == NULL || (uint32)image->width != width || (uint32)image->height != height )
+	{
+		if ( !framebuffer_create_image( width, height ) ) return;
+	}
+
+	if ( num_damage == 0 )
+	{
+		framebuffer_present( pixels, pitch, 0, 0, width, height );
+	}
+	else
+	{
+		// Only the damaged areas are sent to the server.
+		for ( i = 0; i < num_damage; i++ )
+		{
+			x1 = math_max( damage[i].x, 0 );
+			y1 = math_max( damage[i].y, 0 );
+			x2 = math_min( damage[i].x + (int32)damage[i].w, (int32)width );
+			y2 = math_min( damage[i].y + (int32)damage[i].h, (int32)height );
+
+			if ( x2 <= x1 || y2 <= y1 ) continue;
+
+			framebuffer_present( pixels, pitch, x1, y1, x2 - x1, y2 - y1 );
+		}
+	}
+
+	// The server reads the shared memory segment asynchronously, it must be done before the next frame is copied in.
+	if ( use_shm )
+		XSync( fb_window->display, False );
+	else
+		XFlush( fb_window->display );
+
+	num_damage = 0;
+}
+
+static void framebuffer_resize( uint32 width, uint32 height )
+{
+	target.resize( width, height );
+
+	// The image is re-created when the size of the framebuffer has changed.
+	num_damage = 0;
+}
+
+static void framebuffer_set_damage_rects( const rectangle_t rects[], uint32 count )
+{
+	num_damage = math_min( count, MAX_DAMAGE_RECTS );
+	memcpy( damage, rects, num_damage * sizeof(rectangle_t) );
+
+	// Only scenes that draw to the screen get damage rectangles, even if they draw nothing at all.
+	screen_scene = true;
+
+	if ( target.set_damage_rects != NULL )
+		target.set_damage_rects( rects, count );
+}
+
+static bool framebuffer_create_image( uint32 width, uint32 height )
+{
+	Display* display = fb_window->display;
+	int ( *old_handler )( Display*, XErrorEvent* );
+
+	framebuffer_destroy_image();
+
+	if ( width == 0 || height == 0 ) return false;
+
+	use_shm = false;
+
+	// Try the shared memory extension first. It's not available on remote displays.
+	if ( !shm_failed && XShmQueryExtension( display ) )
+	{
+		image = XShmCreateImage( display, visual, depth, ZPixmap, NULL, &shminfo, width, height );
+
+		if ( image != NULL )
+		{
+			shminfo.shmid = shmget( IPC_PRIVATE, image->bytes_per_line * image->height, IPC_CREAT|0600 );
+			shminfo.shmaddr = image->data = ( shminfo.shmid >= 0 ) ? shmat( shminfo.shmid, NULL, 0 ) : (char*)-1;
+			shminfo.readOnly = True;
+
+			if ( shminfo.shmaddr != (char*)-1 )
+			{
+				// Attaching fails with an error (not a return value) if the server can't access the segment.
+				XSync( display, False );
+				old_handler = XSetErrorHandler( framebuffer_shm_error );
+
+				XShmAttach( display, &shminfo );
+				XSync( display, False );
+
+				XSetErrorHandler( old_handler );
+
+				// The segment is destroyed automatically once both sides have detached from it.
+				shmctl( shminfo.shmid, IPC_RMID, NULL );
+
+				if ( !shm_failed )
+				{
+					use_shm = true;
+					return true;
+				}
+
+				shmdt( shminfo.shmaddr );
+			}
+			else if ( shminfo.shmid >= 0 )
+			{
+				shmctl( shminfo.shmid, IPC_RMID, NULL );
+			}
+
+			image->data = NULL;
+			XDestroyImage( image );
+			image = NULL;
+		}
+
+		shm_failed = true;
+	}
+
+	// Fall back to a regular image. It uses the pixels of the framebuffer directly, so no memory is allocated for it.
+	image = XCreateImage( display, visual, depth, ZPixmap, 0, NULL, width, height, 32, 0 );
+
+	return ( image != NULL );
+}
+
+static void framebuffer_destroy_image( void )
+{
+	if ( image == NULL ) return;
+
+	if ( use_shm )
+	{
+		XShmDetach( fb_window->display, &shminfo );
+		XSync( fb_window->display, False );
+		shmdt( shminfo.shmaddr );
+	}
+
+	// The image doesn't own its pixels, don't let Xlib free them.
+	image->data = NULL;
+	XDestroyImage( image );
+
+	image = NULL;
+	use_shm = false;
+}
+
+static void framebuffer_present( const uint32* pixels, uint32 pitch, int32 x, int32 y, uint32 w, uint32 h )
+{
+	const uint32* src;
+	char* dst;
+	uint32 row;
+
+	if ( use_shm )
+	{
+		// Copy the area into the shared segment, the server reads it from there without going through the socket.
+		src = &pixels[y * pitch + x];
+		dst = image->data + y * image->bytes_per_line + x * sizeof(uint32);
+
+		for ( row = 0; row < h; row++, src += pitch, dst += image->bytes_per_line )
+			memcpy( dst, src, w * sizeof(uint32) );
+
+		XShmPutImage( fb_window->display, fb_window->window, fb_gc, image, x, y, x, y, w, h, False );
+		return;
+	}
+
+	// The framebuffer may have been re-allocated, so point the image to its current location.
+	image->data = (char*)pixels;
+	image->bytes_per_line = pitch * sizeof(uint32);
+
+	XPutImage( fb_window->display, fb_window->window, fb_gc, image, x, y, x, y, w, h );
+
+	image->data = NULL;
+}
+
+static int framebuffer_shm_error( Display* display, XErrorEvent* event )
+{
+	UNREFERENCED_PARAM( display );
+	UNREFERENCED_PARAM( event );
+
+	shm_failed = true;
+	return 0;
+}
@@ -17,11 +17,23 @@
 
 // --------------------------------------------------
 
+#define RECT_BATCH_SIZE		128		// Maximum number of rectangles sent in a single XFillRectangles request
+
+// --------------------------------------------------
+
 typedef struct {
 	MGuiRendFont	data;
 	XFontStruct*	font;
 } RendFont;
 
+typedef struct {
+	MGuiRendTarget	data;
+	Pixmap			pixmap;			// Server side pixmap the target is drawn into
+	Drawable		old_drawable;	// The drawable that was active before this target was enabled
+	int32			x_offset;		// Drawing offset before this target was enabled
+	int32			y_offset;
+} RenderTarget;
+
 // --------------------------------------------------
 
 static uint16		window_width	= 0;
@@ -30,30 +42,130 @@ static uint32		colour			= 0;
 static colour_t		draw_colour		= { 0 };
 static LINE_STATUS	line_status		= LINE_IDLE;
 static bool			line_continue	= false;
+static XRectangle	damage[MAX_DAMAGE_RECTS];
+static uint32		num_damage		= 0;
+static Drawable		drawable		= None;			// Current drawing target, the back buffer or a render target
+static int32		x_offset		= 0;			// Drawing offset (when rendering to a target)
+static int32		y_offset		= 0;
+static bool			screen_scene	= false;		// The current scene draws to the screen (not only to caches)
+static XRectangle	rect_batch[RECT_BATCH_SIZE];	// Rectangles of the same colour waiting to be sent to the server
+static uint32		num_batched		= 0;
+static uint32		gc_colour		= 0;			// Foreground colour the GC currently has
+static bool			gc_colour_set	= false;
+static Font			gc_font			= None;			// Font the GC currently has
 extern syswindow_t*	window;
 extern GC			gc;
+extern GC			blit_gc;
+extern Pixmap		back_buffer;
+extern uint32		depth;
 
 // --------------------------------------------------
 
+static void		renderer_prepare			( void );
+static void		renderer_set_clip			( const XRectangle* rects, uint32 count );
+static void		renderer_flush_rects		( void );
+static uint32	renderer_get_text_width		( const RendFont* font, const char_t* text );
 static void		renderer_draw_buffer		( const RendFont* font, const char_t* text, int32* x, int32* y, uint32 flags, bool measure );
 static void		renderer_process_tag		( const MGuiFormatTag* tag );
 static void		renderer_process_underline	( const RendFont* font, int32 x, int32 y, int32* x2, int32* y2, colour_t* line_colour );
+static const XCharStruct* renderer_get_char_struct( const XFontStruct* font, uint32 c );
 
 // --------------------------------------------------
 
 void renderer_begin( void )
 {
-	XClearWindow( window->display, window->window );
+	drawable = back_buffer;
+	x_offset = 0;
+	y_offset = 0;
+
+	// Clear the parts of the back buffer that are going to be redrawn. Scenes that only
+	// refresh render targets must leave the back buffer alone.
+	if ( screen_scene )
+	{
+		if ( num_damage == 0 )
+			XFillRectangle( window->display, back_buffer, blit_gc, 0, 0, window_width, window_height );
+		else
+			XFillRectangles( window->display, back_buffer, blit_gc, damage, num_damage );
+	}
+
+	// Make sure nothing is drawn outside the damaged areas.
+	if ( num_damage > 0 )
+		renderer_set_clip( damage, num_damage );
 }
 
 void renderer_end( void )
 {
+	uint32 i;
+
+	renderer_flush_rects();
+
+	// Copy the back buffer to the window after every screen scene, even if nothing was drawn into it.
+	if ( screen_scene )
+	{
+		if ( num_damage == 0 )
+		{
+			XCopyArea( window->display, back_buffer, window->window, blit_gc, 0, 0, window_width, window_height, 0, 0 );
+		}
+		else
+		{
+			for ( i = 0; i < num_damage; i++ )
+			{
+				XCopyArea( window->display, back_buffer, window->window, blit_gc, damage[i].x, damage[i].y,
+						   damage[i].width, damage[i].height, damage[i].x, damage[i].y );
+			}
+		}
+	}
+
+	screen_scene = false;
+
+	if ( num_damage > 0 )
+	{
+		XSetClipMask( window->display, gc, None );
+		num_damage = 0;
+	}
+}
+
+void renderer_set_damage_rects( const rectangle_t rects[], uint32 count )
+{
+	uint32 i;
+
+	num_damage = math_min( count, MAX_DAMAGE_RECTS );
+
+	// Only scenes that draw to the screen get damage rectangles (none for a full redraw).
+	screen_scene = true;
+
+	for ( i = 0; i < num_damage; i++ )
+	{
+		damage[i].x = rects[i].x;
+		damage[i].y = rects[i].y;
+		damage[i].width = rects[i].w;
+		damage[i].height = rects[i].h;
+	}
 }
 
 void renderer_resize( uint32 w, uint32 h )
 {
+	if ( back_buffer != None && w == window_width && h == window_height )
+		return;
+
 	window_width = (uint16)w;
 	window_height = (uint16)h;
+
+	// The back buffer has to be re-created with the new size, MGUI redraws everything after a resize anyway.
+	if ( back_buffer != None )
+	{
+		XFreePixmap( window->display, back_buffer );
+	}
+	else
+	{
+		// The renderer has just been initialized with a new GC, forget the state of the old one.
+		gc_colour_set = false;
+		gc_font = None;
+		num_batched = 0;
+	}
+
+	back_buffer = XCreatePixmap( window->display, window->window, math_max( w, 1 ), math_max( h, 1 ), depth );
+	drawable = back_buffer;
 }
 
 DRAW_MODE renderer_set_draw_mode( DRAW_MODE mode )
@@ -64,10 +176,9 @@ DRAW_MODE renderer_set_draw_mode( DRAW_MODE mode )
 
 void renderer_set_draw_colour( const colour_t* col )
 {
+	// The colour is sent to the server once something is drawn with it.
 	colour = ( col->a << 24 ) | ( col->r << 16 ) | ( col->g << 8 ) | col->b;
 	draw_colour = *col;
-
-	XSetForeground( window->display, gc, colour );
 }
 
 void renderer_set_draw_depth( float z_depth )
@@ -91,28 +202,81 @@ void renderer_reset_draw_transform( void )
 void renderer_start_clip( int32 x, int32 y, uint32 w, uint32 h )
 {
 	XRectangle r = { x, y, w, h };
-	XSetClipRectangles( window->display, gc, 0, 0, &r, 1, Unsorted );
+	XRectangle clip[MAX_DAMAGE_RECTS];
+	int32 x1, y1, x2, y2;
+	uint32 i, n = 0;
+
+	// Render targets are not affected by the damaged areas of the screen.
+	if ( num_damage == 0 || drawable != back_buffer )
+	{
+		renderer_set_clip( &r, 1 );
+		return;
+	}
+
+	// Only draw to the parts of the clip rectangle that are being redrawn.
+	for ( i = 0; i < num_damage; i++ )
+	{
+		x1 = math_max( x, damage[i].x );
+		y1 = math_max( y, damage[i].y );
+		x2 = math_min( x + (int32)w, damage[i].x + damage[i].width );
+		y2 = math_min( y + (int32)h, damage[i].y + damage[i].height );
+
+		if ( x2 <= x1 || y2 <= y1 ) continue;
+
+		clip[n].x = (short)x1;
+		clip[n].y = (short)y1;
+		clip[n].width = (unsigned short)( x2 - x1 );
+		clip[n].height = (unsigned short)( y2 - y1 );
+		n++;
+	}
+
+	// An empty list of rectangles disables drawing altogether, which is what we want.
+	renderer_set_clip( clip, n );
 }
 
 void renderer_end_clip( void )
 {
+	if ( num_damage > 0 && drawable == back_buffer )
+	{
+		// Return to clipping to the damaged areas.
+		renderer_set_clip( damage, num_damage );
+		return;
+	}
+
+	renderer_flush_rects();
 	XSetClipMask( window->display, gc, None );
 }
 
 void renderer_draw_rect( int32 x, int32 y, uint32 w, uint32 h )
 {
-	XFillRectangle( window->display, window->window, gc, x, y, w, h );
+	XRectangle* r;
+
+	renderer_prepare();
+
+	// Rectangles are collected and sent to the server all at once when the state of the GC changes.
+	if ( num_batched == RECT_BATCH_SIZE )
+		renderer_flush_rects();
+
+	r = &rect_batch[num_batched++];
+	r->x = (short)( x - x_offset );
+	r->y = (short)( y - y_offset );
+	r->width = (unsigned short)w;
+	r->height = (unsigned short)h;
 }
 
 void renderer_draw_triangle( int32 x1, int32 y1, int32 x2, int32 y2, int32 x3, int32 y3 )
 {
-	XPoint points[] = { { x1, y1 }, { x2, y2 }, { x3, y3 } };
-	XFillPolygon( window->display, window->window, gc, points, 3, Convex, CoordModeOrigin );
+	XPoint points[] = { { x1 - x_offset, y1 - y_offset }, { x2 - x_offset, y2 - y_offset }, { x3 - x_offset, y3 - y_offset } };
+
+	renderer_prepare();
+	renderer_flush_rects();
+
+	XFillPolygon( window->display, drawable, gc, points, 3, Convex, CoordModeOrigin );
 }
 
 void renderer_draw_pixel( int32 x, int32 y )
 {
-	XFillRectangle( window->display, window->window, gc, x, y, 1, 1 );
+	renderer_draw_rect( x, y, 1, 1 );
 }
 
 MGuiRendTexture* renderer_load_texture( const char_t* path, uint32* width, uint32* height )
@@ -175,7 +339,13 @@ void renderer_destroy_font( MGuiRendFont* fnt )
 	if ( font == NULL ) return;
 
 	if ( font->font )
+	{
+		// The server may reuse the id, so the GC has to be told about the font again.
+		if ( gc_font == font->font->fid )
+			gc_font = None;
+
 		XFreeFont( window->display, font->font );
+	}
 
 	mem_free( font );
 }
@@ -264,50 +434,115 @@ void renderer_measure_text( const MGuiRendFont* fnt, const char_t* text, uint32*
 		return;
 	}
 
-	XSetFont( window->display, gc, font->font->fid );
-
-#ifdef MYLLY_UNICODE
-	*w = XTextWidth16( font->font, text, mstrlen( text ) );
-#else
-	*w = XTextWidth( font->font, text, strlen( text ) );
-#endif
-
+	*w = renderer_get_text_width( font, text );
 	*h = font->data.size;
 }
 
+void renderer_measure_glyphs( const MGuiRendFont* fnt, uint32 firstc, uint32 lastc, uint16 advances[] )
+{
+	const RendFont* font = (const RendFont*)fnt;
+	const XCharStruct* cs;
+	uint32 c;
+
+	// The metrics are stored in the font struct already, so there's no need to talk to the server.
+	for ( c = firstc; c <= lastc; c++ )
+	{
+		cs = font ? renderer_get_char_struct( font->font, c ) : NULL;
+
+		if ( cs == NULL )
+		{
+			// Use the default character instead, just like XTextWidth does.
+			cs = font ? renderer_get_char_struct( font->font, font->font->default_char ) : NULL;
+		}
+
+		advances[c - firstc] = cs ? (uint16)cs->width : 0;
+	}
+}
+
 MGuiRendTarget* renderer_create_render_target( uint32 width, uint32 height )
 {
-	// Render targets are not supported with this renderer.
-	UNREFERENCED_PARAM( width );
-	UNREFERENCED_PARAM( height );
+	RenderTarget* target;
 
-	return NULL;
+	if ( width == 0 || height == 0 ) return NULL;
+
+	// Render targets are pixmaps on the server, so drawing them is a single copy request.
+	target = mem_alloc_clean( sizeof(*target) );
+
+	target->data.width = width;
+	target->data.height = height;
+	target->pixmap = XCreatePixmap( window->display, window->window, width, height, depth );
+
+	return (MGuiRendTarget*)target;
 }
 
 void renderer_destroy_render_target( MGuiRendTarget* target )
 {
-	UNREFERENCED_PARAM( target );
+	RenderTarget* buffer = (RenderTarget*)target;
+
+	if ( target == NULL ) return;
+
+	XFreePixmap( window->display, buffer->pixmap );
+	mem_free( buffer );
 }
 
 void renderer_draw_render_target( const MGuiRendTarget* target, int32 x, int32 y, uint32 w, uint32 h )
 {
-	UNREFERENCED_PARAM( target );
-	UNREFERENCED_PARAM( x );
-	UNREFERENCED_PARAM( y );
-	UNREFERENCED_PARAM( w );
-	UNREFERENCED_PARAM( h );
+	const RenderTarget* buffer = (const RenderTarget*)target;
+
+	if ( buffer == NULL ) return;
+
+	// Core X pixmaps have no alpha channel, so the target is always drawn opaque.
+	renderer_prepare();
+	renderer_flush_rects();
+
+	XCopyArea( window->display, buffer->pixmap, drawable, gc, 0, 0,
+			   math_min( w, buffer->data.width ), math_min( h, buffer->data.height ), x - x_offset, y - y_offset );
 }
 
 void renderer_enable_render_target( const MGuiRendTarget* target, int32 x, int32 y )
 {
-	UNREFERENCED_PARAM( target );
-	UNREFERENCED_PARAM( x );
-	UNREFERENCED_PARAM( y );
+	RenderTarget* buffer = (RenderTarget*)target;
+
+	if ( target == NULL ) return;
+
+	renderer_flush_rects();
+
+	// Store the old drawable.
+	buffer->old_drawable = drawable;
+	buffer->x_offset = x_offset;
+	buffer->y_offset = y_offset;
+
+	// Without an alpha channel, the best guess for the transparent parts of the target is
+	// whatever is behind it on the screen right now.
+	if ( back_buffer != None )
+	{
+		XCopyArea( window->display, back_buffer, buffer->pixmap, blit_gc, x, y,
+				   buffer->data.width, buffer->data.height, 0, 0 );
+	}
+
+	drawable = buffer->pixmap;
+	x_offset = x;
+	y_offset = y;
+
+	XSetClipMask( window->display, gc, None );
 }
 
 void renderer_disable_render_target( const MGuiRendTarget* target )
 {
-	UNREFERENCED_PARAM( target );
+	RenderTarget* buffer = (RenderTarget*)target;
+
+	if ( target == NULL ) return;
+
+	renderer_flush_rects();
+
+	// Restore the old drawable.
+	drawable = buffer->old_drawable != None ? buffer->old_drawable : back_buffer;
+	x_offset = buffer->x_offset;
+	y_offset = buffer->y_offset;
+
+	buffer->old_drawable = None;
+
+	renderer_end_clip();
 }
 
 void renderer_screen_pos_to_world( const vector3_t* src, vector3_t* dst )
@@ -333,27 +568,104 @@ void renderer_world_pos_to_screen( const vector3_t* src, vector3_t* dst )
 	}
 }
 
+static void renderer_prepare( void )
+{
+	// Only talk to the server when the colour has actually changed.
+	if ( !gc_colour_set || gc_colour != colour )
+	{
+		renderer_flush_rects();
+		XSetForeground( window->display, gc, colour );
+
+		gc_colour = colour;
+		gc_colour_set = true;
+	}
+}
+
+static void renderer_set_clip( const XRectangle* rects, uint32 count )
+{
+	renderer_flush_rects();
+
+	// The clip rectangles are given in screen coordinates, move the origin when drawing into a target.
+	XSetClipRectangles( window->display, gc, -x_offset, -y_offset, (XRectangle*)rects, count, Unsorted );
+}
+
+static void renderer_flush_rects( void )
+{
+	if ( num_batched == 0 ) return;
+
+	XFillRectangles( window->display, drawable, gc, rect_batch, num_batched );
+	num_batched = 0;
+}
+
+static uint32 renderer_get_text_width( const RendFont* font, const char_t* text )
+{
+	const XCharStruct *cs, *def;
+	uint32 w = 0;
+
+	// Calculated from the metrics in the font struct, the same way XTextWidth does.
+	def = renderer_get_char_struct( font->font, font->font->default_char );
+
+	for ( ; *text; text++ )
+	{
+		cs = renderer_get_char_struct( font->font, *(const uchar_t*)text );
+		if ( cs == NULL ) cs = def;
+
+		if ( cs != NULL ) w += cs->width;
+	}
+
+	return w;
+}
+
 static void renderer_draw_buffer( const RendFont* font, const char_t* text, int32* x, int32* y, uint32 flags, bool measure )
 {
 	int32 y_pos = *y;
 
-	XSetFont( window->display, gc, font->font->fid );
+	renderer_prepare();
+	renderer_flush_rects();
+
+	if ( gc_font != font->font->fid )
+	{
+		XSetFont( window->display, gc, font->font->fid );
+		gc_font = font->font->fid;
+	}
+
 	y_pos += font->data.size;
 
 #ifdef MYLLY_UNICODE
-	XDrawString16( window->display, window->window, gc, *x, y_pos, text, mstrlen( text ) );
+	XDrawString16( window->display, drawable, gc, *x - x_offset, y_pos - y_offset, text, mstrlen( text ) );
 #else
-	XDrawString( window->display, window->window, gc, *x, y_pos, text, strlen( text ) );
+	XDrawString( window->display, drawable, gc, *x - x_offset, y_pos - y_offset, text, strlen( text ) );
 #endif
 
 	if ( measure )
-	{
-#ifdef MYLLY_UNICODE
-		*x += XTextWidth16( font->font, text, mstrlen( text ) );
-#else
-		*x += XTextWidth( font->font, text, strlen( text ) );
-#endif
-	}
+		*x += renderer_get_text_width( font, text );
+}
+
+static const XCharStruct* renderer_get_char_struct( const XFontStruct* font, uint32 c )
+{
+	const XCharStruct* cs;
+	uint32 byte1, byte2, cols;
+
+	byte1 = ( c >> 8 ) & 0xFF;
+	byte2 = c & 0xFF;
+
+	if ( byte1 < font->min_byte1 || byte1 > font->max_byte1 ||
+		 byte2 < font->min_char_or_byte2 || byte2 > font->max_char_or_byte2 )
+		 return NULL;
+
+	// All the characters of a monospaced font have the same metrics.
+	if ( font->per_char == NULL )
+		return &font->max_bounds;
+
+	cols = font->max_char_or_byte2 - font->min_char_or_byte2 + 1;
+	cs = &font->per_char[( byte1 - font->min_byte1 ) * cols + ( byte2 - font->min_char_or_byte2 )];
+
+	// Characters that do not exist in the font have all-zero metrics.
+	if ( cs->width == 0 && cs->ascent == 0 && cs->descent == 0 &&
+		 cs->lbearing == 0 && cs->rbearing == 0 )
+		 return NULL;
+
+	return cs;
 }
 
 static void renderer_process_tag( const MGuiFormatTag* tag )
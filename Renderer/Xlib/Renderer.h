@@ -26,6 +26,7 @@ typedef enum {
 void				renderer_begin						( void );
 void				renderer_end						( void );
 void				renderer_resize						( uint32 width, uint32 height );
+void				renderer_set_damage_rects			( const rectangle_t rects[], uint32 count );
 
 DRAW_MODE			renderer_set_draw_mode				( DRAW_MODE mode );
 void				renderer_set_draw_colour			( const colour_t* col );
@@ -53,6 +54,7 @@ void				renderer_draw_text					( const MGuiRendFont* font, const char_t* text, i
 														  uint32 flags, const MGuiFormatTag tags[], uint32 ntags );
 
 void				renderer_measure_text				( const MGuiRendFont* font, const char_t* text, uint32* w, uint32* h );
+void				renderer_measure_glyphs				( const MGuiRendFont* font, uint32 firstc, uint32 lastc, uint16 advances[] );
 
 MGuiRendTarget*		renderer_create_render_target		( uint32 width, uint32 height );
 void				renderer_destroy_render_target		( MGuiRendTarget* target );
@@ -20,17 +20,24 @@ static MGuiRenderer	renderer;
 syswindow_t*		window		= NULL;
 bool				initialized	= false;
 GC					gc;
+GC					blit_gc;				// GC without clipping, used for clearing and presenting the back buffer
+Pixmap				back_buffer	= None;		// Everything is drawn here first and copied to the window at the end of a frame
+uint32				depth		= 0;		// Depth of the window, used for creating pixmaps
 
 // --------------------------------------------------
 
 MGuiRenderer* mgui_xlib_initialize( void* syswindow )
 {
 	XGCValues values;
+	XWindowAttributes attribs;
 	uint32 mask;
 
+	renderer.properties = REND_SUPPORTS_DAMAGE|REND_SUPPORTS_TARGETS;
+
 	renderer.begin					= renderer_begin;
 	renderer.end					= renderer_end;
 	renderer.resize					= renderer_resize;
+	renderer.set_damage_rects		= renderer_set_damage_rects;
 	renderer.set_draw_mode			= renderer_set_draw_mode;
 	renderer.set_draw_colour		= renderer_set_draw_colour;
 	renderer.set_draw_depth			= renderer_set_draw_depth;
@@ -48,6 +55,7 @@ MGuiRenderer* mgui_xlib_initialize( void* syswindow )
 	renderer.destroy_font			= renderer_destroy_font;
 	renderer.draw_text				= renderer_draw_text;
 	renderer.measure_text			= renderer_measure_text;
+	renderer.measure_glyphs			= renderer_measure_glyphs;
 	renderer.create_render_target	= renderer_create_render_target;
 	renderer.destroy_render_target	= renderer_destroy_render_target;
 	renderer.draw_render_target		= renderer_draw_render_target;
@@ -60,14 +68,26 @@ MGuiRenderer* mgui_xlib_initialize( void* syswindow )
 
 	memset( &values, 0, sizeof(values) );
 	values.background = 0xFF000000;
+	values.foreground = 0xFF000000;
+
+	// Copying between pixmaps would otherwise generate an expose event for each copy.
+	values.graphics_exposures = False;
 
-	mask = GCCapStyle|GCJoinStyle;
+	mask = GCCapStyle|GCJoinStyle|GCGraphicsExposures;
 
 	gc = XCreateGC( window->display, window->window, mask, &values );
 	if ( gc < 0 ) return NULL;
 
 	XSetFillStyle( window->display, gc, FillSolid );
 
+	blit_gc = XCreateGC( window->display, window->window, mask|GCForeground, &values );
+
+	// The back buffer has to match the window.
+	XGetWindowAttributes( window->display, window->window, &attribs );
+	depth = (uint32)attribs.depth;
+
+	renderer_resize( (uint32)attribs.width, (uint32)attribs.height );
+
 	initialized = true;
 
 	return &renderer;
@@ -77,6 +97,13 @@ void mgui_xlib_shutdown( void )
 {
 	if ( !initialized ) return;
 
+	if ( back_buffer != None )
+	{
+		XFreePixmap( window->display, back_buffer );
+		back_buffer = None;
+	}
+
+	XFreeGC( window->display, blit_gc );
 	XFreeGC( window->display, gc );
 
 	window = NULL;
@@ -22,6 +22,16 @@ MYLLY_API void			mgui_xlib_shutdown		( void );
 MYLLY_API void			mgui_xlib_begin_scene	( void );
 MYLLY_API void			mgui_xlib_end_scene		( void );
 
+// Composited mode: the GUI is drawn into a framebuffer on the CPU by another renderer (such as the software renderer),
+// and this library only presents the damaged areas of it to the window. The pixels are sent through a shared memory
+// segment (MIT-SHM) when the display supports it, otherwise with XPutImage. get_framebuffer has the same signature as
+// mgui_software_get_framebuffer. Only TrueColor windows with a depth of 24 or 32 bits are supported.
+typedef const uint32* ( *xlib_framebuffer_t )( uint32* width, uint32* height, uint32* pitch );
+
+MYLLY_API MGuiRenderer*	mgui_xlib_initialize_framebuffer	( void* window, const MGuiRenderer* renderer, xlib_framebuffer_t get_framebuffer );
+MYLLY_API void			mgui_xlib_shutdown_framebuffer		( void );
+MYLLY_API bool			mgui_xlib_framebuffer_uses_shm		( void );
+
 __END_DECLS
 
 #endif /* __MYLLY_GUI_X11_RENDERER_H */
@@ -12,5 +12,6 @@ project "Lib-MGUI-Renderer-Xlib"
 	configuration "linux"
 		targetextension ".a"
 		buildoptions { "-fms-extensions" } -- Unnamed struct/union fields within structs/unions
+		links { "X11", "Xext" } -- Xext provides the MIT-SHM extension
 		configuration "Debug" targetname "mguixlib"
 		configuration "Release" targetname "mguixlib"
@@ -384,11 +384,16 @@ static void skin_simple_draw_listbox( MGuiElement* element )
 		skin_simple_draw_border( r, &col, BORDER_ALL, 1 );
 	}
 
-	if ( list_empty( listbox->items ) ) return;
+	// Virtual listboxes draw their cached rows instead of items.
+	if ( listbox->provider != NULL )
+		item = listbox->num_visible ? listbox->rows : NULL;
+	else
+		item = list_empty( listbox->items ) ? NULL : listbox->first_visible;
+
+	if ( item == NULL ) return;
 
 	// Draw (visible) items.
 	renderer->set_draw_colour( &listbox->text->colour );
-	item = listbox->first_visible;
 
 	for ( count = 0; count < listbox->max_visible; ++count )
 	{
@@ -411,8 +416,15 @@ static void skin_simple_draw_listbox( MGuiElement* element )
 		// Draw the text.
 		renderer->draw_text( listbox->font->data, item->text, item->text_bounds.x, item->text_bounds.y, listbox->text->flags, item->tags, item->ntags );
 
-		next = item->node.next;
-		item = ( next != list_end( listbox->items ) ) ? (MGuiListboxItem*)next : NULL;
+		if ( listbox->provider != NULL )
+		{
+			item = ( count + 1 < listbox->num_visible ) ? &listbox->rows[count+1] : NULL;
+		}
+		else
+		{
+			next = item->node.next;
+			item = ( next != list_end( listbox->items ) ) ? (MGuiListboxItem*)next : NULL;
+		}
 	}
 }
 
@@ -422,8 +434,7 @@ static void skin_simple_draw_memobox( MGuiElement* element )
 	rectangle_t* r;
 	struct MGuiMemobox* memo;
 	struct MGuiMemoLine* line;
-	node_t* node;
-	uint32 i, count, colour = 0;
+	uint32 i, colour = 0;
 
 	memo = (struct MGuiMemobox*)element;
 
@@ -449,16 +460,9 @@ static void skin_simple_draw_memobox( MGuiElement* element )
 	}
 
 	// Memobox lines
-	if ( memo->lines->size == 0 ) return;
-
-	count = memo->visible_lines;
-	if ( count == 0 ) count = 0xFFFFFFFF;
-
-	for ( node = memo->first_line, i = 0;
-		  node != list_end(memo->lines) && i < count && node;
-		  node = node->prev, i++ )
+	for ( i = 0; i < memo->visible_lines; i++ )
 	{
-		line = (struct MGuiMemoLine*)node;
+		line = &memo->lines[i];
 
 		if ( line->colour.hex != colour )
 		{
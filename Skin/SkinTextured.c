@@ -145,6 +145,9 @@ MGuiSkin* mgui_setup_skin_textured( const char_t* path )
 
 	if ( texture == NULL ) return NULL;
 
+	// The texture coordinates are calculated from the size of the texture, so it's needed right away.
+	mgui_texture_wait( texture );
+
 	// Well, the texture exists so let's create the skin instance
 	skin = mem_alloc_clean( sizeof(*skin) );
 
@@ -516,11 +519,16 @@ static void skin_textured_draw_listbox( MGuiElement* element )
 										   listbox->flags & FLAG_BORDER ? BORDER_ALL : BORDER_NONE, listbox->flags & FLAG_BACKGROUND );
 	}
 
-	if ( list_empty( listbox->items ) ) return;
+	// Virtual listboxes draw their cached rows instead of items.
+	if ( listbox->provider != NULL )
+		item = listbox->num_visible ? listbox->rows : NULL;
+	else
+		item = list_empty( listbox->items ) ? NULL : listbox->first_visible;
+
+	if ( item == NULL ) return;
 
 	// Draw (visible) items.
 	renderer->set_draw_colour( &listbox->text->colour );
-	item = listbox->first_visible;
 
 	for ( count = 0; count < listbox->max_visible; ++count )
 	{
@@ -538,8 +546,15 @@ static void skin_textured_draw_listbox( MGuiElement* element )
 		// Draw the text.
 		renderer->draw_text( listbox->font->data, item->text, item->text_bounds.x, item->text_bounds.y, listbox->text->flags, item->tags, item->ntags );
 
-		next = item->node.next;
-		item = ( next != list_end( listbox->items ) ) ? (MGuiListboxItem*)next : NULL;
+		if ( listbox->provider != NULL )
+		{
+			item = ( count + 1 < listbox->num_visible ) ? &listbox->rows[count+1] : NULL;
+		}
+		else
+		{
+			next = item->node.next;
+			item = ( next != list_end( listbox->items ) ) ? (MGuiListboxItem*)next : NULL;
+		}
 	}
 }
 
@@ -548,8 +563,7 @@ static void skin_textured_draw_memobox( MGuiElement* element )
 	MGuiTexturedSkin* skin = (MGuiTexturedSkin*)element->skin;
 	struct MGuiMemobox* memo = (struct MGuiMemobox*)element;
 	struct MGuiMemoLine* line;
-	node_t* node;
-	uint32 i, count, colour = 0;
+	uint32 i, colour = 0;
 
 	// Draw memobox background and border
 	if ( memo->flags & (FLAG_BORDER|FLAG_BACKGROUND) )
@@ -559,16 +573,9 @@ static void skin_textured_draw_memobox( MGuiElement* element )
 	}
 
 	// Draw memobox lines
-	if ( memo->lines->size == 0 ) return;
-
-	count = memo->visible_lines;
-	if ( count == 0 ) count = 0xFFFFFFFF;
-
-	for ( node = memo->first_line, i = 0;
-		  node != list_end(memo->lines) && i < count && node;
-		  node = node->prev, i++ )
+	for ( i = 0; i < memo->visible_lines; i++ )
 	{
-		line = (struct MGuiMemoLine*)node;
+		line = &memo->lines[i];
 
 		if ( line->colour.hex != colour )
 		{
@@ -0,0 +1,118 @@
+/**
+ *
+ * @file		Tests.c
+ * @copyright	Tuomo Jauhiainen 2012-2014
+ * @licence		See Licence.txt
+ * @brief		Regression tests for Mylly GUI.
+ *
+ * @details		Runs small scenes through the core library using the headless
+ * renderer and checks the renderer calls MGUI makes. Returns a non-zero exit
+ * code if any of the tests fail.
+ *
+ **/
+
+#include "MGUI.h"
+#include "Renderer/Headless/Headless.h"
+#include <stdio.h>
+
+// --------------------------------------------------
+
+#define SCREEN_WIDTH	640		// Width of the virtual screen
+#define SCREEN_HEIGHT	480		// Height of the virtual screen
+
+typedef bool ( *test_func_t )( void );
+
+// --------------------------------------------------
+
+static bool			test_run					( const char* name, test_func_t func );
+static void			test_settle					( void );
+static bool			test_partial_redraw			( void );
+
+// --------------------------------------------------
+
+int main( int argc, char** argv )
+{
+	MGuiRenderer* renderer;
+	uint32 failed = 0;
+
+	UNREFERENCED_PARAM( argc );
+	UNREFERENCED_PARAM( argv );
+
+	// Damage tracking is only used when the window is drawn on demand.
+	mgui_initialize( NULL, MGUI_USE_DRAW_EVENT );
+	mgui_resize( SCREEN_WIDTH, SCREEN_HEIGHT );
+
+	renderer = mgui_headless_initialize( SCREEN_WIDTH, SCREEN_HEIGHT );
+	mgui_set_renderer( renderer );
+
+	if ( !test_run( "partial redraw", test_partial_redraw ) ) failed++;
+
+	mgui_set_renderer( NULL );
+	mgui_headless_shutdown();
+
+	mgui_shutdown();
+
+	return failed > 0 ? 1 : 0;
+}
+
+static bool test_run( const char* name, test_func_t func )
+{
+	bool result = func();
+
+	printf( "%-32s %s\n", name, result ? "ok" : "FAILED" );
+	return result;
+}
+
+static void test_settle( void )
+{
+	uint32 i;
+
+	// Process frames until there is nothing left to draw.
+	for ( i = 0; i < 4; i++ )
+	{
+		mgui_pre_process();
+		mgui_process();
+	}
+}
+
+static bool test_partial_redraw( void )
+{
+	MGuiElement* canvas;
+	MGuiButton *button1, *button2;
+	MGuiHeadlessStats stats;
+	bool result = true;
+
+	canvas = mgui_create_canvas( NULL );
+
+	button1 = mgui_create_button_ex( canvas, 10, 10, 80, 20, FLAG_VISIBLE|FLAG_BACKGROUND, 0xC0C0C0FF, "Button 1" );
+	button2 = mgui_create_button_ex( canvas, 10, 40, 80, 20, FLAG_VISIBLE|FLAG_BACKGROUND, 0xC0C0C0FF, "Button 2" );
+
+	mgui_force_redraw();
+	test_settle();
+
+	// The first change schedules a redraw for the next frame, the second one is made before that frame is drawn.
+	mgui_set_text( button1, "Changed 1" );
+	mgui_process();
+
+	mgui_set_text( button2, "Changed 2" );
+
+	mgui_headless_reset_stats();
+	mgui_process();
+	mgui_headless_get_stats( &stats );
+
+	// Both changes should be drawn by a single partial redraw...
+	if ( stats.frames != 1 || stats.damage_rects == 0 ) result = false;
+
+	// ...after which there should be nothing left to draw.
+	mgui_headless_reset_stats();
+	mgui_process();
+	mgui_headless_get_stats( &stats );
+
+	if ( stats.frames != 0 ) result = false;
+	if ( mgui_get_next_wakeup() == 0 ) result = false;
+
+	mgui_element_destroy( canvas );
+	test_settle();
+
+	return result;
+}
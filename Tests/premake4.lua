@@ -0,0 +1,23 @@
+-- Mylly GUI regression tests
+
+project "MGUI-Tests"
+	kind "ConsoleApp"
+	language "C"
+	files { "*.h", "*.c", "premake4.lua" }
+	includedirs { ".", "..", "../Elements", "../Input", "../Renderer", "../Skin", "../.." }
+	vpaths { [""] = { "../Libraries/MGUI/Tests" } }
+	location ( "../../../Projects/" .. os.get() .. "/" .. _ACTION )
+	links { "Lib-MGUI", "Lib-MGUI-Renderer-Headless", "Lib-Input", "Lib-Platform", "Lib-Stringy", "Lib-Math", "Lib-Types" }
+
+	-- Linux specific stuff
+	configuration "linux"
+		buildoptions { "-fms-extensions" } -- Unnamed struct/union fields within structs/unions
+		links { "X11", "m", "rt", "pthread" }
+		configuration "Debug" targetname "mguitestsd"
+		configuration "Release" targetname "mguitests"
+
+	-- Windows specific stuff
+	configuration "windows"
+		buildoptions { "/wd4201 /wd4996" } -- C4201: nameless struct/union, C4996: This function or variable may be unsafe.
+		configuration "Debug" targetname "mguitestsd"
+		configuration "Release" targetname "mguitests"
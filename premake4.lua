@@ -1,5 +1,10 @@
 -- Mylly GUI library
 
+newoption {
+	trigger = "mgui-stats",
+	description = "Collect per-frame statistics (see mgui_get_frame_stats)"
+}
+
 project "Lib-MGUI"
 	kind "StaticLib"
 	language "C"
@@ -7,6 +12,10 @@ project "Lib-MGUI"
 	vpaths { [""] = { "../Libraries/MGUI" } }
 	includedirs { ".", "..", "Elements", "Input", "Renderer", "Skin" }
 	location ( "../../Projects/" .. os.get() .. "/" .. _ACTION )
+
+	-- Frame statistics
+	configuration "mgui-stats"
+		defines { "MGUI_ENABLE_STATS" }
 	
 	-- Linux specific stuff
 	configuration "linux"